@@ -0,0 +1,62 @@
+//
+//  SIArena.c
+//  SITypes
+//
+//  Copyright © 2025 PhySy Ltd. All rights reserved.
+//
+#include "SIArena.h"
+#include <stdint.h>
+#include <stdlib.h>
+struct SIArenaBlock {
+    SIArenaBlock *next;
+    _Alignas(max_align_t) char bytes[];
+};
+#define SIARENA_ALIGNMENT _Alignof(max_align_t)
+void SIArenaInit(SIArena *arena) {
+    if (!arena) return;
+    arena->cursor = arena->inlineBytes;
+    arena->limit = arena->inlineBytes + SIARENA_INLINE_SIZE;
+    arena->blocks = NULL;
+    arena->nextBlockSize = 2 * SIARENA_INLINE_SIZE;
+}
+void *SIArenaAlloc(SIArena *arena, size_t size) {
+    if (!arena) return NULL;
+    size = (size + SIARENA_ALIGNMENT - 1) & ~(size_t)(SIARENA_ALIGNMENT - 1);
+    if ((size_t)(arena->limit - arena->cursor) < size) {
+        size_t blockSize = arena->nextBlockSize;
+        while (blockSize < size) blockSize *= 2;
+        SIArenaBlock *block = malloc(sizeof(SIArenaBlock) + blockSize);
+        if (!block) return NULL;
+        block->next = arena->blocks;
+        arena->blocks = block;
+        arena->cursor = block->bytes;
+        arena->limit = block->bytes + blockSize;
+        if (arena->nextBlockSize < SIZE_MAX / 2) arena->nextBlockSize *= 2;
+    }
+    void *result = arena->cursor;
+    arena->cursor += size;
+    return result;
+}
+void SIArenaReset(SIArena *arena) {
+    if (!arena) return;
+    SIArenaBlock *block = arena->blocks;
+    while (block) {
+        SIArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    SIArenaInit(arena);
+}
+void SIArenaDestroy(SIArena *arena) {
+    SIArenaReset(arena);
+}
+SIArena *SIArenaCreate(void) {
+    SIArena *arena = malloc(sizeof(SIArena));
+    SIArenaInit(arena);
+    return arena;
+}
+void SIArenaRelease(SIArena *arena) {
+    if (!arena) return;
+    SIArenaDestroy(arena);
+    free(arena);
+}
@@ -0,0 +1,46 @@
+//
+//  SIArena.h
+//  SITypes
+//
+//  Bump allocator for transient parser objects.
+//
+//  Copyright © 2025 PhySy Ltd. All rights reserved.
+//
+#ifndef SIArena_h
+#define SIArena_h
+#include <stddef.h>
+#define SIARENA_INLINE_SIZE 2048
+/**
+ * @brief Region that owns every node, term and expression built by one parse.
+ *
+ * Allocation bumps a cursor, first through a buffer embedded in the arena and
+ * then through malloc'd blocks of growing size.  Nothing is freed individually:
+ * SIArenaReset and SIArenaDestroy return all of it at once.  An arena lives on
+ * the stack for a single parse, so a short expression needs no heap allocation
+ * for its parse tree at all.
+ *
+ * Objects placed in an arena must not hold the only reference to heap memory
+ * they free themselves; OCType references they hold are still released by
+ * their owners before the arena goes away.
+ */
+typedef struct SIArenaBlock SIArenaBlock;
+typedef struct SIArena {
+    char *cursor;          // next free byte in the current block
+    char *limit;           // end of the current block
+    SIArenaBlock *blocks;  // malloc'd blocks, most recent first
+    size_t nextBlockSize;
+    _Alignas(max_align_t) char inlineBytes[SIARENA_INLINE_SIZE];
+} SIArena;
+/** @brief Prepares an arena, typically one declared on the stack. */
+void SIArenaInit(SIArena *arena);
+/** @brief Returns size bytes aligned for any object, or NULL if memory is exhausted. */
+void *SIArenaAlloc(SIArena *arena, size_t size);
+/** @brief Returns every allocation to the arena, keeping it ready for reuse. */
+void SIArenaReset(SIArena *arena);
+/** @brief Frees the arena's blocks; the arena itself is not freed. */
+void SIArenaDestroy(SIArena *arena);
+/** @brief Allocates and initializes an arena on the heap, for trees that outlive a parse. */
+SIArena *SIArenaCreate(void);
+/** @brief Destroys and frees an arena made by SIArenaCreate. */
+void SIArenaRelease(SIArena *arena);
+#endif /* SIArena_h */
@@ -39,7 +39,7 @@ static void impl_SIDimensionalityFinalize(const void *theType) {
 static OCStringRef impl_SIDimensionalityCopyFormattingDescription(OCTypeRef cf) {
     if (cf == NULL) return NULL;
     SIDimensionalityRef theDim = (SIDimensionalityRef)cf;
-    if (theDim->symbol != NULL) {
+    if (SIDimensionalityGetSymbol(theDim) != NULL) {
         return OCStringCreateCopy(theDim->symbol);
     }
     // Fallback: return a generic placeholder
@@ -80,6 +80,9 @@ static struct impl_SIDimensionality *SIDimensionalityAllocate() {
     }
     // Initialize type-specific fields
     obj->symbol = NULL;
+    obj->reduced = NULL;
+    obj->coherent_unit = NULL;
+    obj->coherent_unit_generation = 0;
     memset(obj->num_exp, 0, sizeof(obj->num_exp));
     memset(obj->den_exp, 0, sizeof(obj->den_exp));
     return obj;
@@ -89,7 +92,7 @@ OCDictionaryRef SIDimensionalityCopyDictionary(SIDimensionalityRef dim) {
     // 1) Create the mutable dictionary
     OCMutableDictionaryRef dict = OCDictionaryCreateMutable(0);
     // 2) Symbol
-    OCStringRef symCopy = OCStringCreateCopy(dim->symbol);
+    OCStringRef symCopy = OCStringCreateCopy(SIDimensionalityGetSymbol(dim));
     OCDictionaryAddValue(dict, STR("symbol"), symCopy);
     OCRelease(symCopy);
     // 3) Numerators & denominators as OCIndexArray
@@ -294,13 +297,18 @@ SIDimensionalityRef SIDimensionalityCreate(const uint8_t *num_exp, const uint8_t
         theDim->num_exp[i] = num_exp[i];
         theDim->den_exp[i] = den_exp[i];
     }
-    theDim->symbol = SIDimensionalityCreateSymbol(theDim);
+    // symbol is built on first use by SIDimensionalityGetSymbol
     return (SIDimensionalityRef)theDim;
 }
+OCStringRef SIDimensionalityGetSymbol(SIDimensionalityRef theDim) {
+    if (!theDim) return NULL;
+    if (!theDim->symbol) ((struct impl_SIDimensionality *)theDim)->symbol = SIDimensionalityCreateSymbol(theDim);
+    return theDim->symbol;
+}
 #pragma mark Accessors
 OCStringRef SIDimensionalityCopySymbol(SIDimensionalityRef theDim) {
     IF_NO_OBJECT_EXISTS_RETURN(theDim, NULL);
-    return OCStringCreateCopy(theDim->symbol);
+    return OCStringCreateCopy(SIDimensionalityGetSymbol(theDim));
 }
 int8_t SIDimensionalityReducedExponentAtIndex(SIDimensionalityRef theDim, SIBaseDimensionIndex index) {
     IF_NO_OBJECT_EXISTS_RETURN(theDim, 0);
@@ -341,7 +349,7 @@ SIDimensionalityRef SIDimensionalityWithBaseDimensionSymbol(OCStringRef theStrin
 #pragma mark Strings and Archiving
 void SIDimensionalityShow(SIDimensionalityRef theDim) {
     IF_NO_OBJECT_EXISTS_RETURN(theDim, );
-    OCStringShow((theDim)->symbol);
+    OCStringShow(SIDimensionalityGetSymbol(theDim));
     fprintf(stdout, "\n");
 }
 void SIDimensionalityShowFull(SIDimensionalityRef theDim) {
@@ -371,7 +379,7 @@ void SIDimensionalityShowFull(SIDimensionalityRef theDim) {
     OCStringShow(cf_string);
     OCRelease(cf_string);
     OCStringShow(STR("-------------------------------------------------------------------------------------------------------------"));
-    OCStringShow(theDim->symbol);
+    OCStringShow(SIDimensionalityGetSymbol(theDim));
     OCArrayRef quantities = SIDimensionalityCreateArrayOfQuantities(theDim);
     if (quantities) {
         for (uint64_t index = 0; index < OCArrayGetCount(quantities); index++) {
@@ -461,6 +469,8 @@ bool SIDimensionalityHasSameReducedDimensionality(SIDimensionalityRef theDim1, S
     IF_NO_OBJECT_EXISTS_RETURN(theDim2, NULL);
     if (theDim1 == theDim2)
         return true;
+    if (theDim1->reduced && theDim2->reduced)
+        return theDim1->reduced == theDim2->reduced;
     for (int i = 0; i < BASE_DIMENSION_COUNT; i++) {
         int theDim1_exponent = theDim1->num_exp[i] - theDim1->den_exp[i];
         int theDim2_exponent = theDim2->num_exp[i] - theDim2->den_exp[i];
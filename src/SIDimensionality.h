@@ -20,7 +20,8 @@
  * ## Concepts and Rationale
  * - **Dimensionality Model:** Each SIDimensionality encodes a rational exponent for each SI base dimension.
  * - **Base and Derived:** Represents base (fundamental) dimensionalities and all derived/compound types.
- * - **Immutability:** All objects are immutable and may be safely shared between threads.
+ * - **Immutability:** The exponents of an object never change; its symbol, reduced form and
+ *   coherent unit are filled in lazily on first use.
  * - **Parsing:** Expressions like `"L^2*M/T^2"` or `"T^-2"` are parsed and canonicalized.
  * - **Compatibility:** Provides strict equality, reduced-form (physical) compatibility, and classification (base/derived).
  *
@@ -34,7 +35,8 @@
  * ## Usage Notes
  * - **Memory Management:** All returned SIDimensionalityRef objects are immutable and managed by the library.
  *   Do **not** retain or release them unless explicitly stated.
- * - **Thread Safety:** All operations are thread-safe on distinct objects.
+ * - **Thread Safety:** Not thread-safe.  Interning and the lazily filled fields above are
+ *   unsynchronized, so calls from several threads must be serialized by the caller.
  * - **Pointer Safety:** All pointers must be non-NULL unless documented.
  *
  * @author Philip Grandinetti
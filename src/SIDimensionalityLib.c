@@ -1,6 +1,7 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "SIDimensionalityPrivate.h"
 #include "SITypes.h"
 // Local comparator for OCStringRef values (case-insensitive sort)
@@ -23,20 +24,94 @@ static SIDimensionalityRef SIDimensionalityWithExponents(uint8_t mass_num_exp, u
 OCMutableDictionaryRef dimLibrary = NULL;
 OCMutableDictionaryRef dimQuantitiesLibrary = NULL;
 static void DimensionalityLibraryBuild();
-/// Interns a freshly created dimensionality, returning an existing one if already present.
-static SIDimensionalityRef InternDim(SIDimensionalityRef dim) {
-    if (!dim) return NULL;
+// Open-addressing index over dimLibrary keyed on the 14 exponent bytes, so
+// interning an existing dimensionality needs neither an allocation nor a symbol.
+static SIDimensionalityRef *dimIndex = NULL;
+static size_t dimIndexCapacity = 0;  // power of two
+static size_t dimIndexCount = 0;
+static uint64_t DimIndexHash(const uint8_t *num_exp, const uint8_t *den_exp) {
+    // Pack the seven numerator and seven denominator exponents into two words
+    uint64_t num = 0, den = 0;
+    for (int i = 0; i < BASE_DIMENSION_COUNT; i++) {
+        num = (num << 8) | num_exp[i];
+        den = (den << 8) | den_exp[i];
+    }
+    uint64_t h = num * 0x9E3779B97F4A7C15ULL ^ den * 0xC2B2AE3D27D4EB4FULL;
+    return h ^ (h >> 31);
+}
+static SIDimensionalityRef DimIndexFind(const uint8_t *num_exp, const uint8_t *den_exp) {
+    if (!dimIndex) return NULL;
+    size_t mask = dimIndexCapacity - 1;
+    for (size_t i = DimIndexHash(num_exp, den_exp) & mask; dimIndex[i]; i = (i + 1) & mask) {
+        SIDimensionalityRef dim = dimIndex[i];
+        if (memcmp(dim->num_exp, num_exp, BASE_DIMENSION_COUNT) == 0 &&
+            memcmp(dim->den_exp, den_exp, BASE_DIMENSION_COUNT) == 0) return dim;
+    }
+    return NULL;
+}
+static void DimIndexPlace(SIDimensionalityRef dim) {
+    size_t mask = dimIndexCapacity - 1;
+    size_t i = DimIndexHash(dim->num_exp, dim->den_exp) & mask;
+    while (dimIndex[i]) i = (i + 1) & mask;
+    dimIndex[i] = dim;
+    dimIndexCount++;
+}
+static bool DimIndexInsert(SIDimensionalityRef dim) {
+    if ((dimIndexCount + 1) * 2 > dimIndexCapacity) {
+        size_t oldCapacity = dimIndexCapacity;
+        SIDimensionalityRef *old = dimIndex;
+        size_t capacity = oldCapacity ? oldCapacity * 2 : 256;
+        dimIndex = calloc(capacity, sizeof(SIDimensionalityRef));
+        if (!dimIndex) {
+            dimIndex = old;
+            return false;
+        }
+        dimIndexCapacity = capacity;
+        dimIndexCount = 0;
+        for (size_t i = 0; i < oldCapacity; i++)
+            if (old[i]) DimIndexPlace(old[i]);
+        free(old);
+    }
+    DimIndexPlace(dim);
+    return true;
+}
+static void DimIndexClear(void) {
+    free(dimIndex);
+    dimIndex = NULL;
+    dimIndexCapacity = 0;
+    dimIndexCount = 0;
+}
+static void DimIndexRebuild(void) {
+    DimIndexClear();
+    if (!dimLibrary) return;
+    OCArrayRef dims = OCDictionaryCreateArrayWithAllValues(dimLibrary);
+    if (!dims) return;
+    for (OCIndex i = 0; i < OCArrayGetCount(dims); i++) {
+        SIDimensionalityRef dim = OCArrayGetValueAtIndex(dims, i);
+        if (!DimIndexFind(dim->num_exp, dim->den_exp)) DimIndexInsert(dim);
+    }
+    OCRelease(dims);
+}
+/// Returns the interned dimensionality with these exponents, creating and registering it if needed.
+static SIDimensionalityRef InternExponents(const uint8_t *num_exp, const uint8_t *den_exp) {
     if (!dimLibrary) DimensionalityLibraryBuild();
-    // Lookup by symbol
-    SIDimensionalityRef existing = (SIDimensionalityRef)OCDictionaryGetValue(dimLibrary, dim->symbol);
+    SIDimensionalityRef existing = DimIndexFind(num_exp, den_exp);
+    if (existing) return existing;
+    SIDimensionalityRef dim = SIDimensionalityCreate(num_exp, den_exp);
+    if (!dim) return NULL;
+    // The library is keyed by symbol, so new entries format theirs once here
+    OCStringRef symbol = SIDimensionalityGetSymbol(dim);
+    existing = (SIDimensionalityRef)OCDictionaryGetValue(dimLibrary, symbol);
     if (existing) {
         OCRelease(dim);
+        DimIndexInsert(existing);
         return existing;
     }
     // Not found → insert as a static interned object
     OCTypeSetStaticInstance(dim, true);
-    OCDictionaryAddValue(dimLibrary, dim->symbol, dim);
+    OCDictionaryAddValue(dimLibrary, symbol, dim);
     OCRelease(dim);
+    DimIndexInsert(dim);
     return dim;
 }
 SIDimensionalityRef SIDimensionalityFromDictionary(OCDictionaryRef dict, OCStringRef *error) {
@@ -99,20 +174,7 @@ static SIDimensionalityRef AddDimensionalityToLibrary(
         temperature_den_exp,
         amount_den_exp,
         luminous_intensity_den_exp};
-    SIDimensionalityRef dim = SIDimensionalityCreate(num_exp, den_exp);
-    // Set dim to a static instance.
-    // This sets the reference count to 1 and prevents it from being released or retained
-    // by OCRelease an OCRetain.   This ensures that only one instance of the dimensionality
-    // exists in the library.
-    if (!OCDictionaryContainsKey(dimLibrary, dim->symbol)) {
-        OCTypeSetStaticInstance(dim, true);
-        OCDictionaryAddValue(dimLibrary, dim->symbol, dim);
-        OCRelease(dim);
-        return dim;
-    }
-    SIDimensionalityRef existingDim = OCDictionaryGetValue(dimLibrary, dim->symbol);
-    OCRelease(dim);
-    return existingDim;
+    return InternExponents(num_exp, den_exp);
 }
 SIDimensionalityRef SIDimensionalityForSymbol(OCStringRef symbol, OCStringRef *error) {
     if (symbol == NULL)
@@ -145,6 +207,7 @@ SIDimensionalityRef SIDimensionalityForQuantity(OCStringRef quantity, OCStringRe
 }
 SIDimensionalityRef SIDimensionalityByReducing(SIDimensionalityRef theDim) {
     IF_NO_OBJECT_EXISTS_RETURN(theDim, NULL);
+    if (theDim->reduced) return theDim->reduced;
     uint8_t num_exp[BASE_DIMENSION_COUNT];
     uint8_t den_exp[BASE_DIMENSION_COUNT];
     for (size_t i = 0; i < BASE_DIMENSION_COUNT; ++i) {
@@ -153,7 +216,9 @@ SIDimensionalityRef SIDimensionalityByReducing(SIDimensionalityRef theDim) {
         den_exp[i] = (diff < 0) ? -diff : 0;
     }
     // Delegate to the array‐based creator + interner
-    return SIDimensionalityWithExponentArrays(num_exp, den_exp);
+    SIDimensionalityRef reduced = SIDimensionalityWithExponentArrays(num_exp, den_exp);
+    ((struct impl_SIDimensionality *)theDim)->reduced = reduced;
+    return reduced;
 }
 SIDimensionalityRef SIDimensionalityByTakingNthRoot(SIDimensionalityRef theDim,
                                                     uint8_t root,
@@ -423,16 +488,13 @@ void SIDimensionalitySetLibrary(OCMutableDictionaryRef newDimLibrary) {
         if (dimLibrary)
             OCRelease(dimLibrary);
         dimLibrary = (OCMutableDictionaryRef)OCRetain(newDimLibrary);
+        DimIndexRebuild();
     }
 }
 #pragma mark Operations
 SIDimensionalityRef SIDimensionalityWithExponentArrays(const uint8_t *num_exp, const uint8_t *den_exp) {
     if (!num_exp || !den_exp) return NULL;
-    // Create the raw object
-    SIDimensionalityRef dim = SIDimensionalityCreate(num_exp, den_exp);
-    if (!dim) return NULL;
-    // Intern (or reuse) and return
-    return InternDim(dim);
+    return InternExponents(num_exp, den_exp);
 }
 static SIDimensionalityRef SIDimensionalityWithExponents(
     uint8_t mass_num_exp, uint8_t mass_den_exp,
@@ -506,8 +568,10 @@ void cleanupDimensionalityLibraries(void) {
     // 3) Finally release the dictionary itself
     OCRelease(dimLibrary);
     dimLibrary = NULL;
+    DimIndexClear();
 }
 void DimensionalityLibraryBuild() {
+    DimIndexClear();
     dimLibrary = OCDictionaryCreateMutable(0);
     dimQuantitiesLibrary = OCDictionaryCreateMutable(0);
     SIDimensionalityRef dim;
@@ -6,5 +6,14 @@
 //
 #ifndef SIDimensionalityParser_h
 #define SIDimensionalityParser_h
-extern OCStringRef dimensionalityError;
+/**
+ * @brief Per-call state shared by the dimensionality parser and its reentrant scanner.
+ *
+ * See SIUnitParseContext in SIUnitParser.h.
+ */
+typedef struct SIDimensionalityParseContext {
+    SIDimensionalityRef final_dimensionality;  // result of the last complete expression
+    OCStringRef error;                         // semantic error raised by an action or the scanner
+    bool syntax_error;                         // set by the parser's error routine
+} SIDimensionalityParseContext;
 #endif
@@ -2,15 +2,12 @@
     #include <stdio.h>
     #include "SITypes.h"
     #include "SIDimensionalityParser.h"
-
-    void yyerror(char *s, ...);
-    static SIDimensionalityRef final_dimensionality;
-    OCStringRef dimensionalityError;
-    int sidlex(void);
-
     %}
 
 %name-prefix="sid"
+%define api.pure full
+%parse-param {SIDimensionalityParseContext *ctx} {void *scanner}
+%lex-param {void *scanner}
 
 %union {
     SIDimensionalityRef dimensionality;
@@ -19,12 +16,17 @@
 
 %token <dimensionality> DIMENSIONALITY
 %token <iVal> INTEGER
+%code {
+    int sidlex(YYSTYPE *lvalp, void *scanner);
+    void yyerror(SIDimensionalityParseContext *ctx, void *scanner, const char *s);
+}
+
 %type <dimensionality> exp calclist
 %left '*' '/'
 %left '^'
 %%
 calclist: /* do nothing */ { $$ = NULL; }
-| calclist exp {final_dimensionality = $2;}
+| calclist exp {ctx->final_dimensionality = $2;}
 ;
 
 exp: '(' exp ')' {$$ = $2;}
@@ -34,8 +36,8 @@ exp: '(' exp ')' {$$ = $2;}
 | INTEGER '/' exp {
     if($1 == 1) {$$ = SIDimensionalityByRaisingToPowerWithoutReducing($3,-1);}
     else  {
-        dimensionalityError = STR("Unknown dimensionality symbol");
-        yyerror("Unknown unit symbol");
+        ctx->error = STR("Unknown dimensionality symbol");
+        yyerror(ctx, scanner, "Unknown unit symbol");
     }
 }
 | DIMENSIONALITY
@@ -43,10 +45,12 @@ exp: '(' exp ')' {$$ = $2;}
 
 %%
 
-extern int sid_scan_string(const char *);
-extern void sidlex_destroy(void);
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+extern int sidlex_init_extra(SIDimensionalityParseContext *ctx, void **scanner);
+extern YY_BUFFER_STATE sid_scan_string(const char *str, void *scanner);
+extern void sid_delete_buffer(YY_BUFFER_STATE buffer, void *scanner);
+extern int sidlex_destroy(void *scanner);
 
-bool sid_syntax_error;
 SIDimensionalityRef SIDimensionalityFromExpression(OCStringRef expression, OCStringRef *error)
 {
     if(error) if(*error) return NULL;
@@ -63,37 +67,41 @@ SIDimensionalityRef SIDimensionalityFromExpression(OCStringRef expression, OCStr
     OCStringFindAndReplace2(mutString,STR("•"),STR("*"));
     OCStringFindAndReplace2(mutString,STR("ϴ"), STR("@"));
 
-    final_dimensionality = NULL;
-    dimensionalityError = NULL;
-    sid_syntax_error = false;
+    // Per-call parse state; see SIUnitParseContext
+    SIDimensionalityParseContext ctx = {NULL, NULL, false};
     uint64_t length = OCStringGetLength(mutString);
     if(length) {
         const char *cString = OCStringGetCString(mutString);
-
-        sid_scan_string(cString);
-        sidparse();
-        sidlex_destroy();
-        OCRelease(mutString);
+        void *scanner = NULL;
+        if(sidlex_init_extra(&ctx, &scanner) == 0) {
+            YY_BUFFER_STATE buffer = sid_scan_string(cString, scanner);
+            sidparse(&ctx, scanner);
+            sid_delete_buffer(buffer, scanner);
+            sidlex_destroy(scanner);
+        }
+        else ctx.error = STR("Unable to create dimensionality scanner");
     }
+    OCRelease(mutString);
 
     // Check for syntax errors and reject the parse if any occurred
-    if(sid_syntax_error) {
-        if(final_dimensionality) {
-            OCRelease(final_dimensionality);
-            final_dimensionality = NULL;
+    if(ctx.syntax_error) {
+        if(ctx.final_dimensionality) {
+            OCRelease(ctx.final_dimensionality);
+            ctx.final_dimensionality = NULL;
         }
-        if(!dimensionalityError) {
-            dimensionalityError = STR("Invalid expression: addition and subtraction are not valid in dimensional analysis");
+        if(!ctx.error) {
+            ctx.error = STR("Invalid expression: addition and subtraction are not valid in dimensional analysis");
         }
     }
 
-    if(dimensionalityError) *error = dimensionalityError;
+    if(ctx.error && error) *error = ctx.error;
 
-    return final_dimensionality;
+    return ctx.final_dimensionality;
 }
 
-void yyerror(char *s, ...)
+void yyerror(SIDimensionalityParseContext *ctx, void *scanner, const char *s)
 {
-    (void)s;  // Unused parameter - required by bison parser generator convention
-    sid_syntax_error = true;
+    (void)scanner;  // Unused parameter - required by bison parser generator convention
+    (void)s;
+    ctx->syntax_error = true;
 }
@@ -9,8 +9,14 @@ struct impl_SIDimensionality {
     uint8_t num_exp[BASE_DIMENSION_COUNT];
     uint8_t den_exp[BASE_DIMENSION_COUNT];
     OCStringRef symbol;
+    // Lazily filled caches; every instance is interned, so these are stable pointers
+    SIDimensionalityRef reduced;       // SIDimensionalityByReducing result
+    SIUnitRef coherent_unit;           // SIUnitCoherentUnitFromDimensionality result
+    uint64_t coherent_unit_generation;  // unit-library generation coherent_unit belongs to
 };
 SIDimensionalityRef SIDimensionalityCreate(const uint8_t *num_exp, const uint8_t *den_exp);
+// Borrowed symbol, formatted on first request
+OCStringRef SIDimensionalityGetSymbol(SIDimensionalityRef theDim);
 OCDictionaryRef SIDimensionalityCopyDictionary(SIDimensionalityRef dim);
 SIDimensionalityRef SIDimensionalityFromDictionary(OCDictionaryRef dict, OCStringRef *error);
 SIDimensionalityRef SIDimensionalityWithExponentArrays(const uint8_t *num_exp, const uint8_t *den_exp);
@@ -0,0 +1,455 @@
+//
+//  SIQuantityArray.c
+//  SITypes
+//
+//  Copyright © 2017 PhySy Ltd. All rights reserved.
+//
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SITypes.h"
+static OCTypeID kSIQuantityArrayID = kOCNotATypeID;
+// SIQuantityArray Opaque Type
+struct impl_SIQuantityArray {
+    OCBase base;
+    // impl_SIQuantity Type attributes
+    SIUnitRef unit;
+    SINumberType type;
+    // impl_SIQuantityArray Type attributes
+    OCIndex count;
+    void *bytes;
+    bool ownsBytes;
+};
+OCTypeID SIQuantityArrayGetTypeID(void) {
+    if (kSIQuantityArrayID == kOCNotATypeID) kSIQuantityArrayID = OCRegisterType("SIQuantityArray", (OCTypeRef (*)(cJSON *, OCStringRef *))SIQuantityArrayCreateFromJSON);
+    return kSIQuantityArrayID;
+}
+static bool SIQuantityArrayIsValidNumericType(SINumberType type) {
+    return type == kSINumberFloat32Type || type == kSINumberFloat64Type ||
+           type == kSINumberComplex64Type || type == kSINumberComplex128Type;
+}
+static size_t SIQuantityArrayElementSize(SINumberType type) {
+    return (size_t)OCNumberTypeSize((OCNumberType)type);
+}
+static double complex SIQuantityArrayLoad(SINumberType type, const void *bytes, OCIndex index) {
+    switch (type) {
+        case kSINumberFloat32Type:
+            return ((const float *)bytes)[index];
+        case kSINumberFloat64Type:
+            return ((const double *)bytes)[index];
+        case kSINumberComplex64Type:
+            return ((const float complex *)bytes)[index];
+        case kSINumberComplex128Type:
+            return ((const double complex *)bytes)[index];
+    }
+    return nan(NULL);
+}
+static void SIQuantityArrayStore(SINumberType type, void *bytes, OCIndex index, double complex value) {
+    switch (type) {
+        case kSINumberFloat32Type:
+            ((float *)bytes)[index] = (float)creal(value);
+            break;
+        case kSINumberFloat64Type:
+            ((double *)bytes)[index] = creal(value);
+            break;
+        case kSINumberComplex64Type:
+            ((float complex *)bytes)[index] = (float complex)value;
+            break;
+        case kSINumberComplex128Type:
+            ((double complex *)bytes)[index] = value;
+            break;
+    }
+}
+static const char *SIQuantityArrayNumericTypeName(SINumberType type) {
+    switch (type) {
+        case kSINumberFloat32Type:
+            return "float32";
+        case kSINumberFloat64Type:
+            return "float64";
+        case kSINumberComplex64Type:
+            return "complex64";
+        case kSINumberComplex128Type:
+            return "complex128";
+    }
+    return "unknown";
+}
+static bool SIQuantityArrayNumericTypeFromName(const char *name, SINumberType *type) {
+    if (!name) return false;
+    if (strcmp(name, "float32") == 0) {
+        *type = kSINumberFloat32Type;
+    } else if (strcmp(name, "float64") == 0) {
+        *type = kSINumberFloat64Type;
+    } else if (strcmp(name, "complex64") == 0) {
+        *type = kSINumberComplex64Type;
+    } else if (strcmp(name, "complex128") == 0) {
+        *type = kSINumberComplex128Type;
+    } else {
+        return false;
+    }
+    return true;
+}
+static bool impl_SIQuantityArrayEqual(const void *theType1, const void *theType2) {
+    if (theType1 == theType2) return true;
+    if (theType1 == NULL || theType2 == NULL) return false;
+    SIQuantityArrayRef a1 = (SIQuantityArrayRef)theType1;
+    SIQuantityArrayRef a2 = (SIQuantityArrayRef)theType2;
+    if (a1->base.typeID != a2->base.typeID) return false;
+    if (a1->type != a2->type || a1->count != a2->count) return false;
+    if (!OCTypeEqual(a1->unit, a2->unit)) return false;
+    for (OCIndex i = 0; i < a1->count; i++) {
+        if (SIQuantityArrayLoad(a1->type, a1->bytes, i) != SIQuantityArrayLoad(a2->type, a2->bytes, i)) return false;
+    }
+    return true;
+}
+static void impl_SIQuantityArrayFinalize(const void *theType) {
+    if (theType == NULL) return;
+    struct impl_SIQuantityArray *theArray = (struct impl_SIQuantityArray *)(uintptr_t)theType;
+    // Units are library-owned static instances and are not retained here
+    theArray->unit = NULL;
+    if (theArray->ownsBytes) free(theArray->bytes);
+    theArray->bytes = NULL;
+    theArray->count = 0;
+}
+static OCStringRef impl_SIQuantityArrayCopyFormattingDescription(OCTypeRef theType) {
+    if (!theType) return OCStringCreateWithCString("(null)");
+    SIQuantityArrayRef theArray = (SIQuantityArrayRef)theType;
+    OCStringRef symbol = SIUnitCopySymbol(theArray->unit);
+    OCStringRef result = OCStringCreateWithFormat(STR("<SIQuantityArray %ld %s elements in %@>"),
+                                                  (long)theArray->count,
+                                                  SIQuantityArrayNumericTypeName(theArray->type),
+                                                  symbol ? symbol : STR(""));
+    if (symbol) OCRelease(symbol);
+    return result;
+}
+static cJSON *impl_SIQuantityArrayCopyJSON(const void *obj, bool typed, OCStringRef *outError) {
+    return SIQuantityArrayCopyAsJSON((SIQuantityArrayRef)obj, typed, outError);
+}
+static void *impl_SIQuantityArrayDeepCopy(const void *theType) {
+    if (!theType) return NULL;
+    SIQuantityArrayRef original = (SIQuantityArrayRef)theType;
+    return (void *)SIQuantityArrayCreate(original->unit, original->type, original->bytes, original->count, NULL);
+}
+static void *impl_SIQuantityArrayDeepCopyMutable(const void *theType) {
+    if (!theType) return NULL;
+    SIQuantityArrayRef original = (SIQuantityArrayRef)theType;
+    return (void *)SIQuantityArrayCreateMutable(original->unit, original->type, original->bytes, original->count, NULL);
+}
+static struct impl_SIQuantityArray *SIQuantityArrayAllocate(void) {
+    struct impl_SIQuantityArray *obj = OCTypeAlloc(struct impl_SIQuantityArray,
+                                                   SIQuantityArrayGetTypeID(),
+                                                   impl_SIQuantityArrayFinalize,
+                                                   impl_SIQuantityArrayEqual,
+                                                   impl_SIQuantityArrayCopyFormattingDescription,
+                                                   impl_SIQuantityArrayCopyJSON,
+                                                   impl_SIQuantityArrayDeepCopy,
+                                                   impl_SIQuantityArrayDeepCopyMutable);
+    obj->unit = NULL;
+    obj->type = kSINumberFloat64Type;
+    obj->count = 0;
+    obj->bytes = NULL;
+    obj->ownsBytes = false;
+    return obj;
+}
+#pragma mark Creators
+SIMutableQuantityArrayRef SIQuantityArrayCreateWithBytesNoCopy(SIUnitRef unit, SINumberType type, void *bytes, OCIndex count, bool freeWhenDone, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!SIQuantityArrayIsValidNumericType(type)) {
+        if (outError) *outError = STR("Invalid numeric type for SIQuantityArray");
+        return NULL;
+    }
+    if (count < 0 || (count > 0 && !bytes)) {
+        if (outError) *outError = STR("Invalid buffer for SIQuantityArray");
+        return NULL;
+    }
+    struct impl_SIQuantityArray *theArray = SIQuantityArrayAllocate();
+    if (!theArray) {
+        if (outError) *outError = STR("Failed to allocate SIQuantityArray");
+        return NULL;
+    }
+    theArray->unit = unit ? unit : SIUnitDimensionlessAndUnderived();
+    theArray->type = type;
+    theArray->count = count;
+    theArray->bytes = bytes;
+    theArray->ownsBytes = freeWhenDone;
+    return theArray;
+}
+SIMutableQuantityArrayRef SIQuantityArrayCreateMutable(SIUnitRef unit, SINumberType type, const void *values, OCIndex count, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!SIQuantityArrayIsValidNumericType(type)) {
+        if (outError) *outError = STR("Invalid numeric type for SIQuantityArray");
+        return NULL;
+    }
+    if (count < 0) {
+        if (outError) *outError = STR("Invalid count");
+        return NULL;
+    }
+    size_t size = SIQuantityArrayElementSize(type);
+    // calloc(0) may return NULL, so always allocate at least one element
+    void *bytes = calloc(count > 0 ? (size_t)count : 1, size);
+    if (!bytes) {
+        if (outError) *outError = STR("Failed to allocate SIQuantityArray storage");
+        return NULL;
+    }
+    if (values && count > 0) memcpy(bytes, values, (size_t)count * size);
+    SIMutableQuantityArrayRef theArray = SIQuantityArrayCreateWithBytesNoCopy(unit, type, bytes, count, true, outError);
+    if (!theArray) free(bytes);
+    return theArray;
+}
+SIQuantityArrayRef SIQuantityArrayCreate(SIUnitRef unit, SINumberType type, const void *values, OCIndex count, OCStringRef *outError) {
+    return (SIQuantityArrayRef)SIQuantityArrayCreateMutable(unit, type, values, count, outError);
+}
+SIQuantityArrayRef SIQuantityArrayCreateWithArrayOfScalars(OCArrayRef scalars, SIUnitRef unit, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!scalars) {
+        if (outError) *outError = STR("Input scalars array is NULL");
+        return NULL;
+    }
+    OCIndex count = OCArrayGetCount(scalars);
+    bool isComplex = false;
+    bool isWide = false;
+    for (OCIndex i = 0; i < count; i++) {
+        SIScalarRef scalar = OCArrayGetValueAtIndex(scalars, i);
+        if (!scalar || OCGetTypeID(scalar) != SIScalarGetTypeID()) {
+            if (outError) *outError = STR("Array element is not an SIScalar");
+            return NULL;
+        }
+        SINumberType type = SIQuantityGetNumericType((SIQuantityRef)scalar);
+        if (type == kSINumberComplex64Type || type == kSINumberComplex128Type) isComplex = true;
+        if (type == kSINumberFloat64Type || type == kSINumberComplex128Type) isWide = true;
+        if (!unit) unit = SIQuantityGetUnit((SIQuantityRef)scalar);
+    }
+    SINumberType type = isComplex ? (isWide ? kSINumberComplex128Type : kSINumberComplex64Type)
+                                  : (isWide ? kSINumberFloat64Type : kSINumberFloat32Type);
+    SIMutableQuantityArrayRef theArray = SIQuantityArrayCreateMutable(unit, type, NULL, count, outError);
+    if (!theArray) return NULL;
+    for (OCIndex i = 0; i < count; i++) {
+        SIScalarValue value = SIScalarValueFromScalar(OCArrayGetValueAtIndex(scalars, i));
+        if (!SIQuantityArraySetScalarValueAtIndex(theArray, i, value, outError)) {
+            OCRelease(theArray);
+            return NULL;
+        }
+    }
+    return theArray;
+}
+OCArrayRef SIQuantityArrayCreateArrayOfScalars(SIQuantityArrayRef theArray, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!theArray) {
+        if (outError) *outError = STR("Input SIQuantityArray is NULL");
+        return NULL;
+    }
+    OCMutableArrayRef scalars = OCArrayCreateMutable(theArray->count, &kOCTypeArrayCallBacks);
+    if (!scalars) {
+        if (outError) *outError = STR("Failed to create mutable array");
+        return NULL;
+    }
+    for (OCIndex i = 0; i < theArray->count; i++) {
+        SIScalarRef scalar = SIQuantityArrayCreateScalarAtIndex(theArray, i);
+        if (!scalar) {
+            OCRelease(scalars);
+            if (outError) *outError = STR("Failed to create SIScalar");
+            return NULL;
+        }
+        OCArrayAppendValue(scalars, scalar);
+        OCRelease(scalar);
+    }
+    return scalars;
+}
+#pragma mark JSON
+cJSON *SIQuantityArrayCopyAsJSON(SIQuantityArrayRef theArray, bool typed, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!theArray) {
+        if (outError) *outError = STR("SIQuantityArray input is NULL");
+        return cJSON_CreateNull();
+    }
+    cJSON *value = cJSON_CreateObject();
+    cJSON *values = cJSON_CreateArray();
+    if (!value || !values) {
+        cJSON_Delete(value);
+        cJSON_Delete(values);
+        if (outError) *outError = STR("Failed to create JSON object");
+        return cJSON_CreateNull();
+    }
+    cJSON_AddStringToObject(value, "numeric_type", SIQuantityArrayNumericTypeName(theArray->type));
+    OCStringRef symbol = SIUnitCopySymbol(theArray->unit);
+    const char *s = symbol ? OCStringGetCString(symbol) : NULL;
+    cJSON_AddStringToObject(value, "unit", s ? s : "");
+    if (symbol) OCRelease(symbol);
+    bool isComplex = theArray->type == kSINumberComplex64Type || theArray->type == kSINumberComplex128Type;
+    for (OCIndex i = 0; i < theArray->count; i++) {
+        double complex element = SIQuantityArrayLoad(theArray->type, theArray->bytes, i);
+        if (isComplex) {
+            // Complex numbers: serialize as object with real/imag parts, as SIScalar does
+            cJSON *complexObj = cJSON_CreateObject();
+            cJSON_AddNumberToObject(complexObj, "real", creal(element));
+            cJSON_AddNumberToObject(complexObj, "imag", cimag(element));
+            cJSON_AddItemToArray(values, complexObj);
+        } else {
+            cJSON_AddItemToArray(values, cJSON_CreateNumber(creal(element)));
+        }
+    }
+    cJSON_AddItemToObject(value, "values", values);
+    if (!typed) return value;
+    cJSON *entry = cJSON_CreateObject();
+    if (!entry) {
+        cJSON_Delete(value);
+        if (outError) *outError = STR("Failed to create JSON object");
+        return cJSON_CreateNull();
+    }
+    cJSON_AddStringToObject(entry, "type", "SIQuantityArray");
+    cJSON_AddItemToObject(entry, "value", value);
+    return entry;
+}
+SIQuantityArrayRef SIQuantityArrayCreateFromJSON(cJSON *json, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!cJSON_IsObject(json)) {
+        if (outError) *outError = STR("SIQuantityArray JSON must be an object");
+        return NULL;
+    }
+    // Typed format wraps the payload: {"type": "SIQuantityArray", "value": {...}}
+    cJSON *typeJson = cJSON_GetObjectItem(json, "type");
+    if (cJSON_IsString(typeJson)) {
+        if (strcmp(cJSON_GetStringValue(typeJson), "SIQuantityArray") != 0) {
+            if (outError) *outError = STR("JSON type is not SIQuantityArray");
+            return NULL;
+        }
+        json = cJSON_GetObjectItem(json, "value");
+        if (!cJSON_IsObject(json)) {
+            if (outError) *outError = STR("Missing SIQuantityArray value object");
+            return NULL;
+        }
+    }
+    SINumberType type;
+    cJSON *numericType = cJSON_GetObjectItem(json, "numeric_type");
+    if (!cJSON_IsString(numericType) || !SIQuantityArrayNumericTypeFromName(cJSON_GetStringValue(numericType), &type)) {
+        if (outError) *outError = STR("Invalid or missing numeric_type");
+        return NULL;
+    }
+    SIUnitRef unit = NULL;
+    cJSON *unitJson = cJSON_GetObjectItem(json, "unit");
+    if (cJSON_IsString(unitJson) && strlen(cJSON_GetStringValue(unitJson)) > 0) {
+        OCStringRef unitStr = OCStringCreateWithCString(cJSON_GetStringValue(unitJson));
+        if (unitStr) {
+            unit = SIUnitWithSymbol(unitStr);
+            OCRelease(unitStr);
+        }
+        if (!unit) {
+            if (outError) *outError = STR("Unknown unit in SIQuantityArray JSON");
+            return NULL;
+        }
+    }
+    cJSON *values = cJSON_GetObjectItem(json, "values");
+    if (!cJSON_IsArray(values)) {
+        if (outError) *outError = STR("Invalid or missing values array");
+        return NULL;
+    }
+    OCIndex count = cJSON_GetArraySize(values);
+    SIMutableQuantityArrayRef theArray = SIQuantityArrayCreateMutable(unit, type, NULL, count, outError);
+    if (!theArray) return NULL;
+    // cJSON arrays are linked lists, so walk once instead of indexing each element
+    OCIndex i = 0;
+    cJSON *item;
+    cJSON_ArrayForEach(item, values) {
+        double complex element;
+        if (cJSON_IsNumber(item)) {
+            element = cJSON_GetNumberValue(item);
+        } else if (cJSON_IsObject(item) && cJSON_IsNumber(cJSON_GetObjectItem(item, "real")) &&
+                   cJSON_IsNumber(cJSON_GetObjectItem(item, "imag"))) {
+            element = cJSON_GetNumberValue(cJSON_GetObjectItem(item, "real")) +
+                      I * cJSON_GetNumberValue(cJSON_GetObjectItem(item, "imag"));
+        } else {
+            OCRelease(theArray);
+            if (outError) *outError = STR("Invalid element in SIQuantityArray values");
+            return NULL;
+        }
+        SIQuantityArrayStore(type, theArray->bytes, i++, element);
+    }
+    return theArray;
+}
+#pragma mark Accessors
+OCIndex SIQuantityArrayGetCount(SIQuantityArrayRef theArray) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, 0);
+    return theArray->count;
+}
+SIUnitRef SIQuantityArrayGetUnit(SIQuantityArrayRef theArray) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, NULL);
+    return theArray->unit;
+}
+SINumberType SIQuantityArrayGetNumericType(SIQuantityArrayRef theArray) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, kSINumberFloat64Type);
+    return theArray->type;
+}
+bool SIQuantityArrayOwnsBytes(SIQuantityArrayRef theArray) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, false);
+    return theArray->ownsBytes;
+}
+const void *SIQuantityArrayGetBytePtr(SIQuantityArrayRef theArray) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, NULL);
+    return theArray->bytes;
+}
+void *SIQuantityArrayGetMutableBytePtr(SIMutableQuantityArrayRef theArray) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, NULL);
+    return theArray->bytes;
+}
+double complex SIQuantityArrayGetDoubleComplexValueAtIndex(SIQuantityArrayRef theArray, OCIndex index) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, nan(NULL));
+    if (index < 0 || index >= theArray->count) return nan(NULL);
+    return SIQuantityArrayLoad(theArray->type, theArray->bytes, index);
+}
+SIScalarValue SIQuantityArrayGetScalarValueAtIndex(SIQuantityArrayRef theArray, OCIndex index) {
+    SIScalarValue value = SIScalarValueMakeWithDouble(nan(NULL), NULL);
+    if (!theArray || index < 0 || index >= theArray->count) return value;
+    switch (theArray->type) {
+        case kSINumberFloat32Type:
+            return SIScalarValueMakeWithFloat(((const float *)theArray->bytes)[index], theArray->unit);
+        case kSINumberFloat64Type:
+            return SIScalarValueMakeWithDouble(((const double *)theArray->bytes)[index], theArray->unit);
+        case kSINumberComplex64Type:
+            return SIScalarValueMakeWithFloatComplex(((const float complex *)theArray->bytes)[index], theArray->unit);
+        case kSINumberComplex128Type:
+            return SIScalarValueMakeWithDoubleComplex(((const double complex *)theArray->bytes)[index], theArray->unit);
+    }
+    return value;
+}
+SIScalarRef SIQuantityArrayCreateScalarAtIndex(SIQuantityArrayRef theArray, OCIndex index) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, NULL);
+    if (index < 0 || index >= theArray->count) return NULL;
+    return SIScalarCreateWithScalarValue(SIQuantityArrayGetScalarValueAtIndex(theArray, index));
+}
+bool SIQuantityArraySetScalarValueAtIndex(SIMutableQuantityArrayRef theArray, OCIndex index, SIScalarValue value, OCStringRef *outError) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, false);
+    if (index < 0 || index >= theArray->count) {
+        if (outError) *outError = STR("Index out of range");
+        return false;
+    }
+    if (!SIScalarValueConvertToUnit(&value, theArray->unit, outError)) return false;
+    double complex element = SIScalarValueDoubleComplexValue(value);
+    bool isComplex = theArray->type == kSINumberComplex64Type || theArray->type == kSINumberComplex128Type;
+    if (!isComplex && cimag(element) != 0) {
+        if (outError) *outError = STR("Cannot store a complex value in a real SIQuantityArray");
+        return false;
+    }
+    SIQuantityArrayStore(theArray->type, theArray->bytes, index, element);
+    return true;
+}
+#pragma mark Operations
+bool SIQuantityArrayConvertToUnit(SIMutableQuantityArrayRef theArray, SIUnitRef unit, OCStringRef *outError) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, false);
+    if (!SIUnitConvertBuffer(theArray->unit, unit, theArray->type, theArray->bytes, theArray->bytes, (size_t)theArray->count, outError))
+        return false;
+    theArray->unit = unit;
+    return true;
+}
+bool SIQuantityArrayApplyConversionPlan(SIMutableQuantityArrayRef theArray, SIUnitConversionPlanRef plan, OCStringRef *outError) {
+    IF_NO_OBJECT_EXISTS_RETURN(theArray, false);
+    IF_NO_OBJECT_EXISTS_RETURN(plan, false);
+    if (theArray->unit != SIUnitConversionPlanGetFromUnit(plan)) {
+        if (outError) *outError = STR("Array unit does not match the conversion plan.");
+        return false;
+    }
+    if (!SIUnitConversionPlanApplyToBuffer(plan, theArray->type, theArray->bytes, theArray->bytes, (size_t)theArray->count, outError))
+        return false;
+    theArray->unit = SIUnitConversionPlanGetToUnit(plan);
+    return true;
+}
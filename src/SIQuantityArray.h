@@ -0,0 +1,108 @@
+/**
+ * @file SIQuantityArray.h
+ * @brief Declares SIQuantityArray, a columnar array of values sharing one unit.
+ *
+ * An SIQuantityArray stores a single SIUnitRef, a single SINumberType and a
+ * contiguous buffer of float, double, float complex or double complex values.
+ * It is the bulk counterpart of an OCArray of SIScalar objects: a million
+ * samples cost a million elements of raw storage instead of a million heap
+ * objects each carrying its own unit pointer and type tag.
+ *
+ * The buffer is either owned by the array or borrowed from the caller.
+ * Borrowed buffers must outlive the array and are never freed by it.
+ *
+ * The object layout begins with the same unit and numeric type fields as
+ * SIQuantity, so the SIQuantity functions accept an SIQuantityArrayRef cast
+ * to SIQuantityRef.
+ *
+ * @author Philip Grandinetti
+ */
+//
+//  SIQuantityArray.h
+//  SITypes
+//
+//  Copyright © 2017 PhySy Ltd. All rights reserved.
+//
+#ifndef SIQuantityArray_h
+#define SIQuantityArray_h
+#include "SITypes.h"
+/** @brief Returns the unique type identifier for SIQuantityArray objects. */
+OCTypeID SIQuantityArrayGetTypeID(void);
+#pragma mark Creators
+/**
+ * @brief Creates an array by copying count elements of the given numeric type.
+ * @param unit The unit shared by every element; NULL means dimensionless.
+ * @param type The numeric type of the elements.
+ * @param values Contiguous input values, or NULL to zero-fill.
+ * @param count Number of elements.
+ * @param outError Optional pointer to receive an error message.
+ * @return A new array (caller owns), or NULL on failure.
+ */
+SIQuantityArrayRef SIQuantityArrayCreate(SIUnitRef unit, SINumberType type, const void *values, OCIndex count, OCStringRef *outError);
+/** @brief Creates a mutable array by copying values, or zero-filled if values is NULL. */
+SIMutableQuantityArrayRef SIQuantityArrayCreateMutable(SIUnitRef unit, SINumberType type, const void *values, OCIndex count, OCStringRef *outError);
+/**
+ * @brief Creates a mutable array that wraps an existing buffer without copying it.
+ * @param unit The unit shared by every element; NULL means dimensionless.
+ * @param type The numeric type of the elements in bytes.
+ * @param bytes Contiguous storage for count elements.
+ * @param count Number of elements.
+ * @param freeWhenDone If true the array takes ownership and calls free() on bytes
+ *                     when finalized; if false the buffer is borrowed.
+ * @param outError Optional pointer to receive an error message.
+ * @return A new array (caller owns), or NULL on failure.
+ */
+SIMutableQuantityArrayRef SIQuantityArrayCreateWithBytesNoCopy(SIUnitRef unit, SINumberType type, void *bytes, OCIndex count, bool freeWhenDone, OCStringRef *outError);
+/**
+ * @brief Creates an array from an OCArray of SIScalar objects.
+ * @param scalars The scalars; all must share the reduced dimensionality of unit.
+ * @param unit Target unit, or NULL to use the unit of the first scalar.
+ * @param outError Optional pointer to receive an error message.
+ * @return A new array whose numeric type is wide enough for every scalar, or NULL on failure.
+ */
+SIQuantityArrayRef SIQuantityArrayCreateWithArrayOfScalars(OCArrayRef scalars, SIUnitRef unit, OCStringRef *outError);
+/**
+ * @brief Creates an OCArray holding one SIScalar per element.
+ * @param theArray The quantity array.
+ * @param outError Optional pointer to receive an error message.
+ * @return A new OCArray of SIScalar objects (caller owns), or NULL on failure.
+ */
+OCArrayRef SIQuantityArrayCreateArrayOfScalars(SIQuantityArrayRef theArray, OCStringRef *outError);
+/** @brief Converts the array to a typed or untyped cJSON representation. */
+cJSON *SIQuantityArrayCopyAsJSON(SIQuantityArrayRef theArray, bool typed, OCStringRef *outError);
+/** @brief Creates an array from the typed or untyped JSON produced by SIQuantityArrayCopyAsJSON. */
+SIQuantityArrayRef SIQuantityArrayCreateFromJSON(cJSON *json, OCStringRef *outError);
+#pragma mark Accessors
+/** @brief Returns the number of elements. */
+OCIndex SIQuantityArrayGetCount(SIQuantityArrayRef theArray);
+/** @brief Returns the unit shared by every element. */
+SIUnitRef SIQuantityArrayGetUnit(SIQuantityArrayRef theArray);
+/** @brief Returns the numeric type of the elements. */
+SINumberType SIQuantityArrayGetNumericType(SIQuantityArrayRef theArray);
+/** @brief Returns true if the array frees its buffer when finalized. */
+bool SIQuantityArrayOwnsBytes(SIQuantityArrayRef theArray);
+/** @brief Returns the contiguous element buffer. */
+const void *SIQuantityArrayGetBytePtr(SIQuantityArrayRef theArray);
+/** @brief Returns the contiguous element buffer for in-place modification. */
+void *SIQuantityArrayGetMutableBytePtr(SIMutableQuantityArrayRef theArray);
+/** @brief Returns the element at index, in the array's unit, as double complex. */
+double complex SIQuantityArrayGetDoubleComplexValueAtIndex(SIQuantityArrayRef theArray, OCIndex index);
+/** @brief Returns the element at index, in the array's unit, as a stack-allocated SIScalarValue. */
+SIScalarValue SIQuantityArrayGetScalarValueAtIndex(SIQuantityArrayRef theArray, OCIndex index);
+/** @brief Creates an SIScalar for the element at index (caller owns the result). */
+SIScalarRef SIQuantityArrayCreateScalarAtIndex(SIQuantityArrayRef theArray, OCIndex index);
+/**
+ * @brief Stores a value at index, converting it to the array's unit.
+ * @param theArray The mutable array.
+ * @param index The element index.
+ * @param value The value; a complex value with a nonzero imaginary part cannot be stored in a real array.
+ * @param outError Optional pointer to receive an error message.
+ * @return true on success.
+ */
+bool SIQuantityArraySetScalarValueAtIndex(SIMutableQuantityArrayRef theArray, OCIndex index, SIScalarValue value, OCStringRef *outError);
+#pragma mark Operations
+/** @brief Converts every element in place to a unit of the same reduced dimensionality, using SIUnitConvertBuffer. */
+bool SIQuantityArrayConvertToUnit(SIMutableQuantityArrayRef theArray, SIUnitRef unit, OCStringRef *outError);
+/** @brief Converts every element in place with a precomputed plan whose from unit is the array's unit. */
+bool SIQuantityArrayApplyConversionPlan(SIMutableQuantityArrayRef theArray, SIUnitConversionPlanRef plan, OCStringRef *outError);
+#endif /* SIQuantityArray_h */
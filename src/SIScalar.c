@@ -1014,6 +1014,19 @@ bool SIScalarConvertToUnit(SIMutableScalarRef theScalar, SIUnitRef unit, OCStrin
     }
     return false;
 }
+bool SIScalarApplyConversionPlan(SIMutableScalarRef theScalar, SIUnitConversionPlanRef plan, OCStringRef *error) {
+    if (error)
+        if (*error) return false;
+    IF_NO_OBJECT_EXISTS_RETURN(theScalar, false);
+    IF_NO_OBJECT_EXISTS_RETURN(plan, false);
+    if (theScalar->unit != SIUnitConversionPlanGetFromUnit(plan)) {
+        if (error) *error = STR("Scalar unit does not match the conversion plan.");
+        return false;
+    }
+    if (!SIUnitConversionPlanApplyToBuffer(plan, theScalar->type, &theScalar->value, &theScalar->value, 1, error)) return false;
+    theScalar->unit = SIUnitConversionPlanGetToUnit(plan);
+    return true;
+}
 bool SIScalarConvertToUnitWithString(SIMutableScalarRef theScalar, OCStringRef unitString, OCStringRef *error) {
     if (error)
         if (*error) return false;
@@ -3355,3 +3368,179 @@ OCArrayRef SIScalarCreateArrayFromNumberArray(const void *values, OCNumberType t
     }
     return arr;
 }
+#pragma mark Value Type
+static SINumberType SIScalarValueBestNumericType(SINumberType type1, SINumberType type2) {
+    bool isComplex = (type1 == kSINumberComplex64Type || type1 == kSINumberComplex128Type ||
+                      type2 == kSINumberComplex64Type || type2 == kSINumberComplex128Type);
+    bool isWide = (type1 == kSINumberFloat64Type || type1 == kSINumberComplex128Type ||
+                   type2 == kSINumberFloat64Type || type2 == kSINumberComplex128Type);
+    if (isComplex) return isWide ? kSINumberComplex128Type : kSINumberComplex64Type;
+    return isWide ? kSINumberFloat64Type : kSINumberFloat32Type;
+}
+static double complex SIScalarValueGet(const SIScalarValue *theValue) {
+    switch (theValue->type) {
+        case kSINumberFloat32Type:
+            return theValue->value.floatValue;
+        case kSINumberFloat64Type:
+            return theValue->value.doubleValue;
+        case kSINumberComplex64Type:
+            return theValue->value.floatComplexValue;
+        case kSINumberComplex128Type:
+            return theValue->value.doubleComplexValue;
+    }
+    return nan(NULL);
+}
+static bool SIScalarValueSet(SIScalarValue *theValue, double complex value) {
+    switch (theValue->type) {
+        case kSINumberFloat32Type:
+            theValue->value.floatValue = (float)creal(value);
+            return true;
+        case kSINumberFloat64Type:
+            theValue->value.doubleValue = creal(value);
+            return true;
+        case kSINumberComplex64Type:
+            theValue->value.floatComplexValue = (float complex)value;
+            return true;
+        case kSINumberComplex128Type:
+            theValue->value.doubleComplexValue = value;
+            return true;
+    }
+    return false;
+}
+static bool SIScalarValuePromote(SIScalarValue *theValue, SINumberType type) {
+    if (theValue->type == type) return true;
+    double complex value = SIScalarValueGet(theValue);
+    theValue->type = type;
+    return SIScalarValueSet(theValue, value);
+}
+SIScalarValue SIScalarValueMakeWithFloat(float input_value, SIUnitRef unit) {
+    SIScalarValue theValue = {.type = kSINumberFloat32Type, .unit = unit};
+    theValue.value.floatValue = input_value;
+    return theValue;
+}
+SIScalarValue SIScalarValueMakeWithDouble(double input_value, SIUnitRef unit) {
+    SIScalarValue theValue = {.type = kSINumberFloat64Type, .unit = unit};
+    theValue.value.doubleValue = input_value;
+    return theValue;
+}
+SIScalarValue SIScalarValueMakeWithFloatComplex(float complex input_value, SIUnitRef unit) {
+    SIScalarValue theValue = {.type = kSINumberComplex64Type, .unit = unit};
+    theValue.value.floatComplexValue = input_value;
+    return theValue;
+}
+SIScalarValue SIScalarValueMakeWithDoubleComplex(double complex input_value, SIUnitRef unit) {
+    SIScalarValue theValue = {.type = kSINumberComplex128Type, .unit = unit};
+    theValue.value.doubleComplexValue = input_value;
+    return theValue;
+}
+SIScalarValue SIScalarValueFromScalar(SIScalarRef theScalar) {
+    SIScalarValue theValue = {.type = kSINumberFloat64Type, .unit = NULL};
+    IF_NO_OBJECT_EXISTS_RETURN(theScalar, theValue);
+    theValue.type = theScalar->type;
+    theValue.value = theScalar->value;
+    theValue.unit = theScalar->unit;
+    return theValue;
+}
+SIScalarRef SIScalarCreateWithScalarValue(SIScalarValue theValue) {
+    return SIScalarCreate(theValue.unit, theValue.type, &theValue.value);
+}
+double complex SIScalarValueDoubleComplexValue(SIScalarValue theValue) {
+    return SIScalarValueGet(&theValue);
+}
+bool SIScalarValueConvertToUnit(SIScalarValue *theValue, SIUnitRef unit, OCStringRef *error) {
+    if (error && *error) return false;
+    if (!theValue || !theValue->unit || !unit) return false;
+    if (!SIDimensionalityHasSameReducedDimensionality(SIUnitGetDimensionality(theValue->unit), SIUnitGetDimensionality(unit))) {
+        if (error) *error = STR("Incompatible dimensionalities.");
+        return false;
+    }
+    if (theValue->unit == unit) return true;
+    double conversion = SIUnitConversion(theValue->unit, unit);
+    theValue->unit = unit;
+    return SIScalarValueSet(theValue, SIScalarValueGet(theValue) * conversion);
+}
+static bool SIScalarValueAddSigned(SIScalarValue *target, SIScalarValue input2, double sign, OCStringRef *error) {
+    if (error && *error) return false;
+    if (!target || !target->unit || !input2.unit) return false;
+    if (!SIDimensionalityHasSameReducedDimensionality(SIUnitGetDimensionality(target->unit),
+                                                      SIUnitGetDimensionality(input2.unit))) {
+        if (error) *error = STR("Incompatible dimensionalities.");
+        return false;
+    }
+    if (!SIScalarValuePromote(target, SIScalarValueBestNumericType(target->type, input2.type))) return false;
+    double complex value = SIScalarValueGet(&input2);
+    if (input2.unit != target->unit) value *= SIUnitConversion(input2.unit, target->unit);
+    return SIScalarValueSet(target, SIScalarValueGet(target) + sign * value);
+}
+bool SIScalarValueAdd(SIScalarValue *target, SIScalarValue input2, OCStringRef *error) {
+    return SIScalarValueAddSigned(target, input2, 1.0, error);
+}
+bool SIScalarValueSubtract(SIScalarValue *target, SIScalarValue input2, OCStringRef *error) {
+    return SIScalarValueAddSigned(target, input2, -1.0, error);
+}
+bool SIScalarValueMultiply(SIScalarValue *target, SIScalarValue input2, OCStringRef *error) {
+    if (error && *error) return false;
+    if (!target || !target->unit || !input2.unit) return false;
+    double unit_multiplier = 1.0;
+    SIUnitRef unit = SIUnitByMultiplying(target->unit, input2.unit, &unit_multiplier, error);
+    if (!unit) return false;
+    if (!SIScalarValuePromote(target, SIScalarValueBestNumericType(target->type, input2.type))) return false;
+    target->unit = unit;
+    double complex target_value = SIScalarValueGet(target);
+    double complex multiplier = SIScalarValueGet(&input2) * unit_multiplier;
+    // Same infinity rules as SIScalarMultiply: 0 × ∞ = ∞
+    bool target_is_inf = isinf(cabs(target_value));
+    bool multiplier_is_inf = isinf(cabs(multiplier));
+    if ((target_is_inf && cabs(multiplier) == 0.0) || (cabs(target_value) == 0.0 && multiplier_is_inf))
+        return SIScalarValueSet(target, INFINITY);
+    if (target_is_inf || multiplier_is_inf) return SIScalarValueSet(target, INFINITY * unit_multiplier);
+    return SIScalarValueSet(target, target_value * multiplier);
+}
+bool SIScalarValueDivide(SIScalarValue *target, SIScalarValue input2, OCStringRef *error) {
+    if (error && *error) return false;
+    if (!target || !target->unit || !input2.unit) return false;
+    double unit_multiplier = 1.0;
+    SIUnitRef unit = SIUnitByDividing(target->unit, input2.unit, &unit_multiplier, error);
+    if (!unit) return false;
+    if (!SIScalarValuePromote(target, SIScalarValueBestNumericType(target->type, input2.type))) return false;
+    target->unit = unit;
+    double complex divisor = SIScalarValueGet(&input2);
+    // Same rules as SIScalarDivide: x/0 = ∞, x/∞ = 0
+    if (cabs(divisor) == 0.0) return SIScalarValueSet(target, INFINITY * unit_multiplier);
+    if (isinf(cabs(divisor))) return SIScalarValueSet(target, 0.0);
+    return SIScalarValueSet(target, SIScalarValueGet(target) * (unit_multiplier / divisor));
+}
+OCComparisonResult SIScalarValueCompare(SIScalarValue theValue, SIScalarValue theOtherValue) {
+    if (!theValue.unit || !theOtherValue.unit) return kOCCompareError;
+    SIScalarValue converted = theOtherValue;
+    if (!SIScalarValueConvertToUnit(&converted, theValue.unit, NULL))
+        return kOCCompareUnequalDimensionalities;
+    double complex value1 = SIScalarValueGet(&theValue);
+    double complex value2 = SIScalarValueGet(&converted);
+    bool complex1 = theValue.type == kSINumberComplex64Type || theValue.type == kSINumberComplex128Type;
+    bool complex2 = converted.type == kSINumberComplex64Type || converted.type == kSINumberComplex128Type;
+    // Double-precision comparison only when both sides carry 64-bit parts
+    bool wide = (theValue.type == kSINumberFloat64Type || theValue.type == kSINumberComplex128Type) &&
+                (converted.type == kSINumberFloat64Type || converted.type == kSINumberComplex128Type);
+    if (complex1 && complex2) {
+        OCComparisonResult realResult = wide ? OCCompareDoubleValues(creal(value1), creal(value2))
+                                             : OCCompareFloatValues((float)creal(value1), (float)creal(value2));
+        OCComparisonResult imagResult = wide ? OCCompareDoubleValues(cimag(value1), cimag(value2))
+                                             : OCCompareFloatValues((float)cimag(value1), (float)cimag(value2));
+        return (realResult == kOCCompareEqualTo && imagResult == kOCCompareEqualTo) ? kOCCompareEqualTo : kOCCompareNoSingleValue;
+    }
+    if ((complex1 && cimag(value1) != 0.0) || (complex2 && cimag(value2) != 0.0)) return kOCCompareNoSingleValue;
+    return wide ? OCCompareDoubleValues(creal(value1), creal(value2))
+                : OCCompareFloatValues((float)creal(value1), (float)creal(value2));
+}
+bool SIScalarValueApplyConversionPlan(SIScalarValue *theValue, SIUnitConversionPlanRef plan, OCStringRef *error) {
+    if (error && *error) return false;
+    if (!theValue || !plan) return false;
+    if (theValue->unit != SIUnitConversionPlanGetFromUnit(plan)) {
+        if (error) *error = STR("Value unit does not match the conversion plan.");
+        return false;
+    }
+    if (!SIUnitConversionPlanApplyToBuffer(plan, theValue->type, &theValue->value, &theValue->value, 1, error)) return false;
+    theValue->unit = SIUnitConversionPlanGetToUnit(plan);
+    return true;
+}
@@ -20,8 +20,8 @@
  *   enabling type-safe, unit-aware calculations and dimensionality checking at runtime.
  * - **Element Types:** Supports single-precision, double-precision, and complex values to address
  *   a wide range of scientific and engineering applications.
- * - **Immutability and Mutability:** SIScalar objects are immutable by default to ensure safe sharing
- *   and thread safety. Mutable variants (`SIMutableScalarRef`) allow for in-place modifications where needed.
+ * - **Immutability and Mutability:** SIScalar objects are immutable by default to ensure safe sharing.
+ *   Mutable variants (`SIMutableScalarRef`) allow for in-place modifications where needed.
  * - **Units and Dimensionality:** All operations rigorously enforce unit compatibility. Arithmetic, conversion,
  *   and reduction routines ensure physically meaningful results.
  *
@@ -45,8 +45,8 @@
  * - **Memory Management:** All functions with `Create` or `Copy` in the name return new objects
  *   owned by the caller, who must release them with `OCRelease` to prevent memory leaks.
  * - **Pointer Safety:** All pointer arguments must be valid and non-NULL unless specifically documented.
- * - **Thread Safety:** Operations on distinct scalar instances are thread-safe; concurrent mutation
- *   of the same instance is not.
+ * - **Thread Safety:** Not thread-safe.  Scalar arithmetic and parsing go through the unit
+ *   library's unsynchronized caches (see SIUnit.h), so calls must be serialized by the caller.
  * - This API is intended for use in high-precision scientific and engineering software, providing
  *   robust unit-safety and extensibility for advanced numerical computations.
  *
@@ -162,6 +162,8 @@ SIScalarRef SIScalarCreateByReducingUnit(SIScalarRef theScalar);
 bool SIScalarReduceUnit(SIMutableScalarRef theScalar);
 /** @brief Convert a mutable scalar’s value and unit to another compatible unit. */
 bool SIScalarConvertToUnit(SIMutableScalarRef theScalar, SIUnitRef unit, OCStringRef *error);
+/** @brief Convert a mutable scalar in place with a precomputed plan whose from unit is the scalar’s unit. */
+bool SIScalarApplyConversionPlan(SIMutableScalarRef theScalar, SIUnitConversionPlanRef plan, OCStringRef *error);
 /** @brief Create a new SIScalar by converting to another unit of the same dimensionality. */
 SIScalarRef SIScalarCreateByConvertingToUnit(SIScalarRef theScalar, SIUnitRef unit, OCStringRef *error);
 /** @brief Create a new SIScalar by converting to another unit (given its string representation) of the same dimensionality. */
@@ -307,4 +309,106 @@ OCArrayRef SIScalarCreateArrayOfConversionQuantitiesScalarsAndStringValues(SISca
 OCArrayRef SIScalarCreateArrayOfConversionQuantitiesAndUnits(SIScalarRef theScalar,
                                                              OCStringRef quantity,
                                                              OCStringRef *outError);
+#pragma mark Value Type
+/**
+ * @brief Stack-allocated scalar for hot numeric loops.
+ *
+ * Mirrors SIScalarRef without the OCType header, reference count or heap
+ * allocation.  The unit is borrowed: library units are static instances and
+ * outlive any value that refers to them.
+ */
+struct SIScalarValue {
+    SINumberType type;
+    impl_SINumber value;
+    SIUnitRef unit;
+};
+/** @brief Makes a float value in the given unit. */
+SIScalarValue SIScalarValueMakeWithFloat(float input_value, SIUnitRef unit);
+/** @brief Makes a double value in the given unit. */
+SIScalarValue SIScalarValueMakeWithDouble(double input_value, SIUnitRef unit);
+/** @brief Makes a float complex value in the given unit. */
+SIScalarValue SIScalarValueMakeWithFloatComplex(float complex input_value, SIUnitRef unit);
+/** @brief Makes a double complex value in the given unit. */
+SIScalarValue SIScalarValueMakeWithDoubleComplex(double complex input_value, SIUnitRef unit);
+/** @brief Copies the type, value and unit of an SIScalar into a value. */
+SIScalarValue SIScalarValueFromScalar(SIScalarRef theScalar);
+/** @brief Creates an SIScalar from a value (caller owns the result). */
+SIScalarRef SIScalarCreateWithScalarValue(SIScalarValue theValue);
+/** @brief Returns the numeric value, in the value's own unit, as double complex. */
+double complex SIScalarValueDoubleComplexValue(SIScalarValue theValue);
+/** @brief Converts a value in place to a unit of the same reduced dimensionality. */
+bool SIScalarValueConvertToUnit(SIScalarValue *theValue, SIUnitRef unit, OCStringRef *error);
+/** @brief target += input2, promoting target to the best numeric type as SIScalarCreateByAdding does. */
+bool SIScalarValueAdd(SIScalarValue *target, SIScalarValue input2, OCStringRef *error);
+/** @brief target -= input2, promoting target to the best numeric type as SIScalarCreateBySubtracting does. */
+bool SIScalarValueSubtract(SIScalarValue *target, SIScalarValue input2, OCStringRef *error);
+/** @brief target *= input2 with unit reduction, following SIScalarCreateByMultiplying. */
+bool SIScalarValueMultiply(SIScalarValue *target, SIScalarValue input2, OCStringRef *error);
+/** @brief target /= input2 with unit reduction, following SIScalarCreateByDividing. */
+bool SIScalarValueDivide(SIScalarValue *target, SIScalarValue input2, OCStringRef *error);
+/** @brief Compares two values as SIScalarCompare does. */
+OCComparisonResult SIScalarValueCompare(SIScalarValue theValue, SIScalarValue theOtherValue);
+/** @brief Converts a value in place with a precomputed plan, as SIScalarApplyConversionPlan does. */
+bool SIScalarValueApplyConversionPlan(SIScalarValue *theValue, SIUnitConversionPlanRef plan, OCStringRef *error);
+#pragma mark Compiled Expressions
+/** @brief Returns the unique type identifier for SIScalarExpression objects. */
+OCTypeID SIScalarExpressionGetTypeID(void);
+/**
+ * @brief Compiles an expression once for repeated evaluation.
+ *
+ * Accepts everything SIScalarCreateFromExpression does, plus named inputs
+ * written as `$name` (e.g. "$m*$g*$h .. J").  Units are resolved and constant
+ * subexpressions folded at compile time.  Evaluation never modifies the
+ * compiled tree, so one expression can be evaluated any number of times.
+ *
+ * @param expression The expression text.
+ * @param error Optional pointer to receive an error message.
+ * @return A compiled expression (caller owns), or NULL on failure.
+ */
+SIScalarExpressionRef SIScalarExpressionCreate(OCStringRef expression, OCStringRef *error);
+/** @brief Returns the source text the expression was compiled from. */
+OCStringRef SIScalarExpressionGetExpression(SIScalarExpressionRef expr);
+/** @brief Returns the number of distinct `$name` inputs. */
+OCIndex SIScalarExpressionGetVariableCount(SIScalarExpressionRef expr);
+/** @brief Returns the name (without `$`) of the input in the given slot, in order of first appearance. */
+OCStringRef SIScalarExpressionGetVariableNameAtIndex(SIScalarExpressionRef expr, OCIndex index);
+/** @brief Returns the slot of a named input, or kOCNotFound. */
+OCIndex SIScalarExpressionGetIndexOfVariable(SIScalarExpressionRef expr, OCStringRef name);
+/**
+ * @brief Evaluates a compiled expression with one scalar per input slot.
+ * @param expr The compiled expression.
+ * @param values Scalars in slot order; they are read, never modified.
+ * @param count Must equal SIScalarExpressionGetVariableCount(expr).
+ * @param error Optional pointer to receive an error message.
+ * @return A new scalar (caller owns), or NULL on failure.
+ */
+SIScalarRef SIScalarExpressionCreateValue(SIScalarExpressionRef expr, const SIScalarRef *values, OCIndex count, OCStringRef *error);
+/** @brief Evaluates a compiled expression with inputs looked up by name in a dictionary of SIScalar values. */
+SIScalarRef SIScalarExpressionCreateValueWithBindings(SIScalarExpressionRef expr, OCDictionaryRef bindings, OCStringRef *error);
+/**
+ * @brief Evaluates a compiled expression over whole columns.
+ *
+ * Each input slot is bound to an SIQuantityArray; all columns must have the
+ * same number of rows.  Units and dimensionalities are checked once per batch
+ * and the arithmetic, roots, powers, exp/log and trigonometric functions then
+ * run as loops over the rows.  Expressions using other functions are
+ * evaluated row by row through SIScalarExpressionCreateValue.
+ *
+ * The loops compute in double precision for every numeric type.  For float64
+ * and complex128 columns they match SIScalarExpressionCreateValue to within
+ * double rounding; for float32 and complex64 columns, which the SIScalar
+ * operations compute in float, they agree only to float precision.
+ *
+ * @param expr The compiled expression.
+ * @param columns One array per input slot, in slot order.
+ * @param count Must equal SIScalarExpressionGetVariableCount(expr).
+ * @param error Optional pointer to receive an error message.
+ * @return A new array with one result per row, real unless some row has an
+ *         imaginary part (caller owns), or NULL on failure.
+ */
+SIQuantityArrayRef SIScalarExpressionCreateQuantityArray(SIScalarExpressionRef expr, const SIQuantityArrayRef *columns, OCIndex count, OCStringRef *error);
+/** @brief Converts a compiled expression to JSON (its source text). */
+cJSON *SIScalarExpressionCopyAsJSON(SIScalarExpressionRef expr, bool typed, OCStringRef *outError);
+/** @brief Compiles an expression from the JSON produced by SIScalarExpressionCopyAsJSON. */
+SIScalarExpressionRef SIScalarExpressionCreateFromJSON(cJSON *json, OCStringRef *outError);
 #endif /* SIScalar_h */
@@ -35,7 +35,26 @@ struct impl_scalarNodeConstantFunction {
     builtInConstantFunctions funcType;
     OCMutableStringRef string;
 } impl_scalarNodeConstantFunction;
+struct impl_scalarNodeVariable {
+    int nodeType;
+    OCIndex slot;
+} impl_scalarNodeVariable;
+static SIScalarRef builtInMathFunctionWithBindings(ScalarNodeMathFunctionRef func, const SIScalarRef *bindings, OCStringRef *errorString);
+// Evaluates an operand that the caller will modify in place.  Leaves hold
+// values owned by the tree (or bound by the caller), so they are copied first;
+// this keeps evaluation free of side effects on a compiled expression.
+static SIScalarRef ScalarNodeEvaluateOperand(ScalarNodeRef node, const SIScalarRef *bindings, OCStringRef *errorString) {
+    SIScalarRef scalar = ScalarNodeEvaluateWithBindings(node, bindings, errorString);
+    if (scalar && (node->nodeType == 'K' || node->nodeType == 'V')) {
+        scalar = SIScalarCreateMutableCopy(scalar);
+        if (scalar) OCAutorelease(scalar);
+    }
+    return scalar;
+}
 SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
+    return ScalarNodeEvaluateWithBindings(node, NULL, errorString);
+}
+SIScalarRef ScalarNodeEvaluateWithBindings(ScalarNodeRef node, const SIScalarRef *bindings, OCStringRef *errorString) {
     if (errorString)
         if (*errorString)
             return NULL;
@@ -44,12 +63,19 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             NumberRef leaf = (NumberRef)node;
             return leaf->number;
         }
+        case 'V': {
+            if (!bindings) {
+                if (errorString) *errorString = STR("Unbound variable.");
+                return NULL;
+            }
+            return bindings[((const struct impl_scalarNodeVariable *)node)->slot];
+        }
         case '+': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
-            SIScalarRef right = ScalarNodeEvaluate(node->right, errorString);
+            SIScalarRef right = ScalarNodeEvaluateWithBindings(node->right, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -64,11 +90,11 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return NULL;
         }
         case '-': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
-            SIScalarRef right = ScalarNodeEvaluate(node->right, errorString);
+            SIScalarRef right = ScalarNodeEvaluateWithBindings(node->right, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -83,11 +109,11 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return NULL;
         }
         case '*': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
-            SIScalarRef right = ScalarNodeEvaluate(node->right, errorString);
+            SIScalarRef right = ScalarNodeEvaluateWithBindings(node->right, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -99,11 +125,11 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return NULL;
         }
         case '/': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
-            SIScalarRef right = ScalarNodeEvaluate(node->right, errorString);
+            SIScalarRef right = ScalarNodeEvaluateWithBindings(node->right, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -115,7 +141,7 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return NULL;
         }
         case '!': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -127,11 +153,11 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return NULL;
         }
         case '^': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateOperand(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
-            SIScalarRef right = ScalarNodeEvaluate(node->right, errorString);
+            SIScalarRef right = ScalarNodeEvaluateOperand(node->right, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -193,7 +219,7 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return NULL;
         }
         case '|': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -204,7 +230,7 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return theScalar;
         }
         case 'M': {
-            SIScalarRef left = ScalarNodeEvaluate(node->left, errorString);
+            SIScalarRef left = ScalarNodeEvaluateWithBindings(node->left, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -215,7 +241,7 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
             return theScalar;
         }
         case 'F': {
-            SIScalarRef result = builtInMathFunction((ScalarNodeMathFunctionRef)node, errorString);
+            SIScalarRef result = builtInMathFunctionWithBindings((ScalarNodeMathFunctionRef)node, bindings, errorString);
             if (errorString)
                 if (*errorString)
                     return NULL;
@@ -233,8 +259,8 @@ SIScalarRef ScalarNodeEvaluate(ScalarNodeRef node, OCStringRef *errorString) {
     }
     return 0;
 }
-ScalarNodeRef ScalarNodeCreateInnerNode(int nodeType, ScalarNodeRef left, ScalarNodeRef right) {
-    struct impl_scalarNode *node = malloc(sizeof(struct impl_scalarNode));
+ScalarNodeRef ScalarNodeCreateInnerNode(SIArena *arena, int nodeType, ScalarNodeRef left, ScalarNodeRef right) {
+    struct impl_scalarNode *node = SIArenaAlloc(arena, sizeof(struct impl_scalarNode));
     if (NULL == node) {
         fprintf(stderr, "ScalarNodeCreateInnerNode: Memory allocation failed.\n");
         return NULL;  // Handle memory allocation failure
@@ -244,8 +270,8 @@ ScalarNodeRef ScalarNodeCreateInnerNode(int nodeType, ScalarNodeRef left, Scalar
     node->right = right;
     return node;
 }
-ScalarNodeRef ScalarNodeCreateMathFunction(builtInMathFunctions funcType, ScalarNodeRef left) {
-    struct impl_scalarNodeMathFunction *node = malloc(sizeof(struct impl_scalarNodeMathFunction));
+ScalarNodeRef ScalarNodeCreateMathFunction(SIArena *arena, builtInMathFunctions funcType, ScalarNodeRef left) {
+    struct impl_scalarNodeMathFunction *node = SIArenaAlloc(arena, sizeof(struct impl_scalarNodeMathFunction));
     if (NULL == node) {
         fprintf(stderr, "ScalarNodeCreateMathFunction: Memory allocation failed.\n");
         return NULL;  // Handle memory allocation failure
@@ -255,8 +281,8 @@ ScalarNodeRef ScalarNodeCreateMathFunction(builtInMathFunctions funcType, Scalar
     node->funcType = funcType;
     return (ScalarNodeRef)node;
 }
-ScalarNodeRef ScalarNodeCreateConstantFunction(builtInConstantFunctions funcType, OCMutableStringRef string) {
-    struct impl_scalarNodeConstantFunction *node = malloc(sizeof(struct impl_scalarNodeConstantFunction));
+ScalarNodeRef ScalarNodeCreateConstantFunction(SIArena *arena, builtInConstantFunctions funcType, OCMutableStringRef string) {
+    struct impl_scalarNodeConstantFunction *node = SIArenaAlloc(arena, sizeof(struct impl_scalarNodeConstantFunction));
     if (NULL == node) {
         fprintf(stderr, "ScalarNodeCreateConstantFunction: Memory allocation failed.\n");
         return NULL;  // Handle memory allocation failure
@@ -266,8 +292,8 @@ ScalarNodeRef ScalarNodeCreateConstantFunction(builtInConstantFunctions funcType
     node->funcType = funcType;
     return (ScalarNodeRef)node;
 }
-ScalarNodeRef ScalarNodeCreateNumberLeaf(SIScalarRef number) {
-    struct impl_scalarValue *leaf = malloc(sizeof(struct impl_scalarValue));
+ScalarNodeRef ScalarNodeCreateNumberLeaf(SIArena *arena, SIScalarRef number) {
+    struct impl_scalarValue *leaf = SIArenaAlloc(arena, sizeof(struct impl_scalarValue));
     if (NULL == leaf) {
         fprintf(stderr, "ScalarNodeCreateNumberLeaf: Memory allocation failed.\n");
         return NULL;  // Handle memory allocation failure
@@ -276,48 +302,137 @@ ScalarNodeRef ScalarNodeCreateNumberLeaf(SIScalarRef number) {
     leaf->number = number;
     return (ScalarNodeRef)leaf;
 }
+ScalarNodeRef ScalarNodeCreateVariableLeaf(SIArena *arena, OCIndex slot) {
+    struct impl_scalarNodeVariable *leaf = SIArenaAlloc(arena, sizeof(struct impl_scalarNodeVariable));
+    if (NULL == leaf) {
+        fprintf(stderr, "ScalarNodeCreateVariableLeaf: Memory allocation failed.\n");
+        return NULL;  // Handle memory allocation failure
+    }
+    leaf->nodeType = 'V';
+    leaf->slot = slot;
+    return (ScalarNodeRef)leaf;
+}
 char ScalarNodeGetType(ScalarNodeRef node) {
     return node->nodeType;
 }
 bool ScalarNodeisLeaf(ScalarNodeRef node) {
     return (node->nodeType == 'K');
 }
-void ScalarNodeFree(ScalarNodeRef node) {
-    if (node == NULL)
-        return;
+static bool ScalarNodeIsConstant(ScalarNodeRef node) {
+    switch (node->nodeType) {
+        case 'K':
+        case 'C':
+            return true;
+        case 'V':
+            return false;
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '^':
+        case 'L':
+            return ScalarNodeIsConstant(node->left) && ScalarNodeIsConstant(node->right);
+        case '|':
+        case 'M':
+        case '!':
+            return ScalarNodeIsConstant(node->left);
+        case 'F':
+            return ScalarNodeIsConstant(((ScalarNodeMathFunctionRef)node)->left);
+        default:
+            return false;
+    }
+}
+ScalarNodeRef ScalarNodeFold(ScalarNodeRef node, SIArena *arena, OCStringRef *errorString) {
+    if (node == NULL) return NULL;
+    if (errorString)
+        if (*errorString)
+            return node;
+    // Replace each maximal constant subtree by a leaf holding its value.  The
+    // values are autoreleased; the caller retains them with ScalarNodeRetainValues.
+    if (node->nodeType != 'K' && node->nodeType != 'L' && ScalarNodeIsConstant(node)) {
+        SIScalarRef value = ScalarNodeEvaluate(node, errorString);
+        if (!value) return node;
+        // The replaced subtree stays in the arena until the tree is released
+        ScalarNodeRef leaf = ScalarNodeCreateNumberLeaf(arena, value);
+        return leaf ? leaf : node;
+    }
+    struct impl_scalarNode *inner = (struct impl_scalarNode *)node;
     switch (node->nodeType) {
         case '+':
         case '-':
         case '*':
         case '/':
         case '^':
-        case 'L': {
-            // Binary operators: free right and left
-            ScalarNodeFree(node->right);
-            ScalarNodeFree(node->left);
+        case 'L':
+            inner->left = ScalarNodeFold(inner->left, arena, errorString);
+            inner->right = ScalarNodeFold(inner->right, arena, errorString);
             break;
-        }
         case '|':
         case 'M':
-        case '!': {
-            // Unary operators: free left
-            ScalarNodeFree(node->left);
+        case '!':
+            inner->left = ScalarNodeFold(inner->left, arena, errorString);
             break;
-        }
         case 'F': {
-            // Math function: free operand
-            ScalarNodeMathFunctionRef funcNode = (ScalarNodeMathFunctionRef)node;
-            ScalarNodeFree(funcNode->left);
+            struct impl_scalarNodeMathFunction *func = (struct impl_scalarNodeMathFunction *)node;
+            func->left = ScalarNodeFold(func->left, arena, errorString);
             break;
         }
-        case 'C':
+        default:
             break;
-        case 'K':
+    }
+    return node;
+}
+// Leaf values created by the scanner are autoreleased; a tree that outlives
+// its parse retains them, and releases them before its arena is destroyed.
+static void ScalarNodeApplyToValues(ScalarNodeRef node, bool retain) {
+    if (node == NULL) return;
+    switch (node->nodeType) {
+        case 'K': {
+            NumberRef leaf = (NumberRef)node;
+            if (leaf->number) {
+                if (retain)
+                    OCRetain(leaf->number);
+                else
+                    OCRelease(leaf->number);
+            }
+            break;
+        }
+        case 'C': {
+            ScalarNodeConstantFunctionRef func = (ScalarNodeConstantFunctionRef)node;
+            if (func->string) {
+                if (retain)
+                    OCRetain(func->string);
+                else
+                    OCRelease(func->string);
+            }
+            break;
+        }
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '^':
+        case 'L':
+            ScalarNodeApplyToValues(node->left, retain);
+            ScalarNodeApplyToValues(node->right, retain);
+            break;
+        case '|':
+        case 'M':
+        case '!':
+            ScalarNodeApplyToValues(node->left, retain);
+            break;
+        case 'F':
+            ScalarNodeApplyToValues(((ScalarNodeMathFunctionRef)node)->left, retain);
             break;
         default:
             break;
     }
-    free((void *)node);  // Always free the node structure itself
+}
+void ScalarNodeRetainValues(ScalarNodeRef node) {
+    ScalarNodeApplyToValues(node, true);
+}
+void ScalarNodeReleaseValues(ScalarNodeRef node) {
+    ScalarNodeApplyToValues(node, false);
 }
 SIScalarRef builtInConstantFunction(ScalarNodeConstantFunctionRef func, OCStringRef *errorString) {
     if (errorString)
@@ -385,11 +500,14 @@ SIScalarRef builtInConstantFunction(ScalarNodeConstantFunctionRef func, OCString
     return NULL;
 }
 SIScalarRef builtInMathFunction(ScalarNodeMathFunctionRef func, OCStringRef *errorString) {
+    return builtInMathFunctionWithBindings(func, NULL, errorString);
+}
+static SIScalarRef builtInMathFunctionWithBindings(ScalarNodeMathFunctionRef func, const SIScalarRef *bindings, OCStringRef *errorString) {
     if (errorString)
         if (*errorString)
             return NULL;
     builtInMathFunctions funcType = func->funcType;
-    SIScalarRef scalar = ScalarNodeEvaluate(func->left, errorString);
+    SIScalarRef scalar = ScalarNodeEvaluateOperand(func->left, bindings, errorString);
     if (NULL == scalar) return NULL;
     switch (funcType) {
         case BM_reduce: {
@@ -676,28 +794,399 @@ SIScalarRef builtInMathFunction(ScalarNodeMathFunctionRef func, OCStringRef *err
         }
     }
 }
-SIUnitRef ConversionWithDefinedUnit(OCMutableStringRef mutString, double *unit_multiplier, OCStringRef *errorString) {
-    if (errorString)
-        if (*errorString)
-            return NULL;
-    // Remove appended unit conversion
-    OCArrayRef conversions = OCStringCreateArrayBySeparatingStrings(mutString, STR(".."));
-    if (conversions) {
-        if (OCArrayGetCount(conversions) == 2) {
-            OCStringRef firstString = OCArrayGetValueAtIndex(conversions, 0);
-            OCStringRef secondString = OCArrayGetValueAtIndex(conversions, 1);
-            if (OCStringGetLength(firstString) == 0 || OCStringGetLength(secondString) == 0) {
-                OCRelease(conversions);
-                return NULL;
+#pragma mark Columnar Evaluation
+// Columnar evaluation walks the tree once per batch.  Units, dimensionality
+// checks and unit multipliers are worked out at each node exactly as the
+// SIScalar operations would, and only the numeric part runs per row.  A
+// constant column has values == NULL and stands for every row; other columns
+// own a malloc'd buffer of rows.  Stride 0 lets one loop serve both kinds.
+#define SCALAR_COLUMN_PTR(c) ((c)->values ? (const double complex *)(c)->values : &(c)->constant)
+#define SCALAR_COLUMN_STRIDE(c) ((c)->values ? 1 : 0)
+void ScalarColumnFree(ScalarColumn *column) {
+    if (!column) return;
+    free(column->values);
+    column->values = NULL;
+}
+// Returns a buffer for the result of combining a and b, taking over one of
+// their buffers when possible.  Constant results get NULL.
+static double complex *ScalarColumnTakeBuffer(ScalarColumn *a, ScalarColumn *b) {
+    double complex *out = NULL;
+    if (a && a->values) {
+        out = a->values;
+        a->values = NULL;
+    } else if (b && b->values) {
+        out = b->values;
+        b->values = NULL;
+    }
+    return out;
+}
+static bool ScalarColumnLoadVariable(SIQuantityArrayRef array, OCIndex rows, ScalarColumn *result, OCStringRef *errorString) {
+    if (!array || SIQuantityArrayGetCount(array) != rows) {
+        *errorString = STR("Columns must all have the same number of rows.");
+        return false;
+    }
+    double complex *values = malloc((size_t)(rows > 0 ? rows : 1) * sizeof(double complex));
+    if (!values) {
+        *errorString = STR("Memory allocation failed.");
+        return false;
+    }
+    const void *bytes = SIQuantityArrayGetBytePtr(array);
+    SINumberType type = SIQuantityArrayGetNumericType(array);
+    switch (type) {
+        case kSINumberFloat32Type: {
+            const float *in = bytes;
+            for (OCIndex i = 0; i < rows; i++) values[i] = in[i];
+            break;
+        }
+        case kSINumberFloat64Type: {
+            const double *in = bytes;
+            for (OCIndex i = 0; i < rows; i++) values[i] = in[i];
+            break;
+        }
+        case kSINumberComplex64Type: {
+            const float complex *in = bytes;
+            for (OCIndex i = 0; i < rows; i++) values[i] = in[i];
+            break;
+        }
+        default:
+            memcpy(values, bytes, (size_t)rows * sizeof(double complex));
+            break;
+    }
+    result->unit = SIQuantityArrayGetUnit(array);
+    result->isComplex = (type == kSINumberComplex64Type || type == kSINumberComplex128Type);
+    result->constant = 0;
+    result->values = values;
+    return true;
+}
+// Scales every row of a column in place.
+static void ScalarColumnScale(ScalarColumn *column, OCIndex rows, double factor) {
+    if (factor == 1.0) return;
+    if (!column->values) {
+        column->constant *= factor;
+        return;
+    }
+    double complex *restrict v = column->values;
+    for (OCIndex i = 0; i < rows; i++) v[i] *= factor;
+}
+// Converts a dimensionless column to its coherent unit, as SIScalarConvertToCoherentUnit does.
+static bool ScalarColumnMakeDimensionless(ScalarColumn *column, OCIndex rows) {
+    SIDimensionalityRef dimensionality = SIUnitGetDimensionality(column->unit);
+    if (!SIDimensionalityIsDimensionless(dimensionality)) return false;
+    ScalarColumnScale(column, rows, SIUnitConversion(column->unit, SIUnitCoherentUnitFromDimensionality(dimensionality)));
+    return true;
+}
+static bool ScalarColumnBinary(int op, ScalarColumn *a, ScalarColumn *b, OCIndex rows, ScalarColumn *result, OCStringRef *errorString) {
+    double multiplier = 1.0;
+    SIUnitRef unit = NULL;
+    switch (op) {
+        case '+':
+        case '-':
+            if (!SIDimensionalityHasSameReducedDimensionality(SIUnitGetDimensionality(a->unit), SIUnitGetDimensionality(b->unit))) {
+                *errorString = STR("Incompatible dimensionalities.");
+                return false;
+            }
+            // The right operand is expressed in the left operand's unit
+            ScalarColumnScale(b, rows, SIUnitConversion(b->unit, a->unit));
+            unit = a->unit;
+            break;
+        case '*':
+            unit = SIUnitByMultiplyingWithoutReducing(a->unit, b->unit, &multiplier, errorString);
+            break;
+        default:
+            unit = SIUnitByDividingWithoutReducing(a->unit, b->unit, &multiplier, errorString);
+            break;
+    }
+    if (*errorString) return false;
+    const double complex *pa = SCALAR_COLUMN_PTR(a);
+    const double complex *pb = SCALAR_COLUMN_PTR(b);
+    OCIndex sa = SCALAR_COLUMN_STRIDE(a), sb = SCALAR_COLUMN_STRIDE(b);
+    double complex *out = ScalarColumnTakeBuffer(a, b);
+    OCIndex n = out ? rows : 1;
+    double complex constant = 0;
+    double complex *dst = out ? out : &constant;
+    switch (op) {
+        case '+':
+            for (OCIndex i = 0; i < n; i++) dst[i] = pa[i * sa] + pb[i * sb];
+            break;
+        case '-':
+            for (OCIndex i = 0; i < n; i++) dst[i] = pa[i * sa] - pb[i * sb];
+            break;
+        case '*':
+            // 0 × ∞ and ∞ × x follow SIScalarMultiplyWithoutReducingUnit
+            for (OCIndex i = 0; i < n; i++) {
+                double complex x = pa[i * sa], y = pb[i * sb] * multiplier;
+                bool xInf = isinf(cabs(x)), yInf = isinf(cabs(y));
+                if ((xInf && cabs(y) == 0.0) || (cabs(x) == 0.0 && yInf))
+                    dst[i] = INFINITY;
+                else if (xInf || yInf)
+                    dst[i] = INFINITY * multiplier;
+                else
+                    dst[i] = x * y;
+            }
+            break;
+        default:
+            // x / 0 and x / ∞ follow SIScalarDivideWithoutReducingUnit
+            for (OCIndex i = 0; i < n; i++) {
+                double complex divisor = pb[i * sb];
+                if (cabs(divisor) == 0.0)
+                    dst[i] = INFINITY * multiplier;
+                else if (isinf(cabs(divisor)))
+                    dst[i] = 0;
+                else
+                    dst[i] = pa[i * sa] * (multiplier / divisor);
             }
-            SIUnitRef finalUnit = SIUnitFromExpression(secondString, unit_multiplier, errorString);
-            if (finalUnit) {
-                OCStringReplaceAll(mutString, firstString);
-                OCRelease(conversions);
-                return finalUnit;
+            break;
+    }
+    result->unit = unit;
+    result->isComplex = a->isComplex || b->isComplex;
+    result->constant = constant;
+    result->values = out;
+    ScalarColumnFree(a);
+    ScalarColumnFree(b);
+    return true;
+}
+static bool ScalarColumnPower(ScalarColumn *a, ScalarColumn *b, OCIndex rows, ScalarColumn *result, OCStringRef *errorString) {
+    if (!SIUnitIsDimensionless(b->unit)) {
+        *errorString = STR("Powers must be dimensionless.");
+        return false;
+    }
+    double multiplier = 1.0;
+    SIUnitByReducing(b->unit, &multiplier);
+    ScalarColumnScale(b, rows, multiplier);
+    if (SIUnitIsDimensionless(a->unit) && SIUnitGetScaleToCoherentSI(a->unit) == 1.0) {
+        multiplier = 1.0;
+        SIUnitByReducing(a->unit, &multiplier);
+        ScalarColumnScale(a, rows, multiplier);
+        const double complex *pa = SCALAR_COLUMN_PTR(a);
+        const double complex *pb = SCALAR_COLUMN_PTR(b);
+        OCIndex sa = SCALAR_COLUMN_STRIDE(a), sb = SCALAR_COLUMN_STRIDE(b);
+        double complex *out = ScalarColumnTakeBuffer(a, b);
+        OCIndex n = out ? rows : 1;
+        double complex constant = 0;
+        double complex *dst = out ? out : &constant;
+        for (OCIndex i = 0; i < n; i++) {
+            double complex x = pa[i * sa], power = pb[i * sb];
+            if (cimag(power) == 0 && creal(power) == floor(creal(power)))
+                dst[i] = raise_to_integer_power(x, (long)creal(power));
+            else
+                dst[i] = cpow(x, power);
+            if (isnan(creal(dst[i])) && isnan(cimag(dst[i]))) {
+                free(out);
+                ScalarColumnFree(a);
+                ScalarColumnFree(b);
+                *errorString = STR("Overflow.");
+                return false;
             }
         }
-        OCRelease(conversions);
+        result->unit = SIUnitDimensionlessAndUnderived();
+        result->isComplex = true;
+        result->constant = constant;
+        result->values = out;
+        ScalarColumnFree(a);
+        ScalarColumnFree(b);
+        return true;
+    }
+    // A dimensioned base needs one power for the whole batch, since the power
+    // decides the result unit
+    if (b->values) return false;
+    if (cimag(b->constant) != 0) {
+        *errorString = STR("Powers must be real.");
+        return false;
+    }
+    int power = (int)creal(b->constant);
+    multiplier = 1.0;
+    SIUnitRef unit = SIUnitByRaisingToPowerWithoutReducing(a->unit, power, &multiplier, errorString);
+    if (*errorString || !unit) return false;
+    double complex *v = a->values ? a->values : &a->constant;
+    OCIndex n = a->values ? rows : 1;
+    for (OCIndex i = 0; i < n; i++) {
+        if (power == 0)
+            v[i] = multiplier;
+        else if (isinf(cabs(v[i])))
+            v[i] = INFINITY * multiplier;
+        else if (a->isComplex)
+            v[i] = cpow(v[i], power) * multiplier;
+        else
+            v[i] = pow(creal(v[i]), power) * multiplier;
+    }
+    *result = *a;
+    result->unit = unit;
+    a->values = NULL;
+    ScalarColumnFree(b);
+    return true;
+}
+static bool ScalarColumnFunction(builtInMathFunctions funcType, ScalarColumn *a, OCIndex rows, ScalarColumn *result, OCStringRef *errorString) {
+    double complex *v = a->values ? a->values : &a->constant;
+    OCIndex n = a->values ? rows : 1;
+    switch (funcType) {
+        case BM_sqrt:
+        case BM_cbrt:
+        case BM_qtrt: {
+            int root = funcType == BM_sqrt ? 2 : (funcType == BM_cbrt ? 3 : 4);
+            double multiplier = 1.0;
+            SIUnitRef unit = SIUnitByTakingNthRoot(a->unit, root, &multiplier, errorString);
+            if (!unit || *errorString) return false;
+            double reciprocal = 1.0 / root;
+            for (OCIndex i = 0; i < n; i++) {
+                if (isinf(cabs(v[i])))
+                    v[i] = INFINITY * multiplier;
+                else if (a->isComplex)
+                    v[i] = cpow(v[i], reciprocal) * multiplier;
+                else
+                    v[i] = pow(creal(v[i]), reciprocal) * multiplier;
+            }
+            a->unit = unit;
+            break;
+        }
+        case BM_exp:
+        case BM_ln:
+        case BM_log:
+        case BM_cos:
+        case BM_cosh:
+        case BM_sin:
+        case BM_sinh:
+        case BM_tan:
+        case BM_tanh:
+        case BM_acos:
+        case BM_acosh:
+        case BM_asin:
+        case BM_asinh:
+        case BM_atan:
+        case BM_atanh: {
+            if (!ScalarColumnMakeDimensionless(a, rows)) {
+                *errorString = STR("Transcendental functions require a dimensionless unit.");
+                return false;
+            }
+            switch (funcType) {
+                case BM_exp:
+                    for (OCIndex i = 0; i < n; i++) v[i] = cexp(v[i]);
+                    break;
+                case BM_ln:
+                    for (OCIndex i = 0; i < n; i++) v[i] = clog(v[i]);
+                    break;
+                case BM_log:
+                    for (OCIndex i = 0; i < n; i++) v[i] = clog(v[i]) / log(10);
+                    break;
+                case BM_cos:
+                    for (OCIndex i = 0; i < n; i++) v[i] = complex_cosine(v[i]);
+                    break;
+                case BM_cosh:
+                    for (OCIndex i = 0; i < n; i++) v[i] = ccosh(v[i]);
+                    break;
+                case BM_sin:
+                    for (OCIndex i = 0; i < n; i++) v[i] = complex_sine(v[i]);
+                    break;
+                case BM_sinh:
+                    for (OCIndex i = 0; i < n; i++) v[i] = csinh(v[i]);
+                    break;
+                case BM_tan:
+                    for (OCIndex i = 0; i < n; i++) v[i] = complex_tangent(v[i]);
+                    break;
+                case BM_tanh:
+                    for (OCIndex i = 0; i < n; i++) v[i] = ctanh(v[i]);
+                    break;
+                case BM_acos:
+                    for (OCIndex i = 0; i < n; i++) v[i] = cacos(v[i]);
+                    break;
+                case BM_acosh:
+                    for (OCIndex i = 0; i < n; i++) v[i] = cacosh(v[i]);
+                    break;
+                case BM_asin:
+                    for (OCIndex i = 0; i < n; i++) v[i] = casin(v[i]);
+                    break;
+                case BM_asinh:
+                    for (OCIndex i = 0; i < n; i++) v[i] = casinh(v[i]);
+                    break;
+                case BM_atan:
+                    for (OCIndex i = 0; i < n; i++) v[i] = catan(v[i]);
+                    break;
+                default:
+                    for (OCIndex i = 0; i < n; i++) v[i] = catanh(v[i]);
+                    break;
+            }
+            bool isInverse = funcType >= BM_acos && funcType <= BM_atanh;
+            a->unit = isInverse ? SIUnitWithSymbol(STR("rad")) : SIUnitDimensionlessAndUnderived();
+            a->isComplex = true;
+            break;
+        }
+        case BM_conj:
+            for (OCIndex i = 0; i < n; i++) v[i] = conj(v[i]);
+            break;
+        case BM_creal:
+            for (OCIndex i = 0; i < n; i++) v[i] = creal(v[i]);
+            a->isComplex = false;
+            break;
+        case BM_cimag:
+            for (OCIndex i = 0; i < n; i++) v[i] = cimag(v[i]);
+            a->isComplex = false;
+            break;
+        case BM_cabs:
+            for (OCIndex i = 0; i < n; i++) v[i] = cabs(v[i]);
+            a->isComplex = false;
+            break;
+        default:
+            // reduce, erf, erfc and carg keep their per-row evaluation
+            return false;
+    }
+    *result = *a;
+    a->values = NULL;
+    return true;
+}
+bool ScalarNodeEvaluateColumns(ScalarNodeRef node, const SIQuantityArrayRef *columns, OCIndex rows, ScalarColumn *result, OCStringRef *errorString) {
+    result->unit = NULL;
+    result->isComplex = false;
+    result->constant = 0;
+    result->values = NULL;
+    switch (node->nodeType) {
+        case 'K': {
+            SIScalarRef number = ((NumberRef)node)->number;
+            result->unit = SIQuantityGetUnit((SIQuantityRef)number);
+            result->isComplex = SIQuantityIsComplexType((SIQuantityRef)number);
+            result->constant = SIScalarDoubleComplexValue(number);
+            return true;
+        }
+        case 'V':
+            return ScalarColumnLoadVariable(columns[((const struct impl_scalarNodeVariable *)node)->slot], rows, result, errorString);
+        case '+':
+        case '-':
+        case '*':
+        case '/':
+        case '^': {
+            ScalarColumn a, b;
+            if (!ScalarNodeEvaluateColumns(node->left, columns, rows, &a, errorString)) return false;
+            if (!ScalarNodeEvaluateColumns(node->right, columns, rows, &b, errorString)) {
+                ScalarColumnFree(&a);
+                return false;
+            }
+            bool ok = node->nodeType == '^' ? ScalarColumnPower(&a, &b, rows, result, errorString)
+                                            : ScalarColumnBinary(node->nodeType, &a, &b, rows, result, errorString);
+            ScalarColumnFree(&a);
+            ScalarColumnFree(&b);
+            return ok;
+        }
+        case 'M':
+        case '|': {
+            if (!ScalarNodeEvaluateColumns(node->left, columns, rows, result, errorString)) return false;
+            double complex *v = result->values ? result->values : &result->constant;
+            OCIndex n = result->values ? rows : 1;
+            if (node->nodeType == 'M') {
+                for (OCIndex i = 0; i < n; i++) v[i] = -v[i];
+            } else {
+                for (OCIndex i = 0; i < n; i++) v[i] = cabs(v[i]);
+                result->isComplex = false;
+            }
+            return true;
+        }
+        case 'F': {
+            ScalarNodeMathFunctionRef func = (ScalarNodeMathFunctionRef)node;
+            ScalarColumn a;
+            if (!ScalarNodeEvaluateColumns(func->left, columns, rows, &a, errorString)) return false;
+            bool ok = ScalarColumnFunction(func->funcType, &a, rows, result, errorString);
+            ScalarColumnFree(&a);
+            return ok;
+        }
+        default:
+            // Gamma and unfolded constant functions keep their per-row evaluation
+            return false;
     }
-    return NULL;
 }
@@ -6,6 +6,7 @@
 //
 #ifndef SIScalarParser_h
 #define SIScalarParser_h
+#include "SIArena.h"
 #include "SIScalar.h"
 #include "SITypes.h"
 #include "SIUnitParser.h"
@@ -55,17 +56,51 @@ typedef enum builtInConstantFunctions {
     BC_Isotope_ElectricQuadrupole,
     BC_nmr
 } builtInConstantFunctions;
-extern OCStringRef scalarErrorString;
-ScalarNodeRef ScalarNodeCreateInnerNode(int nodeType, ScalarNodeRef left, ScalarNodeRef right);
-ScalarNodeRef ScalarNodeCreateNumberLeaf(SIScalarRef number);
-ScalarNodeRef ScalarNodeCreateMathFunction(builtInMathFunctions funcType, ScalarNodeRef left);
-ScalarNodeRef ScalarNodeCreateConstantFunction(builtInConstantFunctions funcType, OCMutableStringRef string);
-ScalarNodeRef NodeCreateImaginaryUnitLeaf(SIScalarRef number);
+/**
+ * @brief Per-call state shared by the scalar expression parser and its reentrant scanner.
+ *
+ * See SIUnitParseContext in SIUnitParser.h.
+ */
+typedef struct SIScalarParseContext {
+    ScalarNodeRef root;           // tree of the last complete expression, freed by the caller
+    SIScalarRef result;           // autoreleased value of root
+    OCStringRef error;            // error raised while evaluating or resolving units
+    OCStringRef syntax_message;   // message reported by the parser's error routine
+    bool syntax_error;            // set by the parser's error routine
+    double complex number;        // number awaiting its unit in the scanner's <together> state
+    OCMutableArrayRef variables;  // $name slots when compiling an SIScalarExpression, NULL otherwise
+    SIArena *arena;               // owns every node of the tree; the tree dies with it
+} SIScalarParseContext;
+/**
+ * @brief One node's result over a batch of rows.
+ *
+ * A constant column has values == NULL and holds the value of every row in
+ * constant.  Otherwise values is a malloc'd buffer of rows owned by the column.
+ */
+typedef struct ScalarColumn {
+    SIUnitRef unit;          // unit shared by every row
+    bool isComplex;          // numeric type the SIScalar path would carry
+    double complex constant;
+    double complex *values;
+} ScalarColumn;
+ScalarNodeRef ScalarNodeCreateInnerNode(SIArena *arena, int nodeType, ScalarNodeRef left, ScalarNodeRef right);
+ScalarNodeRef ScalarNodeCreateNumberLeaf(SIArena *arena, SIScalarRef number);
+ScalarNodeRef ScalarNodeCreateMathFunction(SIArena *arena, builtInMathFunctions funcType, ScalarNodeRef left);
+ScalarNodeRef ScalarNodeCreateConstantFunction(SIArena *arena, builtInConstantFunctions funcType, OCMutableStringRef string);
+ScalarNodeRef ScalarNodeCreateVariableLeaf(SIArena *arena, OCIndex slot);
 SIScalarRef ScalarNodeEvaluate(ScalarNodeRef tree, OCStringRef *errorString);
+SIScalarRef ScalarNodeEvaluateWithBindings(ScalarNodeRef tree, const SIScalarRef *bindings, OCStringRef *errorString);
+ScalarNodeRef ScalarNodeFold(ScalarNodeRef tree, SIArena *arena, OCStringRef *errorString);
+void ScalarNodeRetainValues(ScalarNodeRef tree);
+void ScalarNodeReleaseValues(ScalarNodeRef tree);
+// Returns false with *errorString set on an error, or false with *errorString
+// unset when the tree uses an operation that has no columnar form.  errorString
+// must not be NULL.
+bool ScalarNodeEvaluateColumns(ScalarNodeRef tree, const SIQuantityArrayRef *columns, OCIndex rows, ScalarColumn *result, OCStringRef *errorString);
+void ScalarColumnFree(ScalarColumn *column);
 SIScalarRef builtInMathFunction(ScalarNodeMathFunctionRef func, OCStringRef *errorString);
 SIScalarRef builtInConstantFunction(ScalarNodeConstantFunctionRef func, OCStringRef *errorString);
 bool ScalarNodeisLeaf(ScalarNodeRef node);
 char ScalarNodeGetType(ScalarNodeRef node);
-void ScalarNodeFree(ScalarNodeRef node);
-SIUnitRef ConversionWithDefinedUnit(OCMutableStringRef mutString, double *unit_multiplier, OCStringRef *errorString);
+char *SIScalarNormalizeExpression(const char *source, char *buffer, size_t capacity, SIUnitRef *finalUnitOut, OCStringRef *error);
 #endif  // SIScalarParser_h
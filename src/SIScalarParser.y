@@ -2,16 +2,12 @@
     #include "SITypes.h"
     #include "SIScalarParser.h"
     #include <ctype.h>
-    void siserror(char *s, ...);
-
-    ScalarNodeRef sis_root = NULL;
-
-    SIScalarRef result;
-    OCStringRef scalarError;
-    int sislex(void);
 %}
 
 %name-prefix="sis"
+%define api.pure full
+%parse-param {SIScalarParseContext *ctx} {void *scanner}
+%lex-param {void *scanner}
 
 %union {
     ScalarNodeRef            a;
@@ -20,16 +16,22 @@
     builtInMathFunctions     math_fn;
     builtInConstantFunctions const_fn;
     OCMutableStringRef       const_string;
+    OCIndex                  slot;
 }
 
-/* whenever Bison discards an 'exp' or 'explist', free its node */
-%destructor { ScalarNodeFree($$); } exp explist
+%code {
+    int sislex(YYSTYPE *lvalp, void *scanner);
+    void siserror(SIScalarParseContext *ctx, void *scanner, const char *s);
+}
+
+/* nodes live in ctx->arena, so values Bison discards need no destructor */
 
 /* declare tokens */
 %token <d> SCALAR
 %token <math_fn> MATH_FUNC
 %token <const_fn> CONST_FUNC
 %token <const_string> CONST_STRING
+%token <slot> VARIABLE
 %token EOL
 %left '='
 %left  '+' '-'
@@ -45,33 +47,31 @@ calclist:
       /* empty */
     | calclist exp
       {
-        sis_root = $2;
-        result = ScalarNodeEvaluate($2, &scalarError);
+        ctx->root = $2;
+        /* compiling keeps the tree for later evaluation with bound variables */
+        if (!ctx->variables) ctx->result = ScalarNodeEvaluate($2, &ctx->error);
       }
     ;
 
 exp:
-      exp '+' exp   { $$ = ScalarNodeCreateInnerNode('+',$1,$3); }
-    | exp '-' exp   { $$ = ScalarNodeCreateInnerNode('-',$1,$3); }
-    | exp '*' exp   { $$ = ScalarNodeCreateInnerNode('*',$1,$3); }
-    | exp '/' exp   { $$ = ScalarNodeCreateInnerNode('/',$1,$3); }
-    | exp '^' exp   { $$ = ScalarNodeCreateInnerNode('^',$1,$3); }
-    | '|' exp '|'   { $$ = ScalarNodeCreateInnerNode('|',$2,NULL); }
+      exp '+' exp   { $$ = ScalarNodeCreateInnerNode(ctx->arena,'+',$1,$3); }
+    | exp '-' exp   { $$ = ScalarNodeCreateInnerNode(ctx->arena,'-',$1,$3); }
+    | exp '*' exp   { $$ = ScalarNodeCreateInnerNode(ctx->arena,'*',$1,$3); }
+    | exp '/' exp   { $$ = ScalarNodeCreateInnerNode(ctx->arena,'/',$1,$3); }
+    | exp '^' exp   { $$ = ScalarNodeCreateInnerNode(ctx->arena,'^',$1,$3); }
+    | '|' exp '|'   { $$ = ScalarNodeCreateInnerNode(ctx->arena,'|',$2,NULL); }
     | '(' exp ')'   { $$ = $2; }
-    | '-' exp %prec UMINUS { $$ = ScalarNodeCreateInnerNode('M',$2,NULL); }
-    | exp '!'       { $$ = ScalarNodeCreateInnerNode('!',$1,NULL); }
-    | SCALAR        { if ($1==NULL) YYERROR; $$ = ScalarNodeCreateNumberLeaf($1); }
-    | MATH_FUNC '(' explist ')' { $$ = ScalarNodeCreateMathFunction($1,$3); }
-    | CONST_FUNC CONST_STRING   { $$ = ScalarNodeCreateConstantFunction($1,$2); }
+    | '-' exp %prec UMINUS { $$ = ScalarNodeCreateInnerNode(ctx->arena,'M',$2,NULL); }
+    | exp '!'       { $$ = ScalarNodeCreateInnerNode(ctx->arena,'!',$1,NULL); }
+    | SCALAR        { if ($1==NULL) YYERROR; $$ = ScalarNodeCreateNumberLeaf(ctx->arena,$1); }
+    | VARIABLE      { $$ = ScalarNodeCreateVariableLeaf(ctx->arena,$1); }
+    | MATH_FUNC '(' explist ')' { $$ = ScalarNodeCreateMathFunction(ctx->arena,$1,$3); }
+    | CONST_FUNC CONST_STRING   { $$ = ScalarNodeCreateConstantFunction(ctx->arena,$1,$2); }
     ;
 
 explist:
       exp
-    | exp ',' explist { $$ = ScalarNodeCreateInnerNode('L',$1,$3); }
+    | exp ',' explist { $$ = ScalarNodeCreateInnerNode(ctx->arena,'L',$1,$3); }
     ;
 
 %%
-
-extern int sis_scan_string(const char *);
-extern void sislex_destroy(void);
-bool sis_syntax_error;
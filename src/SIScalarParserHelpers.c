@@ -6,15 +6,12 @@
 #include "SIScalarParser.h"
 #include "SITypes.h"
 #include "SIUnitParser.h"
-extern bool sis_syntax_error;
-extern ScalarNodeRef sis_root;
-extern SIScalarRef result;
-extern OCStringRef scalarError;
-extern int sis_scan_string(const char *);
-extern int sisparse(void);
-extern void sislex_destroy(void);
-extern int sislex(void);
-OCStringRef scalarErrorString;
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+extern int sisparse(SIScalarParseContext *ctx, void *scanner);
+extern int sislex_init_extra(SIScalarParseContext *ctx, void **scanner);
+extern YY_BUFFER_STATE sis_scan_string(const char *str, void *scanner);
+extern void sis_delete_buffer(YY_BUFFER_STATE buffer, void *scanner);
+extern int sislex_destroy(void *scanner);
 // ——— UTF-8 iterator: decode next code-point and advance pointer ———
 static uint32_t utf8_next(const char **p) {
     const unsigned char *s = (const unsigned char *)*p;
@@ -53,225 +50,643 @@ static uint32_t utf8_next(const char **p) {
     }
     return ch;
 }
-/**
- * @brief  Produce a new OCMutableString in which implicit multiplications
- *         around “(” and “)” have “*” inserted.
- * @param  original   The original mutable string (unchanged).
- * @return A brand-new OCMutableStringRef; caller must release it.
- */
-OCMutableStringRef
-insertAsterisks(OCMutableStringRef original) {
-    if (!original) return NULL;
-    const char *src = OCStringGetCString((OCStringRef)original);
-    if (!src) return NULL;
-    // 1) Measure code-points & collect code-point values
-    size_t cp_count = OCStringGetLength((OCStringRef)original);
-    uint32_t *cps = malloc(cp_count * sizeof(uint32_t));
-    if (NULL == cps) {
-        fprintf(stderr, "insertAsterisks: Memory allocation failed for code points.\n");
-        return NULL;
-    }
-    size_t *byte_off = malloc((cp_count + 1) * sizeof(size_t));
-    if (NULL == byte_off) {
-        fprintf(stderr, "insertAsterisks: Memory allocation failed for byte offsets.\n");
-        free(cps);
-        return NULL;
-    }
-    const char *p = src;
-    size_t bo = 0;
-    for (size_t i = 0; i < cp_count; i++) {
-        byte_off[i] = bo;
-        cps[i] = utf8_next(&p);
-        bo = p - src;
-    }
-    byte_off[cp_count] = bo;  // one past final byte
-    size_t orig_bytes = bo;
-    // 2) Determine where to insert “*”
-    bool *ins_before = calloc(cp_count, sizeof(bool));
-    if (!ins_before) {
-        fprintf(stderr, "insertAsterisks: Memory allocation failed for insertion flags.\n");
-        free(cps);
-        free(byte_off);
-        return NULL;
+// Spellings the scalar scanner does not read, mapped to the ones it does.
+typedef struct {
+    const char *spelling;
+    uint8_t length;
+    const char *replacement;
+} SIScalarOperatorSpelling;
+static const SIScalarOperatorSpelling kSIScalarOperatorSpellings[] = {
+    {"•", 3, "*"},
+    {"×", 2, "*"},
+    {"÷", 2, "/"},
+    {"−", 3, "-"},
+    {"μ", 2, "µ"},  // Greek mu → micro
+    {"γ", 2, "𝛾"},
+    {"ɣ", 2, "𝛾"},
+    {"º", 2, "°"},
+    {"√", 3, "sqrt"},
+    {"∛", 3, "cbrt"},
+    {"∜", 3, "qtrt"},
+};
+// Output cursor of the normalizer, with the state needed to place the
+// implicit "*" around parentheses as each code point is written.
+typedef struct {
+    char *cursor;
+    int bracketLevel;
+    uint32_t previous;
+    bool hasPrevious;
+} SIScalarNormalizer;
+static void SIScalarNormalizerEmit(SIScalarNormalizer *n, const char *bytes, size_t length) {
+    const char *p = bytes;
+    const char *end = bytes + length;
+    while (p < end) {
+        const char *start = p;
+        uint32_t cp = utf8_next(&p);
+        if (p > end) p = end;
+        if (cp == '[') n->bracketLevel++;
+        if (n->hasPrevious && n->previous == ')') {
+            // ")" followed by a term, at the same bracket level
+            if (cp != '+' && cp != '-' && cp != '*' && cp != '/' && cp != '^' &&
+                cp != ')' && cp != 0x2022 /* bullet */ && cp != '[')
+                *n->cursor++ = '*';
+        } else if (cp == '(' && n->hasPrevious && n->bracketLevel == 0 &&
+                   characterIsDigitOrDecimalPoint(n->previous)) {
+            // "2(" outside [ ]
+            *n->cursor++ = '*';
+        }
+        memcpy(n->cursor, start, (size_t)(p - start));
+        n->cursor += p - start;
+        if (cp == ']' && n->bracketLevel > 0) n->bracketLevel--;
+        n->previous = cp;
+        n->hasPrevious = true;
     }
-    bool *ins_after = calloc(cp_count, sizeof(bool));
-    if (!ins_after) {
-        fprintf(stderr, "insertAsterisks: Memory allocation failed for insertion flags.\n");
-        free(cps);
-        free(byte_off);
-        free(ins_before);
-        return NULL;
+}
+// Returns the end of pattern matched at p, reading across line breaks (and
+// spaces when asked), or NULL.  The pattern is lower case when caseless.
+static const char *SIScalarMatchAcrossWhitespace(const char *p, const char *end, const char *pattern, bool skipSpaces, bool caseless) {
+    for (; *pattern; pattern++, p++) {
+        while (p < end && (*p == '\n' || (skipSpaces && *p == ' '))) p++;
+        if (p == end) return NULL;
+        char c = caseless ? (char)tolower((unsigned char)*p) : *p;
+        if (c != *pattern) return NULL;
     }
-    // Track square-bracket nesting
-    int bracket_level = 0;
-    int *levels = malloc(cp_count * sizeof(int));
-    if (NULL == levels) {
-        fprintf(stderr, "insertAsterisks: Memory allocation failed for bracket levels.\n");
-        free(cps);
-        free(byte_off);
-        free(ins_before);
-        free(ins_after);
-        return NULL;
+    return p;
+}
+// Rewrites an expression for the scanner in one pass over its UTF-8 bytes:
+// splits off an "expression .. finalUnit" suffix, maps Unicode operators to
+// the scanner's spellings, drops whitespace and inserts implicit "*" around
+// parentheses.  The result is written to buffer when it fits within capacity
+// and to a malloc'd string otherwise; the caller frees it if it is not buffer.
+char *SIScalarNormalizeExpression(const char *source, char *buffer, size_t capacity, SIUnitRef *finalUnitOut, OCStringRef *error) {
+    *finalUnitOut = NULL;
+    if (!source) return NULL;
+    size_t length = strlen(source);
+    // A final unit needs exactly one ".." with text on both sides
+    const char *separator = strstr(source, "..");
+    if (separator && separator != source && separator[2] && !strstr(separator + 2, "..")) {
+        OCStringRef unitExpression = OCStringCreateWithCString(separator + 2);
+        double unit_multiplier = 1.0;
+        *finalUnitOut = SIUnitFromExpression(unitExpression, &unit_multiplier, error);
+        OCRelease(unitExpression);
+        if (*finalUnitOut) length = (size_t)(separator - source);
     }
-    for (size_t i = 0; i < cp_count; i++) {
-        if (cps[i] == '[') {
-            bracket_level++;
+    // No spelling grows by more than its own length, and an implicit "*"
+    // always follows a one-byte ")" or digit
+    size_t needed = 2 * length + 1;
+    char *out = needed <= capacity ? buffer : malloc(needed);
+    if (!out) return NULL;
+    SIScalarNormalizer n = {.cursor = out};
+    const char *p = source;
+    const char *end = source + length;
+    while (p < end) {
+        if (*p == ' ' || *p == '\n') {
+            p++;
+            continue;
         }
-        levels[i] = bracket_level;
-        if (cps[i] == ']') {
-            bracket_level = (bracket_level > 0 ? bracket_level - 1 : 0);
+        const char *match;
+        // "h_p" is read across line breaks but not spaces; "qtertsp" across both
+        if (*p == 'h' && (match = SIScalarMatchAcrossWhitespace(p, end, "h_p", false, false))) {
+            SIScalarNormalizerEmit(&n, "h_P", 3);
+            p = match;
+            continue;
         }
-    }
-    for (size_t i = 0; i < cp_count; i++) {
-        // Insert before “(” if preceded by digit/point and not inside [ ]
-        if (cps[i] == '(' && i > 0 && levels[i - 1] == 0) {
-            if (characterIsDigitOrDecimalPoint(cps[i - 1])) {
-                ins_before[i] = true;
-            }
+        if ((*p == 'q' || *p == 'Q') && (match = SIScalarMatchAcrossWhitespace(p, end, "qtertsp", true, true))) {
+            SIScalarNormalizerEmit(&n, "quartertsp", 10);
+            p = match;
+            continue;
         }
-        // Insert after “)” if followed by a “term” and not inside [ ]
-        else if (cps[i] == ')' && i + 1 < cp_count && levels[i] == levels[i + 1]) {
-            uint32_t next = cps[i + 1];
-            if (next != '+' && next != '-' && next != '*' &&
-                next != '/' && next != '^' && next != ')' &&
-                next != 0x2022 /* bullet */) {
-                ins_after[i] = true;
+        const SIScalarOperatorSpelling *spelling = NULL;
+        if ((unsigned char)*p >= 0x80) {
+            for (size_t i = 0; i < sizeof kSIScalarOperatorSpellings / sizeof *kSIScalarOperatorSpellings; i++) {
+                const SIScalarOperatorSpelling *s = &kSIScalarOperatorSpellings[i];
+                if ((size_t)(end - p) >= s->length && memcmp(p, s->spelling, s->length) == 0) {
+                    spelling = s;
+                    break;
+                }
             }
         }
+        if (spelling) {
+            SIScalarNormalizerEmit(&n, spelling->replacement, strlen(spelling->replacement));
+            p += spelling->length;
+        } else {
+            const char *start = p;
+            utf8_next(&p);
+            if (p > end) p = end;
+            SIScalarNormalizerEmit(&n, start, (size_t)(p - start));
+        }
     }
-    // 3) Count total insertions, allocate output buffer
-    size_t insertions = 0;
-    for (size_t i = 0; i < cp_count; i++) {
-        if (ins_before[i]) insertions++;
-        if (ins_after[i]) insertions++;
-    }
-    size_t new_bytes = orig_bytes + insertions * /* strlen("*") == */ 1;
-    char *out = malloc(new_bytes + 1);
-    if (NULL == out) {
-        fprintf(stderr, "insertAsterisks: Memory allocation failed for output buffer.\n");
-        free(cps);
-        free(levels);
-        free(ins_before);
-        free(ins_after);
-        free(byte_off);
-        return NULL;
+    *n.cursor = '\0';
+    return out;
+}
+// Applies the "expression .. finalUnit" conversion and drops a zero imaginary
+// part.  Consumes out and returns the caller-owned result.
+static SIScalarRef SIScalarFinishExpressionValue(SIScalarRef out, SIUnitRef finalUnit, OCStringRef *error) {
+    /* unit conversion and real-part extraction logic */
+    if (finalUnit) {
+        if (!SIScalarConvertToUnit((SIMutableScalarRef)out, finalUnit, error)) {
+            OCRelease(out);
+            return NULL;
+        }
+    }
+    // If the result is real-only, extract its real component
+    if (SIScalarIsReal(out)) {
+        SIScalarRef realResult = SIScalarCreateByTakingComplexPart(out, kSIRealPart);
+        OCRelease(out);
+        return realResult;
+    }
+    return out;
+}
+#pragma mark Literal Fast Path
+// The non-ASCII characters of the UNITCONSTANT and UNITPOWER classes in
+// SIScalarScanner.l, which together with REALNUMBER define the literals the
+// fast path accepts; keep this table and the scanner in step.  inPower marks
+// characters that are also in UNITPOWER's class and so may be followed by a
+// "^n" exponent in the same token; the others occur only in UNITCONSTANT.
+static const struct {
+    const char *spelling;
+    uint8_t length;
+    bool inPower;
+} kSIScalarUnitCharacters[] = {
+    {"Ω", 2, true},
+    {"Å", 2, true},
+    {"ℏ", 3, true},
+    {"°", 2, true},
+    {"π", 2, true},
+    {"σ", 2, true},
+    {"Φ", 2, true},
+    {"µ", 2, true},
+    {"ε", 2, true},
+    {"Λ", 2, false},
+    {"ƛ", 2, false},
+    {"α", 2, false},
+    {"λ", 2, false},
+    {"∞", 3, false},
+};
+// Returns the byte length of the unit-token character at p, or 0.
+static size_t SIScalarUnitCharacterLength(const char *p, bool *inPower) {
+    char c = *p;
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z' && c != 'I') || c == '%' || c == '_') {
+        *inPower = true;
+        return 1;
     }
-    char *d = out;
-    // 4) Build the new UTF-8 in one pass
-    for (size_t i = 0; i < cp_count; i++) {
-        if (ins_before[i]) {
-            *d++ = '*';
+    for (size_t i = 0; i < sizeof kSIScalarUnitCharacters / sizeof *kSIScalarUnitCharacters; i++) {
+        if (strncmp(p, kSIScalarUnitCharacters[i].spelling, kSIScalarUnitCharacters[i].length) == 0) {
+            *inPower = kSIScalarUnitCharacters[i].inPower;
+            return kSIScalarUnitCharacters[i].length;
         }
-        size_t chunk_len = byte_off[i + 1] - byte_off[i];
-        memcpy(d, src + byte_off[i], chunk_len);
-        d += chunk_len;
-        if (ins_after[i]) {
-            *d++ = '*';
+    }
+    return 0;
+}
+// Recognizes a normalized "<real><unit>" literal, such as "12.5km" or
+// "3e-6mol", that the scanner reads as one REALNUMBER followed by one UNIT
+// token, and builds the same scalar the scanner and grammar would.  Returns
+// NULL, without an error, whenever the text needs the full parser.
+static SIScalarRef SIScalarCreateFromLiteral(const char *text) {
+    const char *p = text;
+    while (isdigit((unsigned char)*p)) p++;
+    if (p > text) {
+        if (*p == '.')
+            for (p++; isdigit((unsigned char)*p);) p++;
+    } else {
+        if (*p++ != '.' || !isdigit((unsigned char)*p)) return NULL;
+        while (isdigit((unsigned char)*p)) p++;
+    }
+    if (*p == 'e' || *p == 'E') {
+        // An "e" not followed by an exponent starts the unit instead
+        const char *exponent = p + 1;
+        if (*exponent == '+' || *exponent == '-') exponent++;
+        if (isdigit((unsigned char)*exponent)) {
+            for (p = exponent; isdigit((unsigned char)*p);) p++;
         }
     }
-    *d = '\0';
-    // 5) Wrap into an OCMutableStringRef
-    OCMutableStringRef result = OCMutableStringCreateWithCString(out);
-    // 6) Cleanup
-    free(cps);
-    free(levels);
-    free(ins_before);
-    free(ins_after);
-    free(byte_off);
-    free(out);
-    return result;
+    const char *numberEnd = p;
+    // The rest must be a single unit token: symbol characters, then either an
+    // optional trailing "0" or a "^n" exponent
+    bool powerAllowed = true;
+    bool inPower = false;
+    size_t length;
+    while ((length = SIScalarUnitCharacterLength(p, &inPower))) {
+        powerAllowed &= inPower;
+        p += length;
+    }
+    if (p == numberEnd) return NULL;
+    if (*p == '0') {
+        p++;
+    } else if (*p == '^' && powerAllowed) {
+        p++;
+        if (*p == '+' || *p == '-') p++;
+        if (!isdigit((unsigned char)*p)) return NULL;
+        while (isdigit((unsigned char)*p)) p++;
+    }
+    if (*p) return NULL;
+    char *end = NULL;
+    double value = strtod(text, &end);
+    if (end != numberEnd) return NULL;
+    OCStringRef symbol = OCStringCreateWithCString(numberEnd);
+    double unit_multiplier = 1;
+    OCStringRef unitError = NULL;
+    SIUnitRef unit = SIUnitFromExpression(symbol, &unit_multiplier, &unitError);
+    OCRelease(symbol);
+    if (!unit) {
+        // Let the grammar produce its usual diagnosis
+        if (unitError) OCRelease(unitError);
+        return NULL;
+    }
+    double complex number = value;
+    return SIScalarCreateWithDoubleComplex(number * unit_multiplier, unit);
 }
 SIScalarRef SIScalarCreateFromExpression(OCStringRef string, OCStringRef *error) {
     if (error)
         if (*error) return NULL;
     if (OCStringCompare(string, kSIQuantityDimensionless, kOCCompareCaseInsensitive) == kOCCompareEqualTo) return NULL;
-    OCMutableStringRef mutString = OCStringCreateMutableCopy(string);
-    /* perform all Unicode-aware replacements */
-    OCStringFindAndReplace(mutString, STR("*"), STR("•"),
-                           OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    result = NULL;
-    scalarErrorString = NULL;
-    // check for and get the final conversion unit if user added  "expression .. finalUnit"
-    // extract finalUnit, and delete .. finalUnit.
-    double unit_multiplier = 1.0;
-    SIUnitRef finalUnit = ConversionWithDefinedUnit(mutString, &unit_multiplier, error);
-    OCStringFindAndReplace(mutString, STR("•"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("×"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("÷"), STR("/"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("−"), STR("-"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("\n"), STR(""), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("+"), STR("+"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("μ"), STR("µ"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("γ"), STR("𝛾"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("º"), STR("°"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("h_p"), STR("h_P"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("ɣ"), STR("𝛾"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("√"), STR("sqrt"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("∛"), STR("cbrt"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("∜"), STR("qtrt"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR(" "), STR(""), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    // Quick fix for quartertsp
-    OCStringFindAndReplace(mutString, STR("qtertsp"), STR("quartertsp"), OCRangeMake(0, OCStringGetLength(mutString)), kOCCompareCaseInsensitive);
-    OCMutableStringRef newMutString = insertAsterisks(mutString);
-    OCRelease(mutString);
-    mutString = newMutString;
+    SIUnitRef finalUnit = NULL;
+    char normalized[256];
+    char *cString = SIScalarNormalizeExpression(OCStringGetCString(string), normalized, sizeof normalized, &finalUnit, error);
+    // Most stored values are a bare number and unit, which need no grammar
+    if (cString && !(error && *error)) {
+        SIScalarRef literal = SIScalarCreateFromLiteral(cString);
+        if (literal) {
+            if (cString != normalized) free(cString);
+            return SIScalarFinishExpressionValue(literal, finalUnit, error);
+        }
+    }
     // Ready to Parse
-    const char *cString = OCStringGetCString(mutString);
     SIScalarRef out = NULL;
+    // Per-call parse state; see SIUnitParseContext
+    SIScalarParseContext ctx = {0};
+    // The tree is transient: every node comes from a stack arena dropped in one step
+    SIArena arena;
+    SIArenaInit(&arena);
+    ctx.arena = &arena;
     if (cString) {
         // Create a local autorelease pool
         OCAutoreleasePoolRef pool = OCAutoreleasePoolCreate();
-        sis_syntax_error = false;
-        scalarErrorString = NULL;  // Reset error string from previous parse attempts
-        scalarError = NULL;        // Reset bison parser error from previous parse attempts
-        result = NULL;             // Reset result from previous parse attempts
-        sis_scan_string(cString);
-        sisparse();
-        sislex_destroy();
-        if (!sis_syntax_error && result) {
-            out = SIScalarCreateCopy(result);
+        void *scanner = NULL;
+        if (sislex_init_extra(&ctx, &scanner) == 0) {
+            YY_BUFFER_STATE buffer = sis_scan_string(cString, scanner);
+            sisparse(&ctx, scanner);
+            sis_delete_buffer(buffer, scanner);
+            sislex_destroy(scanner);
+        }
+        if (!ctx.syntax_error && ctx.result) {
+            out = SIScalarCreateCopy(ctx.result);
         }
         // Clean up any error strings set during parsing
-        if (scalarError) {
-            OCRelease(scalarError);
-            scalarError = NULL;
+        if (ctx.error) {
+            OCRelease(ctx.error);
+            ctx.error = NULL;
         }
         OCAutoreleasePoolRelease(pool);
-        /* whether parse succeeded or not, free the tree once here */
-        if (sis_root) {
-            ScalarNodeFree(sis_root);
-            sis_root = NULL;
-        }
-        OCRelease(mutString);
+        if (cString != normalized) free(cString);
     }
+    /* whether the parse succeeded or not, the whole tree goes here */
+    SIArenaDestroy(&arena);
     if (error) {
-        if (scalarErrorString) *error = scalarErrorString;
+        if (ctx.syntax_message) *error = ctx.syntax_message;
         if (*error) {
             if (out) OCRelease(out);
             return NULL;
         }
     }
-    if (out) {
-        /* unit conversion and real-part extraction logic */
-        if (finalUnit) {
-            if (!SIScalarConvertToUnit((SIMutableScalarRef)out, finalUnit, error)) {
-                OCRelease(out);
-                return NULL;
-            }
+    if (!out) {
+        if (error) *error = STR("Syntax Error");
+        return NULL;
+    }
+    return SIScalarFinishExpressionValue(out, finalUnit, error);
+}
+void siserror(SIScalarParseContext *ctx, void *scanner, const char *s) {
+    (void)scanner;  // Unused parameters - required by parser generator convention
+    (void)s;
+    ctx->syntax_message = STR("Syntax Error");
+    ctx->syntax_error = true;
+}
+#pragma mark Compiled Expressions
+// A parsed, constant-folded expression tree with $name input slots.  The tree
+// and its leaf values are owned by the object and never modified after
+// compilation, so evaluations never see each other's intermediate values.
+struct impl_SIScalarExpression {
+    OCBase base;
+    OCStringRef expression;
+    ScalarNodeRef root;
+    SIArena *arena;  // owns the nodes of root
+    OCArrayRef variables;
+    SIUnitRef finalUnit;
+};
+static OCTypeID kSIScalarExpressionID = kOCNotATypeID;
+OCTypeID SIScalarExpressionGetTypeID(void) {
+    if (kSIScalarExpressionID == kOCNotATypeID)
+        kSIScalarExpressionID = OCRegisterType("SIScalarExpression", (OCTypeRef (*)(cJSON *, OCStringRef *))SIScalarExpressionCreateFromJSON);
+    return kSIScalarExpressionID;
+}
+static bool impl_SIScalarExpressionEqual(const void *theType1, const void *theType2) {
+    if (theType1 == theType2) return true;
+    if (!theType1 || !theType2) return false;
+    SIScalarExpressionRef e1 = (SIScalarExpressionRef)theType1;
+    SIScalarExpressionRef e2 = (SIScalarExpressionRef)theType2;
+    if (e1->base.typeID != e2->base.typeID) return false;
+    return OCStringEqual(e1->expression, e2->expression);
+}
+static void impl_SIScalarExpressionFinalize(const void *theType) {
+    if (!theType) return;
+    struct impl_SIScalarExpression *expr = (struct impl_SIScalarExpression *)(uintptr_t)theType;
+    if (expr->root) {
+        ScalarNodeReleaseValues(expr->root);
+        expr->root = NULL;
+    }
+    SIArenaRelease(expr->arena);
+    expr->arena = NULL;
+    if (expr->variables) OCRelease(expr->variables);
+    expr->variables = NULL;
+    if (expr->expression) OCRelease(expr->expression);
+    expr->expression = NULL;
+}
+static OCStringRef impl_SIScalarExpressionCopyFormattingDescription(OCTypeRef theType) {
+    if (!theType) return OCStringCreateWithCString("(null)");
+    return OCStringCreateCopy(((SIScalarExpressionRef)theType)->expression);
+}
+static cJSON *impl_SIScalarExpressionCopyJSON(const void *obj, bool typed, OCStringRef *outError) {
+    return SIScalarExpressionCopyAsJSON((SIScalarExpressionRef)obj, typed, outError);
+}
+static void *impl_SIScalarExpressionDeepCopy(const void *theType) {
+    // Compiled expressions are immutable; sharing the original is a valid copy
+    return theType ? (void *)OCRetain(theType) : NULL;
+}
+SIScalarExpressionRef SIScalarExpressionCreate(OCStringRef expression, OCStringRef *error) {
+    if (error)
+        if (*error) return NULL;
+    if (!expression) {
+        if (error) *error = STR("Expression is NULL");
+        return NULL;
+    }
+    SIUnitRef finalUnit = NULL;
+    char normalized[256];
+    char *cString = SIScalarNormalizeExpression(OCStringGetCString(expression), normalized, sizeof normalized, &finalUnit, error);
+    if (!cString) {
+        if (error && !*error) *error = STR("Syntax Error");
+        return NULL;
+    }
+    SIScalarParseContext ctx = {0};
+    ctx.variables = OCArrayCreateMutable(0, &kOCTypeArrayCallBacks);
+    // The tree outlives the parse, so its arena is moved into the compiled expression
+    ctx.arena = SIArenaCreate();
+    OCAutoreleasePoolRef pool = OCAutoreleasePoolCreate();
+    void *scanner = NULL;
+    if (sislex_init_extra(&ctx, &scanner) == 0) {
+        YY_BUFFER_STATE buffer = sis_scan_string(cString, scanner);
+        sisparse(&ctx, scanner);
+        sis_delete_buffer(buffer, scanner);
+        sislex_destroy(scanner);
+    }
+    if (cString != normalized) free(cString);
+    OCStringRef compileError = NULL;
+    if (ctx.syntax_error || ctx.error || !ctx.root) {
+        compileError = ctx.error ? ctx.error : STR("Syntax Error");
+    } else {
+        // Units were resolved by the scanner; fold everything that does not
+        // depend on a variable so evaluation only redoes the variable paths
+        ctx.root = ScalarNodeFold(ctx.root, ctx.arena, &compileError);
+        if (!compileError) ScalarNodeRetainValues(ctx.root);
+    }
+    OCAutoreleasePoolRelease(pool);
+    if (compileError) {
+        SIArenaRelease(ctx.arena);
+        OCRelease(ctx.variables);
+        if (error)
+            *error = compileError;
+        else
+            OCRelease(compileError);
+        return NULL;
+    }
+    struct impl_SIScalarExpression *expr = OCTypeAlloc(struct impl_SIScalarExpression,
+                                                       SIScalarExpressionGetTypeID(),
+                                                       impl_SIScalarExpressionFinalize,
+                                                       impl_SIScalarExpressionEqual,
+                                                       impl_SIScalarExpressionCopyFormattingDescription,
+                                                       impl_SIScalarExpressionCopyJSON,
+                                                       impl_SIScalarExpressionDeepCopy,
+                                                       impl_SIScalarExpressionDeepCopy);
+    if (!expr) {
+        ScalarNodeReleaseValues(ctx.root);
+        SIArenaRelease(ctx.arena);
+        OCRelease(ctx.variables);
+        return NULL;
+    }
+    expr->expression = OCStringCreateCopy(expression);
+    expr->root = ctx.root;
+    expr->arena = ctx.arena;
+    expr->variables = ctx.variables;
+    expr->finalUnit = finalUnit;
+    return expr;
+}
+OCStringRef SIScalarExpressionGetExpression(SIScalarExpressionRef expr) {
+    IF_NO_OBJECT_EXISTS_RETURN(expr, NULL);
+    return expr->expression;
+}
+OCIndex SIScalarExpressionGetVariableCount(SIScalarExpressionRef expr) {
+    IF_NO_OBJECT_EXISTS_RETURN(expr, 0);
+    return OCArrayGetCount(expr->variables);
+}
+OCStringRef SIScalarExpressionGetVariableNameAtIndex(SIScalarExpressionRef expr, OCIndex index) {
+    IF_NO_OBJECT_EXISTS_RETURN(expr, NULL);
+    if (index < 0 || index >= OCArrayGetCount(expr->variables)) return NULL;
+    return OCArrayGetValueAtIndex(expr->variables, index);
+}
+OCIndex SIScalarExpressionGetIndexOfVariable(SIScalarExpressionRef expr, OCStringRef name) {
+    IF_NO_OBJECT_EXISTS_RETURN(expr, kOCNotFound);
+    for (OCIndex i = 0; i < OCArrayGetCount(expr->variables); i++) {
+        if (OCStringEqual(OCArrayGetValueAtIndex(expr->variables, i), name)) return i;
+    }
+    return kOCNotFound;
+}
+SIScalarRef SIScalarExpressionCreateValue(SIScalarExpressionRef expr, const SIScalarRef *values, OCIndex count, OCStringRef *error) {
+    if (error)
+        if (*error) return NULL;
+    IF_NO_OBJECT_EXISTS_RETURN(expr, NULL);
+    if (count != OCArrayGetCount(expr->variables)) {
+        if (error) *error = STR("Wrong number of values for the expression's variables.");
+        return NULL;
+    }
+    for (OCIndex i = 0; i < count; i++) {
+        if (!values[i]) {
+            if (error) *error = STR("Unbound variable.");
+            return NULL;
         }
-        // If the result is real-only, extract its real component
-        if (SIScalarIsReal(out)) {
-            SIScalarRef realResult = SIScalarCreateByTakingComplexPart(out, kSIRealPart);
-            OCRelease(out);
-            return realResult;
+    }
+    OCStringRef evalError = NULL;
+    SIScalarRef out = NULL;
+    OCAutoreleasePoolRef pool = OCAutoreleasePoolCreate();
+    SIScalarRef result = ScalarNodeEvaluateWithBindings(expr->root, values, &evalError);
+    if (result && !evalError) out = SIScalarCreateCopy(result);
+    OCAutoreleasePoolRelease(pool);
+    if (evalError || !out) {
+        if (out) OCRelease(out);
+        if (!evalError) evalError = STR("Syntax Error");
+        if (error)
+            *error = evalError;
+        else
+            OCRelease(evalError);
+        return NULL;
+    }
+    return SIScalarFinishExpressionValue(out, expr->finalUnit, error);
+}
+SIScalarRef SIScalarExpressionCreateValueWithBindings(SIScalarExpressionRef expr, OCDictionaryRef bindings, OCStringRef *error) {
+    if (error)
+        if (*error) return NULL;
+    IF_NO_OBJECT_EXISTS_RETURN(expr, NULL);
+    OCIndex count = OCArrayGetCount(expr->variables);
+    SIScalarRef stackValues[16];
+    SIScalarRef *values = count <= 16 ? stackValues : malloc(count * sizeof(SIScalarRef));
+    if (!values) return NULL;
+    for (OCIndex i = 0; i < count; i++) {
+        values[i] = bindings ? OCDictionaryGetValue(bindings, OCArrayGetValueAtIndex(expr->variables, i)) : NULL;
+    }
+    SIScalarRef out = SIScalarExpressionCreateValue(expr, values, count, error);
+    if (values != stackValues) free(values);
+    return out;
+}
+cJSON *SIScalarExpressionCopyAsJSON(SIScalarExpressionRef expr, bool typed, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!expr) {
+        if (outError) *outError = STR("SIScalarExpression input is NULL");
+        return cJSON_CreateNull();
+    }
+    const char *s = OCStringGetCString(expr->expression);
+    cJSON *value = cJSON_CreateString(s ? s : "");
+    if (!typed) return value;
+    cJSON *entry = cJSON_CreateObject();
+    if (!entry) {
+        cJSON_Delete(value);
+        if (outError) *outError = STR("Failed to create JSON object");
+        return cJSON_CreateNull();
+    }
+    cJSON_AddStringToObject(entry, "type", "SIScalarExpression");
+    cJSON_AddItemToObject(entry, "value", value);
+    return entry;
+}
+SIScalarExpressionRef SIScalarExpressionCreateFromJSON(cJSON *json, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (cJSON_IsObject(json)) json = cJSON_GetObjectItem(json, "value");
+    if (!cJSON_IsString(json)) {
+        if (outError) *outError = STR("SIScalarExpression JSON must be an expression string");
+        return NULL;
+    }
+    OCStringRef expression = OCStringCreateWithCString(cJSON_GetStringValue(json));
+    SIScalarExpressionRef expr = SIScalarExpressionCreate(expression, outError);
+    OCRelease(expression);
+    return expr;
+}
+// Evaluates one row at a time through SIScalarExpressionCreateValue, for trees
+// that use an operation without a columnar form or whose columnar pass failed.
+// Rows are expressed in the unit of the first row.
+static bool SIScalarExpressionEvaluateRows(SIScalarExpressionRef expr, const SIQuantityArrayRef *columns, OCIndex count, OCIndex rows, ScalarColumn *result, OCStringRef *error) {
+    result->unit = expr->finalUnit;
+    result->isComplex = false;
+    result->constant = 0;
+    result->values = malloc((size_t)(rows > 0 ? rows : 1) * sizeof(double complex));
+    if (!result->values) {
+        *error = STR("Memory allocation failed.");
+        return false;
+    }
+    SIScalarRef stackValues[16];
+    SIScalarRef *values = count <= 16 ? stackValues : calloc(count, sizeof(SIScalarRef));
+    if (!values) {
+        ScalarColumnFree(result);
+        *error = STR("Memory allocation failed.");
+        return false;
+    }
+    bool ok = true;
+    for (OCIndex row = 0; row < rows && ok; row++) {
+        for (OCIndex i = 0; i < count; i++) values[i] = SIQuantityArrayCreateScalarAtIndex(columns[i], row);
+        SIScalarRef value = SIScalarExpressionCreateValue(expr, values, count, error);
+        for (OCIndex i = 0; i < count; i++) OCRelease(values[i]);
+        if (!value) {
+            ok = false;
+            break;
         }
+        SIUnitRef unit = SIQuantityGetUnit((SIQuantityRef)value);
+        if (row == 0) result->unit = unit;
+        if (!SIDimensionalityHasSameReducedDimensionality(SIUnitGetDimensionality(unit), SIUnitGetDimensionality(result->unit))) {
+            *error = STR("Rows evaluate to incompatible dimensionalities.");
+            ok = false;
+        } else {
+            result->values[row] = SIScalarDoubleComplexValue(value) * SIUnitConversion(unit, result->unit);
+            if (SIQuantityIsComplexType((SIQuantityRef)value)) result->isComplex = true;
+        }
+        OCRelease(value);
+    }
+    if (values != stackValues) free(values);
+    if (!ok) ScalarColumnFree(result);
+    return ok;
+}
+SIQuantityArrayRef SIScalarExpressionCreateQuantityArray(SIScalarExpressionRef expr, const SIQuantityArrayRef *columns, OCIndex count, OCStringRef *error) {
+    if (error)
+        if (*error) return NULL;
+    IF_NO_OBJECT_EXISTS_RETURN(expr, NULL);
+    OCStringRef localError = NULL;
+    if (!error) error = &localError;
+    if (count != OCArrayGetCount(expr->variables)) {
+        *error = STR("Wrong number of columns for the expression's variables.");
+        return NULL;
+    }
+    OCIndex rows = count > 0 && columns[0] ? SIQuantityArrayGetCount(columns[0]) : 1;
+    for (OCIndex i = 0; i < count; i++) {
+        if (!columns[i] || SIQuantityArrayGetCount(columns[i]) != rows) {
+            *error = STR("Columns must all have the same number of rows.");
+            return NULL;
+        }
+    }
+    ScalarColumn column;
+    OCAutoreleasePoolRef pool = OCAutoreleasePoolCreate();
+    bool ok = ScalarNodeEvaluateColumns(expr->root, columns, rows, &column, error);
+    if (ok && expr->finalUnit) {
+        if (!SIDimensionalityHasSameReducedDimensionality(SIUnitGetDimensionality(column.unit), SIUnitGetDimensionality(expr->finalUnit))) {
+            *error = STR("Incompatible dimensionalities.");
+            ScalarColumnFree(&column);
+            ok = false;
+        } else {
+            double factor = SIUnitConversion(column.unit, expr->finalUnit);
+            double complex *v = column.values ? column.values : &column.constant;
+            OCIndex n = column.values ? rows : 1;
+            for (OCIndex i = 0; i < n; i++) v[i] *= factor;
+            column.unit = expr->finalUnit;
+        }
+    }
+    OCAutoreleasePoolRelease(pool);
+    // Any columnar failure is retried row by row, so the batch reports exactly
+    // what SIScalarExpressionCreateValue would
+    if (!ok) {
+        if (*error) OCRelease(*error);
+        *error = NULL;
+        ok = SIScalarExpressionEvaluateRows(expr, columns, count, rows, &column, error);
+    }
+    if (!ok) {
+        if (localError) OCRelease(localError);
+        return NULL;
+    }
+    if (!column.values) {
+        // No variables reached the result: every row holds the same value
+        column.values = malloc((size_t)(rows > 0 ? rows : 1) * sizeof(double complex));
+        if (!column.values) {
+            *error = STR("Memory allocation failed.");
+            return NULL;
+        }
+        for (OCIndex i = 0; i < rows; i++) column.values[i] = column.constant;
+    }
+    // As with SIScalarCreateFromExpression, a result without imaginary parts is real
+    bool isReal = true;
+    for (OCIndex i = 0; i < rows && isReal; i++) isReal = cimag(column.values[i]) == 0;
+    SIQuantityArrayRef out = NULL;
+    if (isReal) {
+        // Compact in place: reals[i] never overlaps a complex value not yet read
+        double *reals = (double *)column.values;
+        for (OCIndex i = 0; i < rows; i++) reals[i] = creal(column.values[i]);
+        out = SIQuantityArrayCreate(column.unit, kSINumberFloat64Type, reals, rows, error);
+        ScalarColumnFree(&column);
     } else {
-        if (error) *error = STR("Syntax Error");
+        out = SIQuantityArrayCreateWithBytesNoCopy(column.unit, kSINumberComplex128Type, column.values, rows, true, error);
+        if (!out) ScalarColumnFree(&column);
     }
+    if (localError) OCRelease(localError);
     return out;
 }
-void siserror(char *s, ...) {
-    (void)s;  // Unused parameter - required by parser generator convention
-    scalarErrorString = STR("Syntax Error");
-    sis_syntax_error = true;
-}
@@ -16,7 +16,10 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>          // Needed for memset, strcmp, etc.
-#define SILIB_TYPES_COUNT 3  // Total number of types in SITypes
+// Registered OCTypes: SIDimensionality, SIUnit, SIScalar, SIQuantityArray,
+// SIUnitConversionPlan and SIScalarExpression.  SIQuantity is an abstract base
+// and SIScalarValue a plain struct, so neither is counted.
+#define SILIB_TYPES_COUNT 6  // Total number of types in SITypes
 /** @cond INTERNAL */
 // Centralized Ref typedefs
 typedef const struct impl_SIDimensionality *SIDimensionalityRef;
@@ -25,6 +28,11 @@ typedef const struct impl_SIUnit *SIUnitRef;
 typedef const struct impl_SIQuantity *SIQuantityRef;
 typedef const struct impl_SIScalar *SIScalarRef;
 typedef struct impl_SIScalar *SIMutableScalarRef;
+typedef const struct impl_SIScalarExpression *SIScalarExpressionRef;
+typedef const struct impl_SIUnitConversionPlan *SIUnitConversionPlanRef;
+typedef const struct impl_SIQuantityArray *SIQuantityArrayRef;
+typedef struct impl_SIQuantityArray *SIMutableQuantityArrayRef;
+typedef struct SIScalarValue SIScalarValue;  // defined in SIScalar.h
 /** @endcond */
 // Include OCTypes base framework
 #include <OCTypes.h>
@@ -33,6 +41,7 @@ typedef struct impl_SIScalar *SIMutableScalarRef;
 #include "SIDimensionalityParser.h"
 #include "SIQuantity.h"
 #include "SIScalar.h"
+#include "SIQuantityArray.h"
 #include "SIScalarConstants.h"
 #include "SIUnit.h"
 #include "SIUnitParser.h"
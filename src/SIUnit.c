@@ -6,6 +6,7 @@
 //  Copyright © 2017 PhySy Ltd. All rights reserved.
 //
 #include <locale.h>
+#include <stdio.h>
 #include <math.h>  // For floor, isnan, erf, erfc, log, sqrt, pow, fabs, log10
 #include <stdbool.h>
 #include <stddef.h>
@@ -120,6 +121,7 @@ struct impl_SIUnit {
     // SIUnit Type attributes
     SIDimensionalityRef dimensionality;  // required: dimensionality of the unit
     double scale_to_coherent_si;         // required: Scale factor to convert from this unit to its coherent SI unit
+    double offset_to_coherent_si;        // optional: Zero offset, in this unit, of an absolute (affine) scale such as °C
     OCStringRef symbol;                  // required: Symbol of the unit, e.g., "m", "kg", "s", etc.
     OCStringRef name;                    // optional: name of the unit, e.g., "meter", "gram", "second", etc.
     OCStringRef plural_name;             // optional: Plural name of the unit, e.g., "meters", "grams", "seconds", etc.
@@ -234,6 +236,7 @@ static SIUnitRef SIUnitCreate(SIDimensionalityRef dimensionality,
     if (!theUnit) return NULL;
     theUnit->dimensionality = OCRetain(dimensionality);
     theUnit->scale_to_coherent_si = scale_to_coherent_si;
+    theUnit->offset_to_coherent_si = 0.0;
     if (name)
         theUnit->name = OCStringCreateCopy(name);
     else
@@ -337,6 +340,347 @@ double SIUnitConversion(SIUnitRef initialUnit, SIUnitRef finalUnit) {
         return initialUnit->scale_to_coherent_si / finalUnit->scale_to_coherent_si;
     return 0;
 }
+double SIUnitGetOffsetToCoherentSI(SIUnitRef theUnit) {
+    IF_NO_OBJECT_EXISTS_RETURN(theUnit, 0);
+    return theUnit->offset_to_coherent_si;
+}
+bool SIUnitIsAffine(SIUnitRef theUnit) {
+    IF_NO_OBJECT_EXISTS_RETURN(theUnit, false);
+    return theUnit->offset_to_coherent_si != 0.0;
+}
+bool SIUnitAffineConversion(SIUnitRef initialUnit, SIUnitRef finalUnit, double *scale, double *offset) {
+    IF_NO_OBJECT_EXISTS_RETURN(initialUnit, false);
+    IF_NO_OBJECT_EXISTS_RETURN(finalUnit, false);
+    if (!SIDimensionalityHasSameReducedDimensionality(initialUnit->dimensionality, finalUnit->dimensionality)) return false;
+    // final = (initial + o1) * s1 / s2 - o2
+    double factor = initialUnit->scale_to_coherent_si / finalUnit->scale_to_coherent_si;
+    if (scale) *scale = factor;
+    if (offset) *offset = initialUnit->offset_to_coherent_si * factor - finalUnit->offset_to_coherent_si;
+    return true;
+}
+#pragma mark Bulk Conversion
+// Kernels scale reals in double precision, as SIScalarConvertToUnit does, so a
+// bulk conversion is bit-identical to converting each element separately.
+// Complex buffers are scaled as 2 * count interleaved reals.  The loops are
+// kept free of calls and aliasing so -O3 vectorizes them for the target ISA.
+static void SIUnitScaleFloats(const float *restrict input, float *restrict output, size_t count, double factor) {
+    for (size_t i = 0; i < count; i++) output[i] = (float)(input[i] * factor);
+}
+static void SIUnitScaleFloatsInPlace(float *data, size_t count, double factor) {
+    for (size_t i = 0; i < count; i++) data[i] = (float)(data[i] * factor);
+}
+static void SIUnitScaleDoubles(const double *restrict input, double *restrict output, size_t count, double factor) {
+    for (size_t i = 0; i < count; i++) output[i] = input[i] * factor;
+}
+static void SIUnitScaleDoublesInPlace(double *data, size_t count, double factor) {
+    for (size_t i = 0; i < count; i++) data[i] = data[i] * factor;
+}
+static bool SIUnitConvertBufferFactor(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type, double *factor, OCStringRef *outError) {
+    if (outError && *outError) return false;
+    if (!fromUnit || !toUnit) {
+        if (outError) *outError = STR("Invalid unit for buffer conversion.");
+        return false;
+    }
+    if (type != kSINumberFloat32Type && type != kSINumberFloat64Type &&
+        type != kSINumberComplex64Type && type != kSINumberComplex128Type) {
+        if (outError) *outError = STR("Invalid numeric type for buffer conversion.");
+        return false;
+    }
+    if (!SIDimensionalityHasSameReducedDimensionality(fromUnit->dimensionality, toUnit->dimensionality)) {
+        if (outError) *outError = STR("Incompatible Dimensionalities.");
+        return false;
+    }
+    *factor = fromUnit->scale_to_coherent_si / toUnit->scale_to_coherent_si;
+    return true;
+}
+static bool SIUnitScaleBuffer(SINumberType type, const void *input, void *output, size_t count, double factor, OCStringRef *outError) {
+    if (count == 0) return true;
+    if (!input || !output) {
+        if (outError) *outError = STR("Invalid buffer for conversion.");
+        return false;
+    }
+    bool inPlace = input == output;
+    if (inPlace && factor == 1.0) return true;
+    size_t reals = (type == kSINumberComplex64Type || type == kSINumberComplex128Type) ? 2 * count : count;
+    if (type == kSINumberFloat32Type || type == kSINumberComplex64Type) {
+        if (inPlace)
+            SIUnitScaleFloatsInPlace(output, reals, factor);
+        else
+            SIUnitScaleFloats(input, output, reals, factor);
+    } else {
+        if (inPlace)
+            SIUnitScaleDoublesInPlace(output, reals, factor);
+        else
+            SIUnitScaleDoubles(input, output, reals, factor);
+    }
+    return true;
+}
+bool SIUnitConvertBuffer(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type, const void *input, void *output, size_t count, OCStringRef *outError) {
+    double factor = 1.0;
+    if (!SIUnitConvertBufferFactor(fromUnit, toUnit, type, &factor, outError)) return false;
+    return SIUnitScaleBuffer(type, input, output, count, factor, outError);
+}
+bool SIUnitConvertBufferStrided(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type,
+                                const void *input, size_t inputStride,
+                                void *output, size_t outputStride,
+                                size_t count, OCStringRef *outError) {
+    if (inputStride == 1 && outputStride == 1) return SIUnitConvertBuffer(fromUnit, toUnit, type, input, output, count, outError);
+    double factor = 1.0;
+    if (!SIUnitConvertBufferFactor(fromUnit, toUnit, type, &factor, outError)) return false;
+    if (count == 0) return true;
+    if (!input || !output || inputStride == 0 || outputStride == 0) {
+        if (outError) *outError = STR("Invalid buffer for conversion.");
+        return false;
+    }
+    // Strides are in elements; a complex element moves both of its parts
+    switch (type) {
+        case kSINumberFloat32Type: {
+            const float *in = input;
+            float *out = output;
+            for (size_t i = 0; i < count; i++) out[i * outputStride] = (float)(in[i * inputStride] * factor);
+            break;
+        }
+        case kSINumberFloat64Type: {
+            const double *in = input;
+            double *out = output;
+            for (size_t i = 0; i < count; i++) out[i * outputStride] = in[i * inputStride] * factor;
+            break;
+        }
+        case kSINumberComplex64Type: {
+            const float *in = input;
+            float *out = output;
+            for (size_t i = 0; i < count; i++) {
+                out[2 * i * outputStride] = (float)(in[2 * i * inputStride] * factor);
+                out[2 * i * outputStride + 1] = (float)(in[2 * i * inputStride + 1] * factor);
+            }
+            break;
+        }
+        case kSINumberComplex128Type: {
+            const double *in = input;
+            double *out = output;
+            for (size_t i = 0; i < count; i++) {
+                out[2 * i * outputStride] = in[2 * i * inputStride] * factor;
+                out[2 * i * outputStride + 1] = in[2 * i * inputStride + 1] * factor;
+            }
+            break;
+        }
+    }
+    return true;
+}
+static void SIUnitAffineFloats(const float *restrict input, float *restrict output, size_t count, double scale, double offset) {
+    for (size_t i = 0; i < count; i++) output[i] = (float)(input[i] * scale + offset);
+}
+static void SIUnitAffineFloatsInPlace(float *data, size_t count, double scale, double offset) {
+    for (size_t i = 0; i < count; i++) data[i] = (float)(data[i] * scale + offset);
+}
+static void SIUnitAffineDoubles(const double *restrict input, double *restrict output, size_t count, double scale, double offset) {
+    for (size_t i = 0; i < count; i++) output[i] = input[i] * scale + offset;
+}
+static void SIUnitAffineDoublesInPlace(double *data, size_t count, double scale, double offset) {
+    for (size_t i = 0; i < count; i++) data[i] = data[i] * scale + offset;
+}
+static bool SIUnitAffineBuffer(SINumberType type, const void *input, void *output, size_t count, double factor, double offset, OCStringRef *outError) {
+    if (offset == 0.0) return SIUnitScaleBuffer(type, input, output, count, factor, outError);
+    if (type == kSINumberComplex64Type || type == kSINumberComplex128Type) {
+        if (outError) *outError = STR("Absolute conversion between offset scales requires real values.");
+        return false;
+    }
+    if (count == 0) return true;
+    if (!input || !output) {
+        if (outError) *outError = STR("Invalid buffer for conversion.");
+        return false;
+    }
+    bool inPlace = input == output;
+    if (type == kSINumberFloat32Type) {
+        if (inPlace)
+            SIUnitAffineFloatsInPlace(output, count, factor, offset);
+        else
+            SIUnitAffineFloats(input, output, count, factor, offset);
+    } else {
+        if (inPlace)
+            SIUnitAffineDoublesInPlace(output, count, factor, offset);
+        else
+            SIUnitAffineDoubles(input, output, count, factor, offset);
+    }
+    return true;
+}
+bool SIUnitConvertAbsoluteBuffer(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type, const void *input, void *output, size_t count, OCStringRef *outError) {
+    double factor = 1.0;
+    if (!SIUnitConvertBufferFactor(fromUnit, toUnit, type, &factor, outError)) return false;
+    double offset = fromUnit->offset_to_coherent_si * factor - toUnit->offset_to_coherent_si;
+    return SIUnitAffineBuffer(type, input, output, count, factor, offset, outError);
+}
+#pragma mark Conversion Plans
+// An immutable, precomputed conversion between two units.  Dimensionality is
+// checked once at creation, so applying a plan is pure arithmetic that never
+// touches the unit library.
+struct impl_SIUnitConversionPlan {
+    OCBase base;
+    SIUnitRef fromUnit;
+    SIUnitRef toUnit;
+    double scale;
+    double offset;
+    bool absolute;
+};
+static OCTypeID kSIUnitConversionPlanID = kOCNotATypeID;
+OCTypeID SIUnitConversionPlanGetTypeID(void) {
+    if (kSIUnitConversionPlanID == kOCNotATypeID)
+        kSIUnitConversionPlanID = OCRegisterType("SIUnitConversionPlan", (OCTypeRef (*)(cJSON *, OCStringRef *))SIUnitConversionPlanCreateFromJSON);
+    return kSIUnitConversionPlanID;
+}
+static bool impl_SIUnitConversionPlanEqual(const void *theType1, const void *theType2) {
+    if (theType1 == theType2) return true;
+    if (!theType1 || !theType2) return false;
+    SIUnitConversionPlanRef p1 = (SIUnitConversionPlanRef)theType1;
+    SIUnitConversionPlanRef p2 = (SIUnitConversionPlanRef)theType2;
+    if (p1->base.typeID != p2->base.typeID) return false;
+    return p1->fromUnit == p2->fromUnit && p1->toUnit == p2->toUnit && p1->absolute == p2->absolute;
+}
+static void impl_SIUnitConversionPlanFinalize(const void *theType) {
+    // Units are library-owned static instances and are not retained by plans
+    (void)theType;
+}
+static OCStringRef impl_SIUnitConversionPlanCopyFormattingDescription(OCTypeRef theType) {
+    if (!theType) return OCStringCreateWithCString("(null)");
+    SIUnitConversionPlanRef plan = (SIUnitConversionPlanRef)theType;
+    return OCStringCreateWithFormat(STR("<SIUnitConversionPlan %@ to %@: x * %.17g + %.17g>"),
+                                    plan->fromUnit->symbol, plan->toUnit->symbol, plan->scale, plan->offset);
+}
+static cJSON *impl_SIUnitConversionPlanCopyJSON(const void *obj, bool typed, OCStringRef *outError) {
+    return SIUnitConversionPlanCopyAsJSON((SIUnitConversionPlanRef)obj, typed, outError);
+}
+static SIUnitConversionPlanRef SIUnitConversionPlanCreateWithUnits(SIUnitRef fromUnit, SIUnitRef toUnit, bool absolute, OCStringRef *error);
+static void *impl_SIUnitConversionPlanDeepCopy(const void *theType) {
+    if (!theType) return NULL;
+    SIUnitConversionPlanRef plan = (SIUnitConversionPlanRef)theType;
+    return (void *)SIUnitConversionPlanCreateWithUnits(plan->fromUnit, plan->toUnit, plan->absolute, NULL);
+}
+static void *impl_SIUnitConversionPlanDeepCopyMutable(const void *theType) {
+    // Plans are immutable; just return a standard deep copy
+    return impl_SIUnitConversionPlanDeepCopy(theType);
+}
+static SIUnitConversionPlanRef SIUnitConversionPlanCreateWithUnits(SIUnitRef fromUnit, SIUnitRef toUnit, bool absolute, OCStringRef *error) {
+    if (error && *error) return NULL;
+    if (!fromUnit || !toUnit) {
+        if (error) *error = STR("Invalid unit for conversion plan.");
+        return NULL;
+    }
+    double scale = 1.0;
+    double offset = 0.0;
+    if (!SIUnitAffineConversion(fromUnit, toUnit, &scale, &offset)) {
+        if (error) *error = STR("Incompatible Dimensionalities.");
+        return NULL;
+    }
+    struct impl_SIUnitConversionPlan *plan = OCTypeAlloc(struct impl_SIUnitConversionPlan,
+                                                         SIUnitConversionPlanGetTypeID(),
+                                                         impl_SIUnitConversionPlanFinalize,
+                                                         impl_SIUnitConversionPlanEqual,
+                                                         impl_SIUnitConversionPlanCopyFormattingDescription,
+                                                         impl_SIUnitConversionPlanCopyJSON,
+                                                         impl_SIUnitConversionPlanDeepCopy,
+                                                         impl_SIUnitConversionPlanDeepCopyMutable);
+    if (!plan) return NULL;
+    plan->fromUnit = fromUnit;
+    plan->toUnit = toUnit;
+    plan->scale = scale;
+    plan->offset = absolute ? offset : 0.0;
+    plan->absolute = absolute;
+    return plan;
+}
+SIUnitConversionPlanRef SIUnitConversionPlanCreate(SIUnitRef fromUnit, SIUnitRef toUnit, OCStringRef *error) {
+    return SIUnitConversionPlanCreateWithUnits(fromUnit, toUnit, false, error);
+}
+SIUnitConversionPlanRef SIUnitConversionPlanCreateAbsolute(SIUnitRef fromUnit, SIUnitRef toUnit, OCStringRef *error) {
+    return SIUnitConversionPlanCreateWithUnits(fromUnit, toUnit, true, error);
+}
+cJSON *SIUnitConversionPlanCopyAsJSON(SIUnitConversionPlanRef plan, bool typed, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!plan) {
+        if (outError) *outError = STR("SIUnitConversionPlan input is NULL");
+        return cJSON_CreateNull();
+    }
+    cJSON *value = cJSON_CreateObject();
+    if (!value) {
+        if (outError) *outError = STR("Failed to create JSON object");
+        return cJSON_CreateNull();
+    }
+    const char *from = OCStringGetCString(plan->fromUnit->symbol);
+    const char *to = OCStringGetCString(plan->toUnit->symbol);
+    cJSON_AddStringToObject(value, "from", from ? from : "");
+    cJSON_AddStringToObject(value, "to", to ? to : "");
+    cJSON_AddBoolToObject(value, "absolute", plan->absolute);
+    if (!typed) return value;
+    cJSON *entry = cJSON_CreateObject();
+    if (!entry) {
+        cJSON_Delete(value);
+        if (outError) *outError = STR("Failed to create JSON object");
+        return cJSON_CreateNull();
+    }
+    cJSON_AddStringToObject(entry, "type", "SIUnitConversionPlan");
+    cJSON_AddItemToObject(entry, "value", value);
+    return entry;
+}
+SIUnitConversionPlanRef SIUnitConversionPlanCreateFromJSON(cJSON *json, OCStringRef *outError) {
+    if (outError) *outError = NULL;
+    if (!cJSON_IsObject(json)) {
+        if (outError) *outError = STR("SIUnitConversionPlan JSON must be an object");
+        return NULL;
+    }
+    cJSON *type = cJSON_GetObjectItem(json, "type");
+    if (cJSON_IsString(type)) {
+        if (strcmp(cJSON_GetStringValue(type), "SIUnitConversionPlan") != 0) {
+            if (outError) *outError = STR("JSON type is not SIUnitConversionPlan");
+            return NULL;
+        }
+        json = cJSON_GetObjectItem(json, "value");
+    }
+    cJSON *from = cJSON_GetObjectItem(json, "from");
+    cJSON *to = cJSON_GetObjectItem(json, "to");
+    if (!cJSON_IsString(from) || !cJSON_IsString(to)) {
+        if (outError) *outError = STR("SIUnitConversionPlan JSON needs from and to unit symbols");
+        return NULL;
+    }
+    OCStringRef fromSymbol = OCStringCreateWithCString(cJSON_GetStringValue(from));
+    OCStringRef toSymbol = OCStringCreateWithCString(cJSON_GetStringValue(to));
+    SIUnitRef fromUnit = SIUnitWithSymbol(fromSymbol);
+    SIUnitRef toUnit = SIUnitWithSymbol(toSymbol);
+    OCRelease(fromSymbol);
+    OCRelease(toSymbol);
+    return SIUnitConversionPlanCreateWithUnits(fromUnit, toUnit, cJSON_IsTrue(cJSON_GetObjectItem(json, "absolute")), outError);
+}
+SIUnitRef SIUnitConversionPlanGetFromUnit(SIUnitConversionPlanRef plan) {
+    IF_NO_OBJECT_EXISTS_RETURN(plan, NULL);
+    return plan->fromUnit;
+}
+SIUnitRef SIUnitConversionPlanGetToUnit(SIUnitConversionPlanRef plan) {
+    IF_NO_OBJECT_EXISTS_RETURN(plan, NULL);
+    return plan->toUnit;
+}
+double SIUnitConversionPlanGetScale(SIUnitConversionPlanRef plan) {
+    IF_NO_OBJECT_EXISTS_RETURN(plan, 0);
+    return plan->scale;
+}
+double SIUnitConversionPlanGetOffset(SIUnitConversionPlanRef plan) {
+    IF_NO_OBJECT_EXISTS_RETURN(plan, 0);
+    return plan->offset;
+}
+bool SIUnitConversionPlanIsAbsolute(SIUnitConversionPlanRef plan) {
+    IF_NO_OBJECT_EXISTS_RETURN(plan, false);
+    return plan->absolute;
+}
+double SIUnitConversionPlanApplyToDouble(SIUnitConversionPlanRef plan, double value) {
+    return value * plan->scale + plan->offset;
+}
+bool SIUnitConversionPlanApplyToBuffer(SIUnitConversionPlanRef plan, SINumberType type, const void *input, void *output, size_t count, OCStringRef *outError) {
+    if (outError && *outError) return false;
+    IF_NO_OBJECT_EXISTS_RETURN(plan, false);
+    if (type != kSINumberFloat32Type && type != kSINumberFloat64Type &&
+        type != kSINumberComplex64Type && type != kSINumberComplex128Type) {
+        if (outError) *outError = STR("Invalid numeric type for buffer conversion.");
+        return false;
+    }
+    return SIUnitAffineBuffer(type, input, output, count, plan->scale, plan->offset, outError);
+}
 bool SIUnitAreEquivalentUnits(SIUnitRef theUnit1, SIUnitRef theUnit2) {
     IF_NO_OBJECT_EXISTS_RETURN(theUnit1, false);
     IF_NO_OBJECT_EXISTS_RETURN(theUnit2, false);
@@ -445,13 +789,58 @@ static OCMutableDictionaryRef unitsDictionaryLibrary = NULL;
 static OCMutableDictionaryRef unitsQuantitiesLibrary = NULL;
 static OCMutableDictionaryRef unitsDimensionalitiesLibrary = NULL;
 static OCMutableArrayRef tokenSymbolLibrary = NULL;
+static OCMutableDictionaryRef tokenSymbolIndex = NULL;  // symbol -> token ID, its index in tokenSymbolLibrary
+static OCMutableDictionaryRef unitsSymbolIndex = NULL;  // symbol -> array of registered units, for O(1) duplicate checks
+static OCMutableDictionaryRef unitsNameIndex = NULL;        // name and plural name -> unit, built on first name lookup
+static OCMutableDictionaryRef unitsFoldedNameIndex = NULL;  // lowercased name and plural name -> unit
 static bool imperialVolumes = false;
+// Incremented whenever units are added to or removed from the libraries;
+// caches keyed on expressions compare against it to detect stale entries.
+static uint64_t unitLibraryGeneration = 0;
+// Incremented whenever units leave the libraries; coherent-unit pointers cached
+// on interned dimensionalities are only trusted while it is unchanged.
+static uint64_t coherentUnitGeneration = 1;
+// Storage class for the memo caches; SITYPES_THREAD_LOCAL_CACHE gives each thread its own.
+// By default they are plain statics with no locking, like the rest of the library.
+#ifdef SITYPES_THREAD_LOCAL_CACHE
+#include <pthread.h>
+#define SI_CACHE_STORAGE static _Thread_local
+// Clear epochs are bumped by one thread and read by all, so they are atomic.
+// Relaxed ordering is enough: a reader needs only to see the bump eventually.
+#include <stdatomic.h>
+typedef _Atomic uint64_t SICacheEpoch;
+#define SICacheEpochLoad(epoch) atomic_load_explicit(&(epoch), memory_order_relaxed)
+#define SICacheEpochBump(epoch) atomic_fetch_add_explicit(&(epoch), 1, memory_order_relaxed)
+static pthread_key_t cacheThreadKey;
+static pthread_once_t cacheThreadKeyOnce = PTHREAD_ONCE_INIT;
+static void SIUnitCachesReleaseThread(void *unused);
+static void SIUnitCacheThreadKeyCreate(void) {
+    pthread_key_create(&cacheThreadKey, SIUnitCachesReleaseThread);
+}
+// Arranges for the calling thread's cache tables to be freed when it exits.
+static void SIUnitCacheRegisterThread(void) {
+    pthread_once(&cacheThreadKeyOnce, SIUnitCacheThreadKeyCreate);
+    if (!pthread_getspecific(cacheThreadKey)) pthread_setspecific(cacheThreadKey, &cacheThreadKey);
+}
+#else
+#define SI_CACHE_STORAGE static
+#define SIUnitCacheRegisterThread() ((void)0)
+typedef uint64_t SICacheEpoch;
+#define SICacheEpochLoad(epoch) (epoch)
+#define SICacheEpochBump(epoch) ((epoch)++)
+#endif
 // Function prototypes
 static bool SIUnitCreateLibraries(void);
+#ifdef SITYPES_STATIC_UNIT_REGISTRY
+static bool SIUnitCreateLibrariesFromRegistry(void);
+#endif
 static bool SIUnitAddUSPlainVolumeUnits(OCStringRef *error);
 static bool SIUnitAddUKPlainVolumeUnits(OCStringRef *error);
 static bool SIUnitAddUKLabeledVolumeUnits(OCStringRef *error);
 static bool SIUnitLibraryAddUSLabeledVolumeUnits(OCStringRef *error);
+static void SIUnitCandidateIndexInvalidate(SIDimensionalityRef dimensionality);
+static void SIUnitCandidateIndexClear(void);
+static uint64_t SIUnitHashBytes(const char *bytes, size_t length);
 // Library accessor functions
 OCMutableDictionaryRef SIUnitGetUnitsDictionaryLib(void) {
     if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
@@ -482,6 +871,222 @@ static bool SIUnitSymbolIsUnderived(OCStringRef symbol) {
     }
     return true;
 }
+// Fast path: underived symbols are stored under their raw symbol, so a direct
+// probe avoids normalizing and parsing.  Returns NULL on a miss.
+static SIUnitRef SIUnitLookupUnderivedSymbol(OCStringRef symbol) {
+    if (!SIUnitSymbolIsUnderived(symbol)) return NULL;
+    return (SIUnitRef)OCDictionaryGetValue(unitsDictionaryLibrary, symbol);
+}
+#pragma mark Canonical Key Index
+// Open-addressed table from token-ID keys (see siueCreateCanonicalKey) to the
+// unit filed under the matching cleaned expression.  It answers the
+// cleaned-string lookups in SIUnitWithSymbol, SIUnitWithParameters,
+// SIUnitFromExpression and SIUnitCoherentUnitFromDimensionality without
+// sorting or formatting; a miss falls back to the string key.  Like the name
+// index it is built from unitsDictionaryLibrary on first use, kept current as
+// keys are added, and dropped whenever a unit leaves the library.
+#define SIUNIT_CANONICAL_KEY_CAPACITY (1 + 4 * SIUE_CANONICAL_KEY_MAX_TOKENS)
+typedef struct {
+    int32_t *key;  // malloc'd, NULL if slot empty
+    uint32_t length;
+    uint64_t hash;
+    SIUnitRef unit;
+} SIUnitCanonicalEntry;
+static SIUnitCanonicalEntry *unitsCanonicalIndex = NULL;
+static size_t unitsCanonicalIndexCapacity = 0;  // a power of two
+static size_t unitsCanonicalIndexCount = 0;
+static uint64_t unitsCanonicalIndexHits = 0;
+static uint64_t unitsCanonicalIndexMisses = 0;
+static void SIUnitCanonicalIndexInvalidate(void) {
+    for (size_t i = 0; i < unitsCanonicalIndexCapacity; i++) free(unitsCanonicalIndex[i].key);
+    free(unitsCanonicalIndex);
+    unitsCanonicalIndex = NULL;
+    unitsCanonicalIndexCapacity = 0;
+    unitsCanonicalIndexCount = 0;
+}
+static SIUnitCanonicalEntry *SIUnitCanonicalIndexSlot(const int32_t *key, size_t length, uint64_t hash) {
+    size_t mask = unitsCanonicalIndexCapacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        SIUnitCanonicalEntry *entry = &unitsCanonicalIndex[i];
+        if (!entry->key) return entry;
+        if (entry->hash == hash && entry->length == length && memcmp(entry->key, key, length * sizeof(int32_t)) == 0)
+            return entry;
+    }
+}
+static SIUnitRef SIUnitCanonicalIndexLookupKey(const int32_t *key, size_t length) {
+    if (!unitsCanonicalIndex) return NULL;
+    uint64_t hash = SIUnitHashBytes((const char *)key, length * sizeof(int32_t));
+    SIUnitRef unit = SIUnitCanonicalIndexSlot(key, length, hash)->unit;
+    if (unit)
+        unitsCanonicalIndexHits++;
+    else
+        unitsCanonicalIndexMisses++;
+    return unit;
+}
+void SIUnitCanonicalIndexGetStatistics(uint64_t *hits, uint64_t *misses) {
+    if (hits) *hits = unitsCanonicalIndexHits;
+    if (misses) *misses = unitsCanonicalIndexMisses;
+}
+static bool SIUnitCanonicalIndexGrow(void) {
+    size_t capacity = unitsCanonicalIndexCapacity ? 2 * unitsCanonicalIndexCapacity : 4096;
+    SIUnitCanonicalEntry *table = calloc(capacity, sizeof(SIUnitCanonicalEntry));
+    if (!table) return false;
+    SIUnitCanonicalEntry *old = unitsCanonicalIndex;
+    size_t oldCapacity = unitsCanonicalIndexCapacity;
+    unitsCanonicalIndex = table;
+    unitsCanonicalIndexCapacity = capacity;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (old[i].key) *SIUnitCanonicalIndexSlot(old[i].key, old[i].length, old[i].hash) = old[i];
+    }
+    free(old);
+    return true;
+}
+// Files the unit that unitsDictionaryLibrary holds under the cleaned form of
+// key, which is where a cleaned-string lookup of any expression with the same
+// token-ID key lands.
+static void SIUnitCanonicalIndexAddKey(OCStringRef key) {
+    int32_t canonical[SIUNIT_CANONICAL_KEY_CAPACITY];
+    SIUnitCanonicalParse parse;
+    siueCanonicalParseInit(&parse, key);
+    size_t length = siueCanonicalParseGetKey(&parse, canonical, SIUNIT_CANONICAL_KEY_CAPACITY);
+    OCStringRef cleaned = length ? siueCanonicalParseCreateCleanedExpression(&parse) : NULL;
+    siueCanonicalParseDestroy(&parse);
+    SIUnitRef unit = cleaned ? OCDictionaryGetValue(unitsDictionaryLibrary, cleaned) : NULL;
+    if (cleaned) OCRelease(cleaned);
+    if (!unit) return;
+    if (2 * (unitsCanonicalIndexCount + 1) > unitsCanonicalIndexCapacity && !SIUnitCanonicalIndexGrow()) return;
+    uint64_t hash = SIUnitHashBytes((const char *)canonical, length * sizeof(int32_t));
+    SIUnitCanonicalEntry *entry = SIUnitCanonicalIndexSlot(canonical, length, hash);
+    if (!entry->key) {
+        entry->key = malloc(length * sizeof(int32_t));
+        if (!entry->key) return;
+        memcpy(entry->key, canonical, length * sizeof(int32_t));
+        entry->length = (uint32_t)length;
+        entry->hash = hash;
+        unitsCanonicalIndexCount++;
+    }
+    entry->unit = unit;
+}
+static bool SIUnitCanonicalIndexBuild(void) {
+    if (unitsCanonicalIndex) return true;
+    if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
+    IF_NO_OBJECT_EXISTS_RETURN(unitsDictionaryLibrary, false);
+    if (!SIUnitCanonicalIndexGrow()) return false;
+    OCArrayRef keys = OCDictionaryCreateArrayWithAllKeys(unitsDictionaryLibrary);
+    for (OCIndex i = 0; keys && i < OCArrayGetCount(keys); i++)
+        SIUnitCanonicalIndexAddKey(OCArrayGetValueAtIndex(keys, i));
+    if (keys) OCRelease(keys);
+    return true;
+}
+// Returns the unit a cleaned-string lookup of the parsed expression would
+// find, or NULL when the index has no entry or the expression has no token-ID key.
+static SIUnitRef SIUnitCanonicalIndexLookup(const SIUnitCanonicalParse *parse) {
+    if (!SIUnitCanonicalIndexBuild()) return NULL;
+    int32_t key[SIUNIT_CANONICAL_KEY_CAPACITY];
+    size_t length = siueCanonicalParseGetKey(parse, key, SIUNIT_CANONICAL_KEY_CAPACITY);
+    return length ? SIUnitCanonicalIndexLookupKey(key, length) : NULL;
+}
+#pragma mark Token Symbol Trie
+// Byte-wise trie over the UTF-8 spellings of every token symbol, giving the
+// unit scanner longest-match tokenization against the live token library.
+// Leaves hold the unit filed under the symbol, so a matched token needs no
+// further lookup.  Built on first match, extended as tokens and keys are
+// added, and dropped whenever a unit leaves the library.
+typedef struct {
+    int32_t child;    // first child, or -1
+    int32_t sibling;  // next node under the same parent, or -1
+    SIUnitRef unit;   // unit filed under the symbol ending here, possibly NULL
+    uint8_t byte;     // label of the edge from the parent
+    bool terminal;    // a token symbol ends here
+} SIUnitTokenTrieNode;
+static SIUnitTokenTrieNode *tokenTrie = NULL;
+static size_t tokenTrieCount = 0;
+static size_t tokenTrieCapacity = 0;
+static int32_t tokenTrieFirst[256];  // node for each leading byte, or -1
+static void SIUnitTokenTrieInvalidate(void) {
+    free(tokenTrie);
+    tokenTrie = NULL;
+    tokenTrieCount = 0;
+    tokenTrieCapacity = 0;
+}
+static int32_t SIUnitTokenTrieNewNode(uint8_t byte) {
+    if (tokenTrieCount == tokenTrieCapacity) {
+        size_t capacity = tokenTrieCapacity ? 2 * tokenTrieCapacity : 4096;
+        SIUnitTokenTrieNode *nodes = realloc(tokenTrie, capacity * sizeof(SIUnitTokenTrieNode));
+        if (!nodes) return -1;
+        tokenTrie = nodes;
+        tokenTrieCapacity = capacity;
+    }
+    SIUnitTokenTrieNode *node = &tokenTrie[tokenTrieCount];
+    node->child = -1;
+    node->sibling = -1;
+    node->unit = NULL;
+    node->byte = byte;
+    node->terminal = false;
+    return (int32_t)tokenTrieCount++;
+}
+// Adds symbol, or replaces the unit of a symbol already present
+static bool SIUnitTokenTrieInsert(OCStringRef symbol, SIUnitRef unit) {
+    const uint8_t *p = (const uint8_t *)OCStringGetCString(symbol);
+    if (!p || !*p) return false;
+    int32_t node = tokenTrieFirst[*p];
+    if (node < 0) {
+        if ((node = SIUnitTokenTrieNewNode(*p)) < 0) return false;
+        tokenTrieFirst[*p] = node;
+    }
+    for (p++; *p; p++) {
+        int32_t child = tokenTrie[node].child;
+        while (child >= 0 && tokenTrie[child].byte != *p) child = tokenTrie[child].sibling;
+        if (child < 0) {
+            if ((child = SIUnitTokenTrieNewNode(*p)) < 0) return false;
+            tokenTrie[child].sibling = tokenTrie[node].child;
+            tokenTrie[node].child = child;
+        }
+        node = child;
+    }
+    tokenTrie[node].terminal = true;
+    tokenTrie[node].unit = unit;
+    return true;
+}
+static bool SIUnitTokenTrieBuild(void) {
+    if (tokenTrie) return true;
+    if (NULL == tokenSymbolLibrary) SIUnitCreateLibraries();
+    if (NULL == tokenSymbolLibrary || NULL == unitsDictionaryLibrary) return false;
+    for (int i = 0; i < 256; i++) tokenTrieFirst[i] = -1;
+    for (OCIndex i = 0; i < OCArrayGetCount(tokenSymbolLibrary); i++) {
+        OCStringRef symbol = OCArrayGetValueAtIndex(tokenSymbolLibrary, i);
+        if (!SIUnitTokenTrieInsert(symbol, OCDictionaryGetValue(unitsDictionaryLibrary, symbol))) {
+            SIUnitTokenTrieInvalidate();
+            return false;
+        }
+    }
+    return true;
+}
+size_t SIUnitMatchTokenSymbol(const char *text, size_t length, SIUnitRef *unit) {
+    if (!text || length == 0 || !SIUnitTokenTrieBuild()) return 0;
+    const uint8_t *bytes = (const uint8_t *)text;
+    size_t matched = 0;
+    int32_t node = tokenTrieFirst[bytes[0]];
+    for (size_t i = 1; node >= 0; i++) {
+        if (tokenTrie[node].terminal) {
+            matched = i;
+            if (unit) *unit = tokenTrie[node].unit;
+        }
+        if (i == length) break;
+        int32_t child = tokenTrie[node].child;
+        while (child >= 0 && tokenTrie[child].byte != bytes[i]) child = tokenTrie[child].sibling;
+        node = child;
+    }
+    return matched;
+}
+// Every key enters unitsDictionaryLibrary here, so the canonical index and
+// the token trie stay current
+static void SIUnitDictionaryLibraryAdd(OCStringRef key, SIUnitRef unit) {
+    OCDictionaryAddValue(unitsDictionaryLibrary, key, unit);
+    if (unitsCanonicalIndex) SIUnitCanonicalIndexAddKey(key);
+    if (tokenTrie && OCDictionaryContainsKey(tokenSymbolIndex, key) && !SIUnitTokenTrieInsert(key, unit))
+        SIUnitTokenTrieInvalidate();
+}
 static void AddToUnitsDictionaryLibrary(SIUnitRef unit) {
     if (!unit) return;  // Guard against NULL pointer
     if (!OCTypeGetStaticInstance(unit)) {
@@ -490,33 +1095,113 @@ static void AddToUnitsDictionaryLibrary(SIUnitRef unit) {
     if (!SIUnitSymbolIsUnderived(unit->symbol)) {
         OCStringRef key = SIUnitCreateCleanedExpression(unit->symbol);
         if (key) {
-            OCDictionaryAddValue(unitsDictionaryLibrary, key, unit);
+            SIUnitDictionaryLibraryAdd(key, unit);
             OCRelease(key);
         }
     } else
-        OCDictionaryAddValue(unitsDictionaryLibrary, unit->symbol, unit);
+        SIUnitDictionaryLibraryAdd(unit->symbol, unit);
 }
 // Helper function to register a unit in all the appropriate libraries
 // After calling this function you must add the unit into
 // the unitsDictionaryLibrary dictionary using AddToUnitsDictionaryLibrary
+// Units are bucketed by symbol; dimensionality, scale and names are then
+// compared with impl_SIUnitEqual, whose tolerant scale comparison rules out hashing the scale.
+static SIUnitRef SIUnitSymbolIndexFind(SIUnitRef theUnit) {
+    OCArrayRef units = OCDictionaryGetValue(unitsSymbolIndex, theUnit->symbol);
+    for (OCIndex i = 0; units && i < OCArrayGetCount(units); i++) {
+        SIUnitRef candidate = OCArrayGetValueAtIndex(units, i);
+        if (impl_SIUnitEqual(candidate, theUnit)) return candidate;
+    }
+    return NULL;
+}
+static void SIUnitSymbolIndexAdd(SIUnitRef theUnit) {
+    OCMutableArrayRef units = (OCMutableArrayRef)OCDictionaryGetValue(unitsSymbolIndex, theUnit->symbol);
+    if (units) {
+        OCArrayAppendValue(units, theUnit);
+        return;
+    }
+    units = OCArrayCreateMutable(1, &kOCTypeArrayCallBacks);
+    OCArrayAppendValue(units, theUnit);
+    OCDictionaryAddValue(unitsSymbolIndex, theUnit->symbol, units);
+    OCRelease(units);
+}
+static void SIUnitSymbolIndexRemove(SIUnitRef theUnit) {
+    OCMutableArrayRef units = (OCMutableArrayRef)OCDictionaryGetValue(unitsSymbolIndex, theUnit->symbol);
+    if (!units) return;
+    for (OCIndex i = 0; i < OCArrayGetCount(units); i++) {
+        if (OCArrayGetValueAtIndex(units, i) == theUnit) {
+            OCArrayRemoveValueAtIndex(units, i);
+            break;
+        }
+    }
+    if (OCArrayGetCount(units) == 0) OCDictionaryRemoveValue(unitsSymbolIndex, theUnit->symbol);
+}
+static void SIUnitNameIndexAddName(OCStringRef name, SIUnitRef theUnit) {
+    if (!name || OCStringGetLength(name) == 0) return;
+    // First registered unit wins, as in a front-to-back scan
+    if (!OCDictionaryContainsKey(unitsNameIndex, name)) OCDictionaryAddValue(unitsNameIndex, name, theUnit);
+    OCMutableStringRef folded = OCStringCreateMutableCopy(name);
+    OCStringLowercase(folded);
+    if (!OCDictionaryContainsKey(unitsFoldedNameIndex, folded)) OCDictionaryAddValue(unitsFoldedNameIndex, folded, theUnit);
+    OCRelease(folded);
+}
+static void SIUnitNameIndexAdd(SIUnitRef theUnit) {
+    if (!unitsNameIndex) return;  // not built yet
+    SIUnitNameIndexAddName(theUnit->name, theUnit);
+    SIUnitNameIndexAddName(theUnit->plural_name, theUnit);
+}
+static void SIUnitNameIndexInvalidate(void) {
+    if (unitsNameIndex) {
+        OCRelease(unitsNameIndex);
+        unitsNameIndex = NULL;
+    }
+    if (unitsFoldedNameIndex) {
+        OCRelease(unitsFoldedNameIndex);
+        unitsFoldedNameIndex = NULL;
+    }
+}
+static bool SIUnitNameIndexBuild(void) {
+    if (unitsNameIndex) return true;
+    if (NULL == unitsArrayLibrary) SIUnitCreateLibraries();
+    IF_NO_OBJECT_EXISTS_RETURN(unitsArrayLibrary, false);
+    unitsNameIndex = OCDictionaryCreateMutable(0);
+    unitsFoldedNameIndex = OCDictionaryCreateMutable(0);
+    if (!unitsNameIndex || !unitsFoldedNameIndex) {
+        SIUnitNameIndexInvalidate();
+        return false;
+    }
+    for (OCIndex i = 0; i < OCArrayGetCount(unitsArrayLibrary); i++)
+        SIUnitNameIndexAdd(OCArrayGetValueAtIndex(unitsArrayLibrary, i));
+    return true;
+}
+// Appends a token symbol.  Symbols are never removed, so a symbol's index in
+// tokenSymbolLibrary is a stable, dense token ID.
+static void SIUnitTokenSymbolAdd(OCStringRef symbol) {
+    if (OCDictionaryContainsKey(tokenSymbolIndex, symbol)) return;
+    OCStringRef symbol_copy = OCStringCreateCopy(symbol);
+    OCNumberRef tokenID = OCNumberCreateWithSInt32((int32_t)OCArrayGetCount(tokenSymbolLibrary));
+    OCArrayAppendValue(tokenSymbolLibrary, symbol_copy);
+    OCDictionaryAddValue(tokenSymbolIndex, symbol_copy, tokenID);
+    if (tokenTrie && !SIUnitTokenTrieInsert(symbol_copy, OCDictionaryGetValue(unitsDictionaryLibrary, symbol_copy)))
+        SIUnitTokenTrieInvalidate();
+    OCRelease(tokenID);
+    OCRelease(symbol_copy);
+}
 static SIUnitRef RegisterUnitInLibraries(SIUnitRef theUnit,
                                          OCStringRef quantity,
                                          SIDimensionalityRef dimensionality) {
     // First check if unit is already registered.
-    if (OCArrayContainsValue(unitsArrayLibrary, theUnit)) {
-        OCIndex index = OCArrayGetFirstIndexOfValue(unitsArrayLibrary, theUnit);
-        return OCArrayGetValueAtIndex(unitsArrayLibrary, index);
-    }
+    SIUnitRef registered = SIUnitSymbolIndexFind(theUnit);
+    if (registered) return registered;
     OCTypeSetStaticInstance(theUnit, true);
     OCArrayAppendValue(unitsArrayLibrary, theUnit);
+    SIUnitSymbolIndexAdd(theUnit);
+    SIUnitNameIndexAdd(theUnit);
+    SIUnitCandidateIndexInvalidate(dimensionality);
+    SIUnitCandidateIndexInvalidate(theUnit->dimensionality);
+    unitLibraryGeneration++;
     // If unit symbol is underived, i.e., one of the token unit symbols, add to tokenSymbolLibrary
-    if (SIUnitSymbolIsUnderived(theUnit->symbol)) {
-        if (!OCArrayContainsValue(tokenSymbolLibrary, theUnit->symbol)) {
-            OCStringRef symbol_copy = OCStringCreateCopy(theUnit->symbol);
-            OCArrayAppendValue(tokenSymbolLibrary, symbol_copy);
-            OCRelease(symbol_copy);
-        }
-    }
+    if (SIUnitSymbolIsUnderived(theUnit->symbol)) SIUnitTokenSymbolAdd(theUnit->symbol);
     // Append unit to mutable array value associated with dimensionality key inside dimensionality library dictionary
     OCStringRef dimensionalitySymbol = SIDimensionalityCopySymbol(dimensionality);
     {
@@ -558,6 +1243,21 @@ OCMutableArrayRef SIUnitGetTokenSymbolsLib(void) {
     if (NULL == tokenSymbolLibrary) SIUnitCreateLibraries();
     return tokenSymbolLibrary;
 }
+bool SIUnitIsTokenSymbol(OCStringRef symbol) {
+    if (!symbol) return false;
+    if (NULL == tokenSymbolIndex) SIUnitCreateLibraries();
+    if (NULL == tokenSymbolIndex) return false;
+    return OCDictionaryContainsKey(tokenSymbolIndex, symbol);
+}
+OCIndex SIUnitGetTokenSymbolIndex(OCStringRef symbol) {
+    if (!symbol) return kOCNotFound;
+    if (NULL == tokenSymbolIndex) SIUnitCreateLibraries();
+    if (NULL == tokenSymbolIndex) return kOCNotFound;
+    OCNumberRef tokenID = OCDictionaryGetValue(tokenSymbolIndex, symbol);
+    int32_t index;
+    if (!tokenID || !OCNumberGetValue(tokenID, kOCNumberSInt32Type, &index)) return kOCNotFound;
+    return index;
+}
 static SIUnitRef AddToLib(
     OCStringRef quantity,
     OCStringRef name,
@@ -853,6 +1553,23 @@ static OCComparisonResult unitNameLengthSort(const void *val1, const void *val2,
         result = kOCCompareGreaterThan;
     return result;
 }
+// Absolute temperature scales whose zero differs from kelvin.  A value v in
+// one of these units is (v + offset) * scale_to_coherent_si kelvin.
+static const struct {
+    const char *symbol;
+    double offset_to_coherent_si;
+} kSIUnitAffineOffsets[] = {
+    {"°C", 273.15},
+    {"°F", 459.67},
+};
+static void SIUnitLibraryApplyAffineOffsets(void) {
+    for (size_t i = 0; i < sizeof(kSIUnitAffineOffsets) / sizeof(kSIUnitAffineOffsets[0]); i++) {
+        OCStringRef symbol = OCStringCreateWithCString(kSIUnitAffineOffsets[i].symbol);
+        struct impl_SIUnit *theUnit = (struct impl_SIUnit *)SIUnitWithSymbol(symbol);
+        OCRelease(symbol);
+        if (theUnit) theUnit->offset_to_coherent_si = kSIUnitAffineOffsets[i].offset_to_coherent_si;
+    }
+}
 static bool SIUnitCreateLibraries(void) {
     setlocale(LC_ALL, "");
     const struct lconv *const currentlocale = localeconv();
@@ -861,10 +1578,23 @@ static bool SIUnitCreateLibraries(void) {
     unitsQuantitiesLibrary = OCDictionaryCreateMutable(0);
     unitsDimensionalitiesLibrary = OCDictionaryCreateMutable(0);
     tokenSymbolLibrary = OCArrayCreateMutable(0, &kOCTypeArrayCallBacks);
+    tokenSymbolIndex = OCDictionaryCreateMutable(0);
+    unitsSymbolIndex = OCDictionaryCreateMutable(0);
     IF_NO_OBJECT_EXISTS_RETURN(unitsDictionaryLibrary, false);
     IF_NO_OBJECT_EXISTS_RETURN(unitsQuantitiesLibrary, false);
     IF_NO_OBJECT_EXISTS_RETURN(unitsDimensionalitiesLibrary, false);
     IF_NO_OBJECT_EXISTS_RETURN(tokenSymbolLibrary, false);
+    IF_NO_OBJECT_EXISTS_RETURN(tokenSymbolIndex, false);
+    IF_NO_OBJECT_EXISTS_RETURN(unitsSymbolIndex, false);
+#ifdef SITYPES_STATIC_UNIT_REGISTRY
+    // The generated registry is a snapshot of the default (US volume) library
+    if (SIUnitCreateLibrariesFromRegistry()) {
+        SIUnitLibraryApplyAffineOffsets();
+        if (currentlocale->currency_symbol && strcmp(currentlocale->currency_symbol, "£") == 0)
+            SIUnitLibrarySetDefaultVolumeSystem(kSIVolumeSystemUK);
+        return true;
+    }
+#endif
     // Initialize all units by including the definitions
 //************************************* */
 #include "SIUnitDefinitions.h"
@@ -907,15 +1637,212 @@ static bool SIUnitCreateLibraries(void) {
         OCRelease(key);
     }
     OCRelease(quantities);  // Fix memory leak - release the array created by OCDictionaryCreateArrayWithAllKeys
+    SIUnitLibraryApplyAffineOffsets();
     // Release error string if it was set during library initialization
     if (error) {
         OCRelease(error);
     }
     return true;
 }
+#pragma mark Static Registry
+// Flag bits used by the registry tables, in impl_SIUnit.flags order
+enum {
+    kSIUnitRegistrySIUnit = 1 << 0,
+    kSIUnitRegistryCGSUnit = 1 << 1,
+    kSIUnitRegistryImperialUnit = 1 << 2,
+    kSIUnitRegistryAtomicUnit = 1 << 3,
+    kSIUnitRegistryPlanckUnit = 1 << 4,
+    kSIUnitRegistryConstant = 1 << 7
+};
+static void SIUnitCSVWriteField(FILE *fp, OCStringRef string) {
+    const char *cString = string ? OCStringGetCString(string) : "";
+    fputc('"', fp);
+    for (const char *p = cString ? cString : ""; *p; p++) {
+        if (*p == '"') fputc('"', fp);
+        fputc(*p, fp);
+    }
+    fputc('"', fp);
+}
+static OCComparisonResult SIUnitCSVKeySort(const void *val1, const void *val2, void *context) {
+    (void)context;  // Unused parameter - required by OCTypes sort API
+    return OCStringCompare((OCStringRef)val1, (OCStringRef)val2, 0);
+}
+// Keys of dict in byte order, so a dump does not depend on hash order and
+// a registry-built library dumps identically to the one it came from.
+static OCArrayRef SIUnitCSVCreateSortedKeys(OCDictionaryRef dict) {
+    OCArrayRef keys = OCDictionaryCreateArrayWithAllKeys(dict);
+    if (!keys) return NULL;
+    OCMutableArrayRef sorted = OCArrayCreateMutableCopy(keys);
+    OCRelease(keys);
+    if (sorted) OCArraySortValues(sorted, OCRangeMake(0, OCArrayGetCount(sorted)), SIUnitCSVKeySort, NULL);
+    return sorted;
+}
+static void SIUnitCSVWriteGroups(FILE *fp, const char *tag, OCDictionaryRef groups) {
+    OCArrayRef keys = SIUnitCSVCreateSortedKeys(groups);
+    if (!keys) return;
+    for (OCIndex i = 0; i < OCArrayGetCount(keys); i++) {
+        OCStringRef key = OCArrayGetValueAtIndex(keys, i);
+        OCArrayRef units = OCDictionaryGetValue(groups, key);
+        for (OCIndex j = 0; j < OCArrayGetCount(units); j++) {
+            OCIndex index = OCArrayGetFirstIndexOfValue(unitsArrayLibrary, OCArrayGetValueAtIndex(units, j));
+            fprintf(fp, "%s,", tag);
+            SIUnitCSVWriteField(fp, key);
+            fprintf(fp, ",%ld\n", (long)index);
+        }
+    }
+    OCRelease(keys);
+}
+/**
+ * Writes the freshly built unit library as CSV for SIUnitRegistry.py.
+ *
+ * Record types (first column):
+ *   U,symbol,name,plural_name,14 exponents (num/den per base dimension),scale (hex float),flags
+ *   K,dictionary key,unit index
+ *   Q,quantity,unit index      (quantity library, in array order)
+ *   D,dimensionality,unit index
+ *   T,token symbol
+ *
+ * K, Q and D rows are written in key byte order, so equal libraries give
+ * identical files.
+ */
+bool SIUnitLibraryDumpCSV(const char *csvPath) {
+    if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
+    FILE *fp = fopen(csvPath, "w");
+    if (!fp) {
+        perror("fopen");
+        return false;
+    }
+    for (OCIndex i = 0; i < OCArrayGetCount(unitsArrayLibrary); i++) {
+        SIUnitRef unit = OCArrayGetValueAtIndex(unitsArrayLibrary, i);
+        fputs("U,", fp);
+        SIUnitCSVWriteField(fp, unit->symbol);
+        fputc(',', fp);
+        SIUnitCSVWriteField(fp, unit->name);
+        fputc(',', fp);
+        SIUnitCSVWriteField(fp, unit->plural_name);
+        for (int d = 0; d < BASE_DIMENSION_COUNT; d++)
+            fprintf(fp, ",%u,%u", unit->dimensionality->num_exp[d], unit->dimensionality->den_exp[d]);
+        unsigned flags = (unit->flags.isSIUnit ? kSIUnitRegistrySIUnit : 0) |
+                         (unit->flags.isCGSUnit ? kSIUnitRegistryCGSUnit : 0) |
+                         (unit->flags.isImperialUnit ? kSIUnitRegistryImperialUnit : 0) |
+                         (unit->flags.isAtomicUnit ? kSIUnitRegistryAtomicUnit : 0) |
+                         (unit->flags.isPlanckUnit ? kSIUnitRegistryPlanckUnit : 0) |
+                         (unit->flags.isConstant ? kSIUnitRegistryConstant : 0);
+        fprintf(fp, ",%a,%u\n", unit->scale_to_coherent_si, flags);
+    }
+    OCArrayRef keys = SIUnitCSVCreateSortedKeys(unitsDictionaryLibrary);
+    for (OCIndex i = 0; keys && i < OCArrayGetCount(keys); i++) {
+        OCStringRef key = OCArrayGetValueAtIndex(keys, i);
+        OCIndex index = OCArrayGetFirstIndexOfValue(unitsArrayLibrary, OCDictionaryGetValue(unitsDictionaryLibrary, key));
+        if (index == kOCNotFound) continue;
+        fputs("K,", fp);
+        SIUnitCSVWriteField(fp, key);
+        fprintf(fp, ",%ld\n", (long)index);
+    }
+    if (keys) OCRelease(keys);
+    SIUnitCSVWriteGroups(fp, "Q", unitsQuantitiesLibrary);
+    SIUnitCSVWriteGroups(fp, "D", unitsDimensionalitiesLibrary);
+    for (OCIndex i = 0; i < OCArrayGetCount(tokenSymbolLibrary); i++) {
+        fputs("T,", fp);
+        SIUnitCSVWriteField(fp, OCArrayGetValueAtIndex(tokenSymbolLibrary, i));
+        fputc('\n', fp);
+    }
+    fclose(fp);
+    return true;
+}
+#ifdef SITYPES_STATIC_UNIT_REGISTRY
+typedef struct {
+    const char *symbol;
+    const char *name;
+    const char *plural_name;
+    uint8_t num_exp[BASE_DIMENSION_COUNT];
+    uint8_t den_exp[BASE_DIMENSION_COUNT];
+    double scale_to_coherent_si;
+    uint8_t flags;
+} SIUnitRegistryUnit;
+typedef struct {
+    const char *key;
+    uint32_t unit;
+} SIUnitRegistryKey;
+typedef struct {
+    const char *key;
+    uint32_t first;  // index into the matching members table
+    uint32_t count;
+} SIUnitRegistryGroup;
+// Generated at build time by SIUnitRegistry.py
+#include "SIUnitRegistry.h"
+static OCStringRef SIUnitRegistryCreateString(const char *cString) {
+    return cString[0] ? OCStringCreateWithCString(cString) : STR("");
+}
+static void SIUnitRegistryAddGroups(OCMutableDictionaryRef library,
+                                    const SIUnitRegistryGroup *groups, size_t groupCount,
+                                    const uint32_t *members, SIUnitRef *units) {
+    for (size_t i = 0; i < groupCount; i++) {
+        OCMutableArrayRef array = OCArrayCreateMutable(groups[i].count, &kOCTypeArrayCallBacks);
+        for (uint32_t j = 0; j < groups[i].count; j++)
+            OCArrayAppendValue(array, units[members[groups[i].first + j]]);
+        OCStringRef key = OCStringCreateWithCString(groups[i].key);
+        OCDictionaryAddValue(library, key, array);
+        OCRelease(key);
+        OCRelease(array);
+    }
+}
+// Wires the libraries from the generated tables: no expression parsing,
+// quantity lookups or sorting, just object creation and pointer wiring.
+static bool SIUnitCreateLibrariesFromRegistry(void) {
+    SIUnitRef *units = malloc(kSIUnitRegistryUnitCount * sizeof(SIUnitRef));
+    if (!units) return false;
+    for (size_t i = 0; i < kSIUnitRegistryUnitCount; i++) {
+        const SIUnitRegistryUnit *entry = &kSIUnitRegistryUnits[i];
+        struct impl_SIUnit *theUnit = SIUnitAllocate();
+        if (!theUnit) {
+            free(units);
+            return false;
+        }
+        theUnit->dimensionality = OCRetain(SIDimensionalityWithExponentArrays(entry->num_exp, entry->den_exp));
+        theUnit->scale_to_coherent_si = entry->scale_to_coherent_si;
+        theUnit->offset_to_coherent_si = 0.0;
+        theUnit->symbol = OCStringCreateWithCString(entry->symbol);
+        theUnit->name = SIUnitRegistryCreateString(entry->name);
+        theUnit->plural_name = SIUnitRegistryCreateString(entry->plural_name);
+        memset(&theUnit->flags, 0, sizeof(theUnit->flags));
+        theUnit->flags.isSIUnit = (entry->flags & kSIUnitRegistrySIUnit) != 0;
+        theUnit->flags.isCGSUnit = (entry->flags & kSIUnitRegistryCGSUnit) != 0;
+        theUnit->flags.isImperialUnit = (entry->flags & kSIUnitRegistryImperialUnit) != 0;
+        theUnit->flags.isAtomicUnit = (entry->flags & kSIUnitRegistryAtomicUnit) != 0;
+        theUnit->flags.isPlanckUnit = (entry->flags & kSIUnitRegistryPlanckUnit) != 0;
+        theUnit->flags.isConstant = (entry->flags & kSIUnitRegistryConstant) != 0;
+        OCTypeSetStaticInstance(theUnit, true);
+        OCArrayAppendValue(unitsArrayLibrary, theUnit);
+        SIUnitSymbolIndexAdd(theUnit);
+        units[i] = theUnit;
+    }
+    for (size_t i = 0; i < kSIUnitRegistryKeyCount; i++) {
+        OCStringRef key = OCStringCreateWithCString(kSIUnitRegistryKeys[i].key);
+        SIUnitDictionaryLibraryAdd(key, units[kSIUnitRegistryKeys[i].unit]);
+        OCRelease(key);
+    }
+    SIUnitRegistryAddGroups(unitsQuantitiesLibrary, kSIUnitRegistryQuantities, kSIUnitRegistryQuantityCount,
+                            kSIUnitRegistryQuantityMembers, units);
+    SIUnitRegistryAddGroups(unitsDimensionalitiesLibrary, kSIUnitRegistryDimensionalities, kSIUnitRegistryDimensionalityCount,
+                            kSIUnitRegistryDimensionalityMembers, units);
+    for (size_t i = 0; i < kSIUnitRegistryTokenSymbolCount; i++) {
+        OCStringRef symbol = OCStringCreateWithCString(kSIUnitRegistryTokenSymbols[i]);
+        SIUnitTokenSymbolAdd(symbol);
+        OCRelease(symbol);
+    }
+    free(units);
+    unitLibraryGeneration++;
+    return true;
+}
+#endif
 // Add a cleanup function for static dictionaries and array
 void SIUnitLibrariesShutdown(void) {
     if (!unitsDictionaryLibrary) return;
+    unitLibraryGeneration++;
+    coherentUnitGeneration++;
+    SIUnitExpressionCacheClear();
+    SIUnitAlgebraCacheClear();
     // All SIUnits inside these Arrays should be static instances.
     if (unitsQuantitiesLibrary) {
         OCRelease(unitsQuantitiesLibrary);
@@ -929,6 +1856,18 @@ void SIUnitLibrariesShutdown(void) {
         OCRelease(tokenSymbolLibrary);
         tokenSymbolLibrary = NULL;
     }
+    if (tokenSymbolIndex) {
+        OCRelease(tokenSymbolIndex);
+        tokenSymbolIndex = NULL;
+    }
+    if (unitsSymbolIndex) {
+        OCRelease(unitsSymbolIndex);
+        unitsSymbolIndex = NULL;
+    }
+    SIUnitNameIndexInvalidate();
+    SIUnitCandidateIndexClear();
+    SIUnitCanonicalIndexInvalidate();
+    SIUnitTokenTrieInvalidate();
     if (unitsDictionaryLibrary) {
         OCRelease(unitsDictionaryLibrary);
         unitsDictionaryLibrary = NULL;
@@ -948,9 +1887,20 @@ SIUnitRef SIUnitWithSymbol(OCStringRef symbol) {
     }
     if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
     IF_NO_OBJECT_EXISTS_RETURN(unitsDictionaryLibrary, NULL);
-    OCStringRef key = SIUnitCreateCleanedExpression(symbol);
-    SIUnitRef unit = OCDictionaryGetValue(unitsDictionaryLibrary, key);
-    OCRelease(key);
+    SIUnitRef unit = SIUnitLookupUnderivedSymbol(symbol);
+    if (unit) return unit;
+    // One parse serves both the index and, on a miss, the cleaned-string key
+    SIUnitCanonicalParse parse;
+    siueCanonicalParseInit(&parse, symbol);
+    unit = SIUnitCanonicalIndexLookup(&parse);
+    if (!unit) {
+        OCStringRef key = siueCanonicalParseCreateCleanedExpression(&parse);
+        if (key) {
+            unit = OCDictionaryGetValue(unitsDictionaryLibrary, key);
+            OCRelease(key);
+        }
+    }
+    siueCanonicalParseDestroy(&parse);
     return unit;
 }
 static bool SIUnitLibraryRemoveUnitWithSymbol(OCStringRef symbol) {
@@ -959,9 +1909,16 @@ static bool SIUnitLibraryRemoveUnitWithSymbol(OCStringRef symbol) {
     if (OCDictionaryContainsKey(unitsDictionaryLibrary, key)) {
         SIUnitRef unit = (SIUnitRef)OCDictionaryGetValue(unitsDictionaryLibrary, key);
         OCDictionaryRemoveValue(unitsDictionaryLibrary, key);
+        SIUnitSymbolIndexRemove(unit);
+        SIUnitNameIndexInvalidate();  // another unit may share the name; rebuild on next lookup
+        SIUnitCandidateIndexClear();
+        SIUnitCanonicalIndexInvalidate();
+        SIUnitTokenTrieInvalidate();
+        coherentUnitGeneration++;
         OCIndex index = OCArrayGetFirstIndexOfValue(unitsArrayLibrary, unit);
         OCTypeSetStaticInstance(unit, false);
         OCArrayRemoveValueAtIndex(unitsArrayLibrary, index);
+        unitLibraryGeneration++;
         OCRelease(key);  // Fix memory leak
         return true;
     }
@@ -1189,27 +2146,20 @@ SIVolumeSystem SIUnitLibraryGetDefaultVolumeSystem(void) {
     return imperialVolumes ? kSIVolumeSystemUK : kSIVolumeSystemUS;
 }
 SIUnitRef SIUnitFindWithName(OCStringRef input) {
-    if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
-    IF_NO_OBJECT_EXISTS_RETURN(unitsDictionaryLibrary, NULL);
-    int64_t count = OCDictionaryGetCount(unitsDictionaryLibrary);
-    OCStringRef keys[count];
-    SIUnitRef units[count];
-    OCDictionaryGetKeysAndValues(unitsDictionaryLibrary, (const void **)keys, (const void **)units);
-    for (int64_t index = 0; index < count; index++) {
-        OCStringRef name = units[index]->name;
-        if (name)
-            if (OCStringCompare(name, input, 0) == kOCCompareEqualTo) {
-                SIUnitRef theUnit = units[index];
-                return theUnit;
-            }
-        OCStringRef plural_name = units[index]->plural_name;
-        if (plural_name)
-            if (OCStringCompare(plural_name, input, 0) == kOCCompareEqualTo) {
-                SIUnitRef theUnit = units[index];
-                return theUnit;
-            }
-    }
-    return NULL;
+    if (NULL == input) return NULL;
+    if (!SIUnitNameIndexBuild()) return NULL;
+    return OCDictionaryGetValue(unitsNameIndex, input);
+}
+SIUnitRef SIUnitFindWithNameIgnoringCase(OCStringRef input) {
+    if (NULL == input) return NULL;
+    if (!SIUnitNameIndexBuild()) return NULL;
+    SIUnitRef theUnit = OCDictionaryGetValue(unitsNameIndex, input);
+    if (theUnit) return theUnit;
+    OCMutableStringRef folded = OCStringCreateMutableCopy(input);
+    OCStringLowercase(folded);
+    theUnit = OCDictionaryGetValue(unitsFoldedNameIndex, folded);
+    OCRelease(folded);
+    return theUnit;
 }
 SIUnitRef SIUnitWithParameters(SIDimensionalityRef dimensionality,
                                OCStringRef name,
@@ -1221,7 +2171,16 @@ SIUnitRef SIUnitWithParameters(SIDimensionalityRef dimensionality,
     if (NULL == tempUnit) return NULL;
     // Check if another unit with this symbol already exists
     OCDictionaryRef unitsLib = SIUnitGetUnitsDictionaryLib();
-    OCStringRef key = SIUnitCreateCleanedExpression(tempUnit->symbol);
+    SIUnitCanonicalParse parse;
+    siueCanonicalParseInit(&parse, tempUnit->symbol);
+    SIUnitRef indexedUnit = SIUnitCanonicalIndexLookup(&parse);
+    if (indexedUnit) {
+        siueCanonicalParseDestroy(&parse);
+        OCRelease(tempUnit);
+        return indexedUnit;
+    }
+    OCStringRef key = siueCanonicalParseCreateCleanedExpression(&parse);
+    siueCanonicalParseDestroy(&parse);
     if (OCDictionaryContainsKey(unitsLib, key)) {
         SIUnitRef existingUnit = OCDictionaryGetValue(unitsLib, key);
         OCRelease(tempUnit);  // Discard the temporary unit
@@ -1238,15 +2197,66 @@ SIUnitRef SIUnitWithParameters(SIDimensionalityRef dimensionality,
     // Reuse the key we already created
     if (!SIUnitSymbolIsUnderived(registeredUnit->symbol)) {
         if (key) {
-            OCDictionaryAddValue(unitsDictionaryLibrary, key, registeredUnit);
+            SIUnitDictionaryLibraryAdd(key, registeredUnit);
         }
     } else {
-        OCDictionaryAddValue(unitsDictionaryLibrary, registeredUnit->symbol, registeredUnit);
+        SIUnitDictionaryLibraryAdd(registeredUnit->symbol, registeredUnit);
     }
     OCRelease(key);  // Release the key after dictionary retains it
     return registeredUnit;
 }
-SIUnitRef SIUnitCoherentUnitFromDimensionality(SIDimensionalityRef dimensionality) {
+// Token-ID key of the coherent unit's symbol, read straight from the
+// exponents: numerator and denominator base units appear as
+// SIDimensionalityCopySymbol lists them, with each base dimension replaced by
+// its SI base unit.  Returns 0 when dimensionless or a base unit is not a token.
+static size_t SIUnitCoherentCanonicalKey(SIDimensionalityRef dimensionality, int32_t *key) {
+    static const char *const baseUnitSymbols[BASE_DIMENSION_COUNT] = {"kg", "m", "s", "A", "K", "mol", "cd"};
+    int32_t numerator[2 * BASE_DIMENSION_COUNT], denominator[2 * BASE_DIMENSION_COUNT];
+    size_t numeratorCount = 0, denominatorCount = 0;
+    for (int i = 0; i < BASE_DIMENSION_COUNT; i++) {
+        uint8_t num = dimensionality->num_exp[i], den = dimensionality->den_exp[i];
+        if (!num && !den) continue;
+        OCStringRef symbol = OCStringCreateWithCString(baseUnitSymbols[i]);
+        OCIndex token = SIUnitGetTokenSymbolIndex(symbol);
+        OCRelease(symbol);
+        if (token == kOCNotFound) return 0;
+        if (num) {
+            numerator[2 * numeratorCount] = (int32_t)token;
+            numerator[2 * numeratorCount++ + 1] = num;
+        }
+        if (den) {
+            denominator[2 * denominatorCount] = (int32_t)token;
+            denominator[2 * denominatorCount++ + 1] = den;
+        }
+    }
+    if (!numeratorCount && !denominatorCount) return 0;
+    // Token IDs follow registration order, not base-dimension order
+    int32_t *sections[2] = {numerator, denominator};
+    size_t counts[2] = {numeratorCount, denominatorCount};
+    size_t length = 1;
+    key[0] = (int32_t)numeratorCount;
+    for (int s = 0; s < 2; s++) {
+        for (size_t i = 0; i < counts[s]; i++) {
+            size_t j = length + 2 * i;
+            int32_t token = sections[s][2 * i], power = sections[s][2 * i + 1];
+            for (; j > length && key[j - 2] > token; j -= 2) {
+                key[j] = key[j - 2];
+                key[j + 1] = key[j - 1];
+            }
+            key[j] = token;
+            key[j + 1] = power;
+        }
+        length += 2 * counts[s];
+    }
+    return length;
+}
+static SIUnitRef SIUnitCoherentUnitFromDimensionalityUncached(SIDimensionalityRef dimensionality) {
+    int32_t canonical[1 + 4 * BASE_DIMENSION_COUNT];
+    size_t canonicalLength = SIUnitCoherentCanonicalKey(dimensionality, canonical);
+    if (canonicalLength && SIUnitCanonicalIndexBuild()) {
+        SIUnitRef indexedUnit = SIUnitCanonicalIndexLookupKey(canonical, canonicalLength);
+        if (indexedUnit) return indexedUnit;
+    }
     OCMutableStringRef symbol = (OCMutableStringRef)SIDimensionalityCopySymbol(dimensionality);
     // Create Coherent Unit symbol by simply replacing base dimensionality symbols with base SI symbols
     OCStringFindAndReplace2(symbol, STR("L"), STR("m"));
@@ -1282,6 +2292,18 @@ SIUnitRef SIUnitCoherentUnitFromDimensionality(SIDimensionalityRef dimensionalit
     OCRelease(symbol);  // Fix: Release symbol before returning
     return registeredUnit;
 }
+SIUnitRef SIUnitCoherentUnitFromDimensionality(SIDimensionalityRef dimensionality) {
+    IF_NO_OBJECT_EXISTS_RETURN(dimensionality, NULL);
+    if (dimensionality->coherent_unit && dimensionality->coherent_unit_generation == coherentUnitGeneration)
+        return dimensionality->coherent_unit;
+    SIUnitRef coherentUnit = SIUnitCoherentUnitFromDimensionalityUncached(dimensionality);
+    if (coherentUnit) {
+        struct impl_SIDimensionality *dim = (struct impl_SIDimensionality *)dimensionality;
+        dim->coherent_unit = coherentUnit;
+        dim->coherent_unit_generation = coherentUnitGeneration;
+    }
+    return coherentUnit;
+}
 bool SIUnitIsCoherentUnit(SIUnitRef theUnit) {
     if (SIUnitCoherentUnitFromDimensionality(theUnit->dimensionality) == theUnit) return true;
     return false;
@@ -1404,62 +2426,181 @@ SIUnitRef SIUnitFindEquivalentUnitWithShortestSymbol(SIUnitRef theUnit) {
 }
 //
 // Common helper function for finding best matching unit with SI preference
-static SIUnitRef SIUnitFindBestMatchingUnit(SIDimensionalityRef dimensionality, double target_scale) {
-    // Always ensure the library has a coherent SI unit with this dimensionality
-    SIUnitCoherentUnitFromDimensionality(dimensionality);
-    OCArrayRef candidates = SIUnitCreateArrayOfUnitsForDimensionality(dimensionality);
-    if (!candidates || OCArrayGetCount(candidates) == 0) {
-        if (candidates) OCRelease(candidates);
-        return NULL;
-    }
-    SIUnitRef best_match = NULL;
-    double best_scale_diff = 1e100;
-    int best_token_count = INT_MAX;
-    for (uint64_t i = 0; i < OCArrayGetCount(candidates); i++) {
-        SIUnitRef candidate = (SIUnitRef)OCArrayGetValueAtIndex(candidates, i);
-        // Only consider SI units as candidates
-        if (!SIUnitIsSIUnit(candidate)) {
-            continue;
+#pragma mark Best Matching Unit Index
+// SI units of one dimensionality, precomputed for SIUnitFindBestMatchingUnit.
+// Named units (one token symbol) always beat derived ones, so the two tiers
+// are kept apart; each tier is stored in library order for the tie-breaking
+// scan, and again sorted by (scale, token count, order) for exact-scale hits.
+typedef struct {
+    SIUnitRef unit;
+    double scale;
+    int token_count;
+    uint32_t order;
+} SIUnitCandidate;
+typedef struct {
+    SIUnitCandidate *ordered;
+    SIUnitCandidate *sorted;
+    uint32_t count;
+} SIUnitCandidateTier;
+typedef struct {
+    SIDimensionalityRef dimensionality;  // interned, so compared by pointer
+    bool valid;
+    SIUnitCandidateTier named;
+    SIUnitCandidateTier derived;
+} SIUnitCandidateSet;
+static SIUnitCandidateSet *candidateSets = NULL;
+static size_t candidateSetCapacity = 0;
+static size_t candidateSetCount = 0;
+static size_t SIUnitCandidateHash(SIDimensionalityRef dimensionality) {
+    uintptr_t h = (uintptr_t)dimensionality;
+    h ^= h >> 17;
+    h *= (uintptr_t)0x9E3779B97F4A7C15ULL;
+    return (size_t)(h ^ (h >> 29));
+}
+static void SIUnitCandidateTierFree(SIUnitCandidateTier *tier) {
+    free(tier->ordered);
+    free(tier->sorted);
+    memset(tier, 0, sizeof(*tier));
+}
+static SIUnitCandidateSet *SIUnitCandidateSetSlot(SIDimensionalityRef dimensionality, bool insert) {
+    if (candidateSetCapacity == 0) {
+        if (!insert) return NULL;
+        candidateSets = calloc(64, sizeof(SIUnitCandidateSet));
+        if (!candidateSets) return NULL;
+        candidateSetCapacity = 64;
+    }
+    size_t mask = candidateSetCapacity - 1;
+    for (size_t i = SIUnitCandidateHash(dimensionality) & mask;; i = (i + 1) & mask) {
+        SIUnitCandidateSet *set = &candidateSets[i];
+        if (set->dimensionality == dimensionality) return set;
+        if (set->dimensionality == NULL) {
+            if (!insert) return NULL;
+            set->dimensionality = dimensionality;
+            candidateSetCount++;
+            return set;
         }
-        OCStringRef symbol = SIUnitCopySymbol(candidate);
-        int symbol_token_count = SIUnitCountTokenSymbols(symbol);
-        double scale_diff = fabs(candidate->scale_to_coherent_si - target_scale);
-        bool is_better = false;
-        if (best_match == NULL) {
-            // First SI candidate is automatically the best so far
-            is_better = true;
-        } else {
-            // Priority 0: Strongly prefer named units (single token) over derived units
-            bool candidate_is_named = (symbol_token_count == 1);
-            bool best_is_named = (best_token_count == 1);
-            if (candidate_is_named && !best_is_named) {
-                // Named unit beats derived unit regardless of scale
-                is_better = true;
-            } else if (!candidate_is_named && best_is_named) {
-                // Don't replace named unit with derived unit
-                is_better = false;
-            } else {
-                // Both are named or both are derived, use normal comparison
-                // Priority 1: Significantly better scale difference (more than 1% difference)
-                if (scale_diff < best_scale_diff * 0.99) {
-                    is_better = true;
-                } else if (scale_diff <= best_scale_diff * 1.01) {
-                    // Priority 2: Among units with similar scale, prefer fewer token symbols
-                    if (symbol_token_count < best_token_count) {
-                        is_better = true;
-                    }
-                }
-            }
+    }
+}
+static bool SIUnitCandidateIndexGrow(void) {
+    size_t oldCapacity = candidateSetCapacity;
+    SIUnitCandidateSet *old = candidateSets;
+    SIUnitCandidateSet *grown = calloc(oldCapacity * 2, sizeof(SIUnitCandidateSet));
+    if (!grown) return false;
+    candidateSets = grown;
+    candidateSetCapacity = oldCapacity * 2;
+    candidateSetCount = 0;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (!old[i].dimensionality) continue;
+        *SIUnitCandidateSetSlot(old[i].dimensionality, true) = old[i];
+    }
+    free(old);
+    return true;
+}
+static void SIUnitCandidateIndexInvalidate(SIDimensionalityRef dimensionality) {
+    SIUnitCandidateSet *set = dimensionality ? SIUnitCandidateSetSlot(dimensionality, false) : NULL;
+    if (!set || !set->valid) return;
+    SIUnitCandidateTierFree(&set->named);
+    SIUnitCandidateTierFree(&set->derived);
+    set->valid = false;
+}
+static void SIUnitCandidateIndexClear(void) {
+    for (size_t i = 0; i < candidateSetCapacity; i++) {
+        SIUnitCandidateTierFree(&candidateSets[i].named);
+        SIUnitCandidateTierFree(&candidateSets[i].derived);
+    }
+    free(candidateSets);
+    candidateSets = NULL;
+    candidateSetCapacity = 0;
+    candidateSetCount = 0;
+}
+static int SIUnitCandidateCompare(const void *a, const void *b) {
+    const SIUnitCandidate *c1 = a, *c2 = b;
+    if (c1->scale != c2->scale) return c1->scale < c2->scale ? -1 : 1;
+    if (c1->token_count != c2->token_count) return c1->token_count < c2->token_count ? -1 : 1;
+    return c1->order < c2->order ? -1 : (c1->order > c2->order);
+}
+static bool SIUnitCandidateTierFinish(SIUnitCandidateTier *tier) {
+    if (tier->count == 0) return true;
+    tier->sorted = malloc(tier->count * sizeof(SIUnitCandidate));
+    if (!tier->sorted) return false;
+    memcpy(tier->sorted, tier->ordered, tier->count * sizeof(SIUnitCandidate));
+    qsort(tier->sorted, tier->count, sizeof(SIUnitCandidate), SIUnitCandidateCompare);
+    return true;
+}
+static SIUnitCandidateSet *SIUnitCandidateSetForDimensionality(SIDimensionalityRef dimensionality) {
+    SIUnitCandidateSet *set = SIUnitCandidateSetSlot(dimensionality, false);
+    if (set && set->valid) return set;
+    if (!set) {
+        if ((candidateSetCount + 1) * 2 > candidateSetCapacity && candidateSetCapacity && !SIUnitCandidateIndexGrow())
+            return NULL;
+        set = SIUnitCandidateSetSlot(dimensionality, true);
+        if (!set) return NULL;
+    }
+    OCArrayRef units = SIUnitCreateArrayOfUnitsForDimensionality(dimensionality);
+    uint32_t count = units ? (uint32_t)OCArrayGetCount(units) : 0;
+    if (count) {
+        set->named.ordered = malloc(count * sizeof(SIUnitCandidate));
+        set->derived.ordered = malloc(count * sizeof(SIUnitCandidate));
+        if (!set->named.ordered || !set->derived.ordered) {
+            SIUnitCandidateTierFree(&set->named);
+            SIUnitCandidateTierFree(&set->derived);
+            OCRelease(units);
+            return NULL;
         }
-        if (is_better) {
-            best_match = candidate;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        SIUnitRef unit = OCArrayGetValueAtIndex(units, i);
+        // Only SI units are candidates
+        if (!SIUnitIsSIUnit(unit)) continue;
+        int token_count = SIUnitCountTokenSymbols(unit->symbol);
+        SIUnitCandidateTier *tier = token_count == 1 ? &set->named : &set->derived;
+        tier->ordered[tier->count++] = (SIUnitCandidate){unit, unit->scale_to_coherent_si, token_count, i};
+    }
+    if (units) OCRelease(units);
+    if (!SIUnitCandidateTierFinish(&set->named) || !SIUnitCandidateTierFinish(&set->derived)) {
+        SIUnitCandidateTierFree(&set->named);
+        SIUnitCandidateTierFree(&set->derived);
+        return NULL;
+    }
+    set->valid = true;
+    return set;
+}
+static SIUnitRef SIUnitCandidateTierBestMatch(const SIUnitCandidateTier *tier, double target_scale) {
+    if (tier->count == 0) return NULL;
+    // An exact scale match can only be displaced by an exact match with fewer
+    // tokens, so the first entry of that scale in sorted order is the answer.
+    size_t lo = 0, hi = tier->count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (tier->sorted[mid].scale < target_scale)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo < tier->count && tier->sorted[lo].scale == target_scale) return tier->sorted[lo].unit;
+    // Otherwise apply the order-dependent 1% tolerance rule in library order
+    const SIUnitCandidate *best = &tier->ordered[0];
+    double best_scale_diff = fabs(best->scale - target_scale);
+    for (uint32_t i = 1; i < tier->count; i++) {
+        const SIUnitCandidate *candidate = &tier->ordered[i];
+        double scale_diff = fabs(candidate->scale - target_scale);
+        if (scale_diff < best_scale_diff * 0.99 ||
+            (scale_diff <= best_scale_diff * 1.01 && candidate->token_count < best->token_count)) {
+            best = candidate;
             best_scale_diff = scale_diff;
-            best_token_count = symbol_token_count;
         }
-        OCRelease(symbol);
     }
-    OCRelease(candidates);
-    return best_match;
+    return best->unit;
+}
+static SIUnitRef SIUnitFindBestMatchingUnit(SIDimensionalityRef dimensionality, double target_scale) {
+    // Always ensure the library has a coherent SI unit with this dimensionality
+    SIUnitCoherentUnitFromDimensionality(dimensionality);
+    SIUnitCandidateSet *set = SIUnitCandidateSetForDimensionality(dimensionality);
+    if (!set) return NULL;
+    // Named units (single token) beat derived units regardless of scale
+    SIUnitRef best_match = SIUnitCandidateTierBestMatch(&set->named, target_scale);
+    if (best_match) return best_match;
+    return SIUnitCandidateTierBestMatch(&set->derived, target_scale);
 }
 SIUnitRef SIUnitByReducing(SIUnitRef theUnit, double *unit_multiplier) {
     IF_NO_OBJECT_EXISTS_RETURN(theUnit, NULL);
@@ -1485,8 +2626,131 @@ SIUnitRef SIUnitByReducing(SIUnitRef theUnit, double *unit_multiplier) {
     }
     return result;
 }
+#pragma mark Unit Algebra Cache
+// Direct-mapped memo of multiply, divide, power and root results, keyed on the
+// operation, the (library-owned) operand pointers, the integer exponent and the
+// reduce flag.  Each entry holds the result unit and the factor the operation
+// applies to a unit multiplier of 1.  Multiply and divide scale the caller's
+// multiplier by that factor, so one entry serves every caller.  Power, root
+// and the product of equivalent units derive their scale from the incoming
+// multiplier itself, so their entries only serve callers passing 1.  Like the
+// expression cache, entries are dropped whenever unitLibraryGeneration moves,
+// and a clear on any thread empties every thread's table.
+#ifndef SIUNIT_ALGEBRA_CACHE_SIZE
+#define SIUNIT_ALGEBRA_CACHE_SIZE 1024  // must be a power of two
+#endif
+typedef enum {
+    kSIUnitOpMultiply = 1,
+    kSIUnitOpDivide,
+    kSIUnitOpPower,
+    kSIUnitOpRoot
+} SIUnitAlgebraOp;
+typedef struct {
+    SIUnitRef unit1;
+    SIUnitRef unit2;  // NULL for power and root
+    int32_t exponent;  // power or root, 0 for multiply and divide
+    uint8_t op;        // 0 marks an empty slot
+    uint8_t reduce;
+} SIUnitAlgebraKey;
+typedef struct {
+    SIUnitAlgebraKey key;
+    SIUnitRef result;
+    double factor;  // outgoing *unit_multiplier for an incoming 1
+    bool scales;    // factor multiplies any incoming multiplier
+} SIUnitAlgebraCacheEntry;
+SI_CACHE_STORAGE SIUnitAlgebraCacheEntry *algebraCache = NULL;
+SI_CACHE_STORAGE uint64_t algebraCacheGeneration = 0;
+SI_CACHE_STORAGE uint64_t algebraCacheEpochSeen = 0;
+SI_CACHE_STORAGE uint64_t algebraCacheHits = 0;
+SI_CACHE_STORAGE uint64_t algebraCacheMisses = 0;
+static SICacheEpoch algebraCacheEpoch = 0;
+static uint64_t SIUnitHashBytes(const char *bytes, size_t length);
+static SIUnitRef SIUnitByRaisingToPowerUncached(SIUnitRef input, int power, double *unit_multiplier, bool reduce, OCStringRef *error);
+static SIUnitRef SIUnitByMultiplyingUncached(SIUnitRef theUnit1, SIUnitRef theUnit2, double *unit_multiplier, bool reduce, OCStringRef *error);
+static SIUnitRef SIUnitByDividingUncached(SIUnitRef theUnit1, SIUnitRef theUnit2, double *unit_multiplier, bool reduce, OCStringRef *error);
+static SIUnitRef SIUnitByTakingNthRootUncached(SIUnitRef theUnit, int root, double *unit_multiplier, OCStringRef *error);
+static SIUnitAlgebraCacheEntry *SIUnitAlgebraCacheSlot(uint64_t hash) {
+    if (!algebraCache) {
+        algebraCache = calloc(SIUNIT_ALGEBRA_CACHE_SIZE, sizeof(SIUnitAlgebraCacheEntry));
+        if (!algebraCache) return NULL;
+        SIUnitCacheRegisterThread();
+        algebraCacheGeneration = unitLibraryGeneration;
+        algebraCacheEpochSeen = SICacheEpochLoad(algebraCacheEpoch);
+    }
+    if (algebraCacheGeneration != unitLibraryGeneration || algebraCacheEpochSeen != SICacheEpochLoad(algebraCacheEpoch)) {
+        memset(algebraCache, 0, SIUNIT_ALGEBRA_CACHE_SIZE * sizeof(SIUnitAlgebraCacheEntry));
+        algebraCacheGeneration = unitLibraryGeneration;
+        algebraCacheEpochSeen = SICacheEpochLoad(algebraCacheEpoch);
+    }
+    return &algebraCache[hash & (SIUNIT_ALGEBRA_CACHE_SIZE - 1)];
+}
+void SIUnitAlgebraCacheClear(void) {
+    free(algebraCache);
+    algebraCache = NULL;
+    SICacheEpochBump(algebraCacheEpoch);
+    algebraCacheHits = 0;
+    algebraCacheMisses = 0;
+}
+void SIUnitAlgebraCacheGetStatistics(uint64_t *hits, uint64_t *misses) {
+    if (hits) *hits = algebraCacheHits;
+    if (misses) *misses = algebraCacheMisses;
+}
+static SIUnitRef SIUnitAlgebraUncached(SIUnitAlgebraOp op, SIUnitRef unit1, SIUnitRef unit2, int exponent,
+                                       double *unit_multiplier, bool reduce, OCStringRef *error) {
+    switch (op) {
+        case kSIUnitOpMultiply:
+            return SIUnitByMultiplyingUncached(unit1, unit2, unit_multiplier, reduce, error);
+        case kSIUnitOpDivide:
+            return SIUnitByDividingUncached(unit1, unit2, unit_multiplier, reduce, error);
+        case kSIUnitOpPower:
+            return SIUnitByRaisingToPowerUncached(unit1, exponent, unit_multiplier, reduce, error);
+        case kSIUnitOpRoot:
+            return SIUnitByTakingNthRootUncached(unit1, exponent, unit_multiplier, error);
+    }
+    return NULL;
+}
+static SIUnitRef SIUnitAlgebraCached(SIUnitAlgebraOp op, SIUnitRef unit1, SIUnitRef unit2, int exponent,
+                                     double *unit_multiplier, bool reduce, OCStringRef *error) {
+    if (error && *error) return NULL;
+    if (!unit1 || (!unit2 && (op == kSIUnitOpMultiply || op == kSIUnitOpDivide)))
+        return SIUnitAlgebraUncached(op, unit1, unit2, exponent, unit_multiplier, reduce, error);
+    // Make sure the library exists before the generation is sampled
+    if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
+    SIUnitAlgebraKey key;
+    memset(&key, 0, sizeof(key));  // padding takes part in the hash and comparison
+    key.unit1 = unit1;
+    key.unit2 = unit2;
+    key.exponent = exponent;
+    key.op = (uint8_t)op;
+    key.reduce = reduce;
+    bool unitIncoming = unit_multiplier && *unit_multiplier == 1.0;
+    uint64_t hash = SIUnitHashBytes((const char *)&key, sizeof(key));
+    SIUnitAlgebraCacheEntry *entry = SIUnitAlgebraCacheSlot(hash);
+    if (entry && memcmp(&entry->key, &key, sizeof(key)) == 0 && (entry->scales || unitIncoming)) {
+        algebraCacheHits++;
+        if (unit_multiplier) *unit_multiplier *= entry->factor;
+        return entry->result;
+    }
+    bool scales = op == kSIUnitOpDivide || (op == kSIUnitOpMultiply && !SIUnitAreEquivalentUnits(unit1, unit2));
+    if (!scales && !unitIncoming)
+        return SIUnitAlgebraUncached(op, unit1, unit2, exponent, unit_multiplier, reduce, error);
+    algebraCacheMisses++;
+    double factor = 1.0;
+    SIUnitRef result = SIUnitAlgebraUncached(op, unit1, unit2, exponent, &factor, reduce, error);
+    if (result && unit_multiplier) *unit_multiplier *= factor;
+    if (!result || (error && *error)) return result;
+    // Re-fetch: the operation may have registered a unit and moved the generation
+    entry = SIUnitAlgebraCacheSlot(hash);
+    if (entry) {
+        memcpy(&entry->key, &key, sizeof(key));
+        entry->result = result;
+        entry->factor = factor;
+        entry->scales = scales;
+    }
+    return result;
+}
 // Power operation
-static SIUnitRef SIUnitByRaisingToPowerInternal(SIUnitRef input,
+static SIUnitRef SIUnitByRaisingToPowerUncached(SIUnitRef input,
                                                 int power,
                                                 double *unit_multiplier,
                                                 bool reduce,
@@ -1539,7 +2803,7 @@ static SIUnitRef SIUnitByRaisingToPowerInternal(SIUnitRef input,
     return result;
 }
 // Multiplication operation
-static SIUnitRef SIUnitByMultiplyingInternal(SIUnitRef theUnit1,
+static SIUnitRef SIUnitByMultiplyingUncached(SIUnitRef theUnit1,
                                              SIUnitRef theUnit2,
                                              double *unit_multiplier,
                                              bool reduce,
@@ -1552,7 +2816,7 @@ static SIUnitRef SIUnitByMultiplyingInternal(SIUnitRef theUnit1,
     if (theUnit1 == dimless) return theUnit2;
     if (theUnit2 == dimless) return theUnit1;
     if (SIUnitAreEquivalentUnits(theUnit1, theUnit2)) {
-        return SIUnitByRaisingToPowerInternal(theUnit1, 2, unit_multiplier, reduce, error);
+        return SIUnitAlgebraCached(kSIUnitOpPower, theUnit1, NULL, 2, unit_multiplier, reduce, error);
     }
     // Compute new dimensionality
     SIDimensionalityRef dimensionality;
@@ -1593,8 +2857,6 @@ static SIUnitRef SIUnitByMultiplyingInternal(SIUnitRef theUnit1,
     SIUnitRef result = SIUnitWithParameters(dimensionality, NULL, NULL, simplified_symbol, scale);
     OCRelease(new_symbol);
     OCRelease(simplified_symbol);
-    // Ensure any parser state is cleared after arithmetic operations
-    siueClearParsedExpression();
     return result;
 }
 // Public API functions - now more intuitive with 'reduce' parameter
@@ -1602,21 +2864,21 @@ SIUnitRef SIUnitByRaisingToPowerWithoutReducing(SIUnitRef input,
                                                 int power,
                                                 double *unit_multiplier,
                                                 OCStringRef *error) {
-    SIUnitRef result = SIUnitByRaisingToPowerInternal(input, power, unit_multiplier, false, error);  // reduce = false
+    SIUnitRef result = SIUnitAlgebraCached(kSIUnitOpPower, input, NULL, power, unit_multiplier, false, error);  // reduce = false
     return result;
 }
 SIUnitRef SIUnitByRaisingToPower(SIUnitRef input,
                                  int power,
                                  double *unit_multiplier,
                                  OCStringRef *error) {
-    SIUnitRef result = SIUnitByRaisingToPowerInternal(input, power, unit_multiplier, true, error);  // reduce = true
+    SIUnitRef result = SIUnitAlgebraCached(kSIUnitOpPower, input, NULL, power, unit_multiplier, true, error);  // reduce = true
     return result;
 }
 SIUnitRef SIUnitByMultiplyingWithoutReducing(SIUnitRef theUnit1,
                                              SIUnitRef theUnit2,
                                              double *unit_multiplier,
                                              OCStringRef *error) {
-    SIUnitRef result = SIUnitByMultiplyingInternal(theUnit1, theUnit2, unit_multiplier, false, error);  // reduce = false
+    SIUnitRef result = SIUnitAlgebraCached(kSIUnitOpMultiply, theUnit1, theUnit2, 0, unit_multiplier, false, error);  // reduce = false
     if (result) {
     }
     return result;
@@ -1625,13 +2887,13 @@ SIUnitRef SIUnitByMultiplying(SIUnitRef theUnit1,
                               SIUnitRef theUnit2,
                               double *unit_multiplier,
                               OCStringRef *error) {
-    SIUnitRef result = SIUnitByMultiplyingInternal(theUnit1, theUnit2, unit_multiplier, true, error);  // reduce = true
+    SIUnitRef result = SIUnitAlgebraCached(kSIUnitOpMultiply, theUnit1, theUnit2, 0, unit_multiplier, true, error);  // reduce = true
     if (result) {
     }
     return result;
 }
 // Division operation
-static SIUnitRef SIUnitByDividingInternal(SIUnitRef theUnit1,
+static SIUnitRef SIUnitByDividingUncached(SIUnitRef theUnit1,
                                           SIUnitRef theUnit2,
                                           double *unit_multiplier,
                                           bool reduce,
@@ -1687,7 +2949,7 @@ SIUnitRef SIUnitByDividingWithoutReducing(SIUnitRef theUnit1,
                                           SIUnitRef theUnit2,
                                           double *unit_multiplier,
                                           OCStringRef *error) {
-    SIUnitRef result = SIUnitByDividingInternal(theUnit1, theUnit2, unit_multiplier, false, error);  // reduce = false
+    SIUnitRef result = SIUnitAlgebraCached(kSIUnitOpDivide, theUnit1, theUnit2, 0, unit_multiplier, false, error);  // reduce = false
     if (result) {
     }
     return result;
@@ -1696,16 +2958,16 @@ SIUnitRef SIUnitByDividing(SIUnitRef theUnit1,
                            SIUnitRef theUnit2,
                            double *unit_multiplier,
                            OCStringRef *error) {
-    SIUnitRef result = SIUnitByDividingInternal(theUnit1, theUnit2, unit_multiplier, true, error);  // reduce = true
+    SIUnitRef result = SIUnitAlgebraCached(kSIUnitOpDivide, theUnit1, theUnit2, 0, unit_multiplier, true, error);  // reduce = true
     if (result) {
     }
     return result;
 }
 // Nth root operation
-SIUnitRef SIUnitByTakingNthRoot(SIUnitRef theUnit,
-                                int root,
-                                double *unit_multiplier,
-                                OCStringRef *error) {
+static SIUnitRef SIUnitByTakingNthRootUncached(SIUnitRef theUnit,
+                                               int root,
+                                               double *unit_multiplier,
+                                               OCStringRef *error) {
     if (error && *error) return NULL;
     IF_NO_OBJECT_EXISTS_RETURN(theUnit, NULL);
     if (root == 0) {
@@ -1754,6 +3016,12 @@ SIUnitRef SIUnitByTakingNthRoot(SIUnitRef theUnit,
     OCRelease(simplified_symbol);
     return result;
 }
+SIUnitRef SIUnitByTakingNthRoot(SIUnitRef theUnit,
+                                int root,
+                                double *unit_multiplier,
+                                OCStringRef *error) {
+    return SIUnitAlgebraCached(kSIUnitOpRoot, theUnit, NULL, root, unit_multiplier, false, error);
+}
 OCStringRef SIUnitCreateQuantityNameGuess(SIUnitRef theUnit) {
     OCStringRef quantityName = NULL;
     OCArrayRef quantityNames = SIDimensionalityCreateArrayOfQuantityNames(theUnit->dimensionality);
@@ -1767,8 +3035,125 @@ OCStringRef SIUnitCreateQuantityNameGuess(SIUnitRef theUnit) {
         return SIDimensionalityCopySymbol(theUnit->dimensionality);
     }
 }
+#pragma mark Expression Cache
+// Bounded, direct-mapped cache in front of SIUnitFromExpression, keyed on the
+// raw expression bytes.  Entries hold borrowed pointers to library units,
+// which are static instances, and are dropped wholesale whenever
+// unitLibraryGeneration moves.  Build with SITYPES_THREAD_LOCAL_CACHE to give
+// each thread its own cache, freed when the thread exits.  Clearing bumps
+// expressionCacheEpoch, which every thread's table is checked against, so a
+// clear on one thread empties them all.
+#ifndef SIUNIT_EXPRESSION_CACHE_SIZE
+#define SIUNIT_EXPRESSION_CACHE_SIZE 4096  // must be a power of two
+#endif
+typedef struct {
+    char *expression;  // malloc'd copy of the raw UTF-8 bytes, NULL if slot empty
+    size_t length;
+    uint64_t hash;
+    SIUnitRef unit;
+    double multiplier;
+} SIUnitExpressionCacheEntry;
+SI_CACHE_STORAGE SIUnitExpressionCacheEntry *expressionCache = NULL;
+SI_CACHE_STORAGE uint64_t expressionCacheGeneration = 0;
+SI_CACHE_STORAGE uint64_t expressionCacheEpochSeen = 0;
+SI_CACHE_STORAGE uint64_t expressionCacheHits = 0;
+SI_CACHE_STORAGE uint64_t expressionCacheMisses = 0;
+static SICacheEpoch expressionCacheEpoch = 0;
+static uint64_t SIUnitHashBytes(const char *bytes, size_t length) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+static void SIUnitExpressionCacheFlushEntries(void) {
+    if (!expressionCache) return;
+    for (size_t i = 0; i < SIUNIT_EXPRESSION_CACHE_SIZE; i++) {
+        free(expressionCache[i].expression);
+        expressionCache[i].expression = NULL;
+        expressionCache[i].unit = NULL;
+    }
+}
+static SIUnitExpressionCacheEntry *SIUnitExpressionCacheSlot(uint64_t hash) {
+    if (!expressionCache) {
+        expressionCache = calloc(SIUNIT_EXPRESSION_CACHE_SIZE, sizeof(SIUnitExpressionCacheEntry));
+        if (!expressionCache) return NULL;
+        SIUnitCacheRegisterThread();
+        expressionCacheGeneration = unitLibraryGeneration;
+        expressionCacheEpochSeen = SICacheEpochLoad(expressionCacheEpoch);
+    }
+    if (expressionCacheGeneration != unitLibraryGeneration || expressionCacheEpochSeen != SICacheEpochLoad(expressionCacheEpoch)) {
+        SIUnitExpressionCacheFlushEntries();
+        expressionCacheGeneration = unitLibraryGeneration;
+        expressionCacheEpochSeen = SICacheEpochLoad(expressionCacheEpoch);
+    }
+    return &expressionCache[hash & (SIUNIT_EXPRESSION_CACHE_SIZE - 1)];
+}
+// Frees the calling thread's table.  The counters are left alone.
+static void SIUnitExpressionCacheRelease(void) {
+    SIUnitExpressionCacheFlushEntries();
+    free(expressionCache);
+    expressionCache = NULL;
+}
+void SIUnitExpressionCacheClear(void) {
+    SIUnitExpressionCacheRelease();
+    SICacheEpochBump(expressionCacheEpoch);
+    expressionCacheHits = 0;
+    expressionCacheMisses = 0;
+}
+void SIUnitExpressionCacheGetStatistics(uint64_t *hits, uint64_t *misses) {
+    if (hits) *hits = expressionCacheHits;
+    if (misses) *misses = expressionCacheMisses;
+}
+#ifdef SITYPES_THREAD_LOCAL_CACHE
+static void SIUnitCachesReleaseThread(void *unused) {
+    (void)unused;
+    SIUnitExpressionCacheRelease();
+    free(algebraCache);
+    algebraCache = NULL;
+}
+#endif
+static SIUnitRef SIUnitFromExpressionUncached(OCStringRef expression, double *unit_multiplier, OCStringRef *error);
 SIUnitRef SIUnitFromExpression(OCStringRef expression, double *unit_multiplier, OCStringRef *error) {
     if (error && *error) return NULL;
+    const char *bytes = expression ? OCStringGetCString(expression) : NULL;
+    if (!bytes) return SIUnitFromExpressionUncached(expression, unit_multiplier, error);
+    // Make sure the library exists before the generation is sampled
+    if (NULL == unitsDictionaryLibrary) SIUnitCreateLibraries();
+    size_t length = strlen(bytes);
+    uint64_t hash = SIUnitHashBytes(bytes, length);
+    SIUnitExpressionCacheEntry *entry = SIUnitExpressionCacheSlot(hash);
+    if (entry && entry->expression && entry->hash == hash && entry->length == length &&
+        memcmp(entry->expression, bytes, length) == 0) {
+        expressionCacheHits++;
+        if (unit_multiplier) *unit_multiplier = entry->multiplier;
+        return entry->unit;
+    }
+    expressionCacheMisses++;
+    double multiplier = 1.0;
+    SIUnitRef unit = SIUnitFromExpressionUncached(expression, &multiplier, error);
+    if (!unit) return NULL;
+    if (unit_multiplier) *unit_multiplier = multiplier;
+    // Resolving may have registered a new unit; re-fetch the slot so a stale
+    // generation is flushed before this result is stored.
+    entry = SIUnitExpressionCacheSlot(hash);
+    if (entry) {
+        char *copy = malloc(length + 1);
+        if (copy) {
+            memcpy(copy, bytes, length + 1);
+            free(entry->expression);
+            entry->expression = copy;
+            entry->length = length;
+            entry->hash = hash;
+            entry->unit = unit;
+            entry->multiplier = multiplier;
+        }
+    }
+    return unit;
+}
+static SIUnitRef SIUnitFromExpressionUncached(OCStringRef expression, double *unit_multiplier, OCStringRef *error) {
     OCMutableDictionaryRef unitsLib = SIUnitGetUnitsDictionaryLib();
     IF_NO_OBJECT_EXISTS_RETURN(unitsLib, NULL);
     if (!unitsLib) {
@@ -1785,15 +3170,29 @@ SIUnitRef SIUnitFromExpression(OCStringRef expression, double *unit_multiplier,
         if (unit_multiplier) *unit_multiplier = 1.0;
         return SIUnitDimensionlessAndUnderived();
     }
-    // Try library lookup first
-    OCStringRef key = SIUnitCreateCleanedExpression(expression);
+    // Try library lookup first, directly for plain token symbols
+    SIUnitRef unit = SIUnitLookupUnderivedSymbol(expression);
+    if (unit) {
+        if (unit_multiplier) *unit_multiplier = 1.0;
+        return unit;
+    }
+    SIUnitCanonicalParse parse;
+    siueCanonicalParseInit(&parse, expression);
+    unit = SIUnitCanonicalIndexLookup(&parse);
+    if (unit) {
+        siueCanonicalParseDestroy(&parse);
+        if (unit_multiplier) *unit_multiplier = 1.0;
+        return unit;
+    }
+    OCStringRef key = siueCanonicalParseCreateCleanedExpression(&parse);
+    siueCanonicalParseDestroy(&parse);
     if (NULL == key) {
         if (error) {
             *error = OCStringCreateWithFormat(STR("Invalid unit expression: %@"), expression);
         }
         return NULL;
     }
-    SIUnitRef unit = OCDictionaryGetValue(unitsDictionaryLibrary, key);
+    unit = OCDictionaryGetValue(unitsDictionaryLibrary, key);
     if (unit) {
         if (unit_multiplier) *unit_multiplier = 1.0;
         OCRelease(key);
@@ -41,15 +41,15 @@
  *   (e.g., US vs. UK volume units).
  *
  * ## Usage Notes
- * - **Immutability:** All SIUnit objects are immutable and may be safely shared
- *   between threads.
+ * - **Immutability:** SIUnit objects are never modified once registered.
  * - **Memory Management:** Functions with `Create` or `Copy` in the name return
  *   new OCType objects. **Ownership of these objects is transferred to the caller,**
  *   who must call `OCRelease` when the object is no longer needed.
  *   All other functions return non-owned references unless otherwise stated.
  * - **Pointer Safety:** All pointer arguments must be non-NULL unless documented.
- * - **Thread Safety:** All functions are thread-safe when operating on distinct units
- *   or library objects.
+ * - **Thread Safety:** Not thread-safe.  Parsing, lookup and unit algebra read and fill
+ *   process-wide indexes and memo caches without locking, so calls from several threads
+ *   must be serialized by the caller.
  * - **Intended Use:** This interface is designed for scientific, engineering, or
  *   educational software requiring precise, robust, and extensible unit handling.
  *
@@ -170,12 +170,112 @@ bool SIUnitIsCoherentUnit(SIUnitRef theUnit);
 bool SIUnitIsDimensionless(SIUnitRef theUnit);
 // Unit conversion
 double SIUnitConversion(SIUnitRef initialUnit, SIUnitRef finalUnit);
+/**
+ * @brief Returns the zero offset of an absolute (affine) unit, in that unit.
+ *
+ * A value v in the unit is (v + offset) * scale in the coherent SI unit.
+ * The offset is 273.15 for °C, 459.67 for °F and 0 for every other unit.
+ */
+double SIUnitGetOffsetToCoherentSI(SIUnitRef theUnit);
+/** @brief Returns true if the unit is an absolute scale with a nonzero offset, such as °C or °F. */
+bool SIUnitIsAffine(SIUnitRef theUnit);
+/**
+ * @brief Computes the affine map final = initial * scale + offset between two units.
+ *
+ * SIUnitConversion gives only the scale, which is right for differences
+ * (intervals) but not for absolute readings on offset scales like °C or °F.
+ *
+ * @param initialUnit The unit converted from.
+ * @param finalUnit The unit converted to.
+ * @param scale Receives the multiplicative factor (may be NULL).
+ * @param offset Receives the additive offset, in finalUnit (may be NULL).
+ * @return false if the units have different reduced dimensionalities.
+ */
+bool SIUnitAffineConversion(SIUnitRef initialUnit, SIUnitRef finalUnit, double *scale, double *offset);
+/**
+ * @brief Converts a contiguous buffer of values from one unit to another.
+ *
+ * Dimensionality is checked and the conversion factor computed once for the
+ * whole buffer.  Results are identical to calling SIScalarConvertToUnit on
+ * each element.
+ *
+ * @param fromUnit The unit of the input values.
+ * @param toUnit The unit of the output values; must share the reduced dimensionality of fromUnit.
+ * @param type The numeric type of both buffers.
+ * @param input The input elements.
+ * @param output The output elements; may equal input for in-place conversion, must not otherwise overlap it.
+ * @param count Number of elements (a complex element counts once).
+ * @param outError Optional pointer to receive an error message.
+ * @return true on success.
+ */
+bool SIUnitConvertBuffer(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type, const void *input, void *output, size_t count, OCStringRef *outError);
+/**
+ * @brief Strided variant of SIUnitConvertBuffer.
+ *
+ * Strides are measured in elements, so a stride of 1 is contiguous.  Input and
+ * output may be the same buffer with the same stride.
+ */
+bool SIUnitConvertBufferStrided(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type,
+                                const void *input, size_t inputStride,
+                                void *output, size_t outputStride,
+                                size_t count, OCStringRef *outError);
+/**
+ * @brief Converts a buffer of absolute readings, applying the zero offsets of affine units.
+ *
+ * Identical to SIUnitConvertBuffer unless an offset is involved, e.g. °F to K
+ * or °C.  Offset conversions accept only real numeric types.
+ */
+bool SIUnitConvertAbsoluteBuffer(SIUnitRef fromUnit, SIUnitRef toUnit, SINumberType type, const void *input, void *output, size_t count, OCStringRef *outError);
+// Conversion plans
+/**
+ * @brief Returns the unique type identifier for SIUnitConversionPlan objects.
+ *
+ * A conversion plan is an immutable, precomputed conversion between two units.
+ * Creating a plan checks dimensionality and computes the scale (and offset)
+ * once; applying it is pure arithmetic that never touches the unit library,
+ * so plans can be hoisted out of per-sample loops.
+ */
+OCTypeID SIUnitConversionPlanGetTypeID(void);
+/**
+ * @brief Creates a scale-only plan, matching SIScalarConvertToUnit.
+ * @param fromUnit The unit converted from.
+ * @param toUnit The unit converted to; must share the reduced dimensionality of fromUnit.
+ * @param error Optional pointer to receive an error message.
+ * @return A new plan (caller owns), or NULL on failure.
+ */
+SIUnitConversionPlanRef SIUnitConversionPlanCreate(SIUnitRef fromUnit, SIUnitRef toUnit, OCStringRef *error);
+/** @brief Creates a plan for absolute readings that also applies the offsets of affine units such as °C and °F. */
+SIUnitConversionPlanRef SIUnitConversionPlanCreateAbsolute(SIUnitRef fromUnit, SIUnitRef toUnit, OCStringRef *error);
+/** @brief Converts a plan to a typed or untyped cJSON representation. */
+cJSON *SIUnitConversionPlanCopyAsJSON(SIUnitConversionPlanRef plan, bool typed, OCStringRef *outError);
+/** @brief Creates a plan from the JSON produced by SIUnitConversionPlanCopyAsJSON. */
+SIUnitConversionPlanRef SIUnitConversionPlanCreateFromJSON(cJSON *json, OCStringRef *outError);
+/** @brief Returns the unit the plan converts from. */
+SIUnitRef SIUnitConversionPlanGetFromUnit(SIUnitConversionPlanRef plan);
+/** @brief Returns the unit the plan converts to. */
+SIUnitRef SIUnitConversionPlanGetToUnit(SIUnitConversionPlanRef plan);
+/** @brief Returns the multiplicative factor of the plan. */
+double SIUnitConversionPlanGetScale(SIUnitConversionPlanRef plan);
+/** @brief Returns the additive offset of the plan, in the target unit (0 unless absolute). */
+double SIUnitConversionPlanGetOffset(SIUnitConversionPlanRef plan);
+/** @brief Returns true if the plan was created with SIUnitConversionPlanCreateAbsolute. */
+bool SIUnitConversionPlanIsAbsolute(SIUnitConversionPlanRef plan);
+/** @brief Applies the plan to a single real value. The plan must be non-NULL. */
+double SIUnitConversionPlanApplyToDouble(SIUnitConversionPlanRef plan, double value);
+/**
+ * @brief Applies the plan to a buffer, in place (input == output) or out of place.
+ *
+ * Complex buffers are accepted unless the plan has a nonzero offset.
+ */
+bool SIUnitConversionPlanApplyToBuffer(SIUnitConversionPlanRef plan, SINumberType type, const void *input, void *output, size_t count, OCStringRef *outError);
 // Unit library management
 void SIUnitLibrarySetDefaultVolumeSystem(SIVolumeSystem system);
 SIVolumeSystem SIUnitLibraryGetDefaultVolumeSystem(void);
 void SIUnitLibrarySetImperialVolumes(bool value);  // For backward compatibility
 bool SIUnitLibraryGetImperialVolumes(void);
 void SIUnitLibrariesShutdown(void);  // do not call, called by SITypesShutdown()
+/** @brief Writes the unit library as CSV, the input to SIUnitRegistry.py. */
+bool SIUnitLibraryDumpCSV(const char *csvPath);
 // Array creation functions
 OCArrayRef SIUnitCreateArrayOfUnitsForQuantity(OCStringRef quantity);
 OCArrayRef SIUnitCreateArrayOfUnitsForDimensionality(SIDimensionalityRef theDim);
@@ -183,8 +283,15 @@ OCArrayRef SIUnitCreateArrayOfUnitsForSameReducedDimensionality(SIDimensionality
 OCArrayRef SIUnitCreateArrayOfConversionUnits(SIUnitRef theUnit);
 OCArrayRef SIUnitCreateArrayOfEquivalentUnits(SIUnitRef theUnit);
 OCMutableArrayRef SIUnitGetTokenSymbolsLib(void);
+/** @brief Returns true if symbol is an underived token unit symbol (hashed lookup). */
+bool SIUnitIsTokenSymbol(OCStringRef symbol);
+/** @brief Returns the token ID of a token unit symbol, its index in SIUnitGetTokenSymbolsLib(), or kOCNotFound. */
+OCIndex SIUnitGetTokenSymbolIndex(OCStringRef symbol);
 SIUnitRef SIUnitWithSymbol(OCStringRef symbol);
+/** @brief Returns the unit whose name or plural name equals input (hashed lookup). */
 SIUnitRef SIUnitFindWithName(OCStringRef input);
+/** @brief Like SIUnitFindWithName, but falls back to a case-insensitive match. */
+SIUnitRef SIUnitFindWithNameIgnoringCase(OCStringRef input);
 SIUnitRef SIUnitFindEquivalentUnitWithShortestSymbol(SIUnitRef theUnit);
 // Unit reduction operations
 SIUnitRef SIUnitByReducing(SIUnitRef theUnit, double *unit_multiplier);
@@ -223,9 +330,22 @@ SIUnitRef SIUnitByTakingNthRoot(SIUnitRef theUnit,
                                 double *unit_multiplier,
                                 OCStringRef *error);
 SIUnitRef SIUnitFromExpression(OCStringRef expression, double *unit_multiplier, OCStringRef *error);
+/** @brief Reports hit and miss counts for the SIUnitFromExpression cache (per thread with SITYPES_THREAD_LOCAL_CACHE). */
+void SIUnitExpressionCacheGetStatistics(uint64_t *hits, uint64_t *misses);
+/** @brief Empties the SIUnitFromExpression cache on every thread and resets the calling thread's counters. */
+void SIUnitExpressionCacheClear(void);
+/** @brief Reports hit and miss counts for the token-ID index behind SIUnitWithSymbol and coherent-unit lookups. */
+void SIUnitCanonicalIndexGetStatistics(uint64_t *hits, uint64_t *misses);
+/** @brief Reports hit and miss counts for the multiply/divide/power/root memo cache. */
+void SIUnitAlgebraCacheGetStatistics(uint64_t *hits, uint64_t *misses);
+/** @brief Empties the unit algebra memo cache on every thread and resets the calling thread's counters. */
+void SIUnitAlgebraCacheClear(void);
 /*!
- * @brief Temporary normalization function for existing parser compatibility.
- * TODO: Implement proper Unicode normalization
+ * @brief Rewrites a unit expression into the parser's ASCII operator forms.
+ *
+ * Trims surrounding whitespace, maps ×, ·, •, ⋅, ∙ to *, ÷, ∕, ⁄ to /, Greek
+ * mu to the micro sign and superscript powers (including ⁻) to ^n, then drops
+ * the spaces in " * ", " / " and " ^ ".  Runs as one scan over the UTF-8 text.
  */
 OCMutableStringRef SIUnitCreateNormalizedExpression(OCStringRef expression);
 /*!
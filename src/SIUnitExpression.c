@@ -17,174 +17,123 @@
 #include <stdlib.h>
 #include <string.h>
 #include "SIUnitExpressionParser.tab.h"
-// External lex/yacc parser functions (siue prefix for namespace isolation)
-extern int siueparse(void);
+// External reentrant lex/yacc parser functions (siue prefix for namespace isolation)
 typedef struct yy_buffer_state *YY_BUFFER_STATE;
-extern YY_BUFFER_STATE siue_scan_string(const char *str);
-extern void siue_delete_buffer(YY_BUFFER_STATE buffer);
-extern int siuelex_destroy(void);  // Complete lexer state cleanup
-// Forward declarations for power operations and expression processing
-OCArrayRef siueApplyPowerToTermList(OCArrayRef term_list, int power);
-SIUnitExpression *siueApplyPowerToExpression(SIUnitExpression *expression, int power);
-SIUnitExpression *siueApplyFractionalPowerToExpression(SIUnitExpression *expression, double power);
-// Global error state for parser communication
-OCStringRef siueError = NULL;
+extern int siuelex_init_extra(SIUnitExpressionParseContext *ctx, void **scanner);
+extern YY_BUFFER_STATE siue_scan_string(const char *str, void *scanner);
+extern void siue_delete_buffer(YY_BUFFER_STATE buffer, void *scanner);
+extern int siuelex_destroy(void *scanner);
 #pragma mark - Term Management
 /**
- * Creates a new term with unit symbol and power.
- * Used as building block for expression parsing (e.g., "m" with power 2 for "m^2").
+ * Resolves a scanned symbol to the token library's own string and token ID.
+ * Terms carry these instead of a private copy of the symbol.
  */
-SIUnitTerm *siueCreateTerm(OCStringRef symbol, int power) {
-    if (!symbol) return NULL;
-    SIUnitTerm *term = malloc(sizeof(SIUnitTerm));
-    if (!term) return NULL;
-    term->symbol = OCStringCreateCopy(symbol);
-    term->power = power;
-    return term;
+bool siueLookupTokenSymbol(const char *text, SIUnitTerm *term) {
+    if (!text || !term) return false;
+    OCStringRef symbol = OCStringCreateWithCString(text);
+    if (!symbol) return false;
+    OCIndex token = SIUnitGetTokenSymbolIndex(symbol);
+    OCRelease(symbol);
+    if (token == kOCNotFound) return false;
+    term->symbol = OCArrayGetValueAtIndex(SIUnitGetTokenSymbolsLib(), token);
+    term->token = (int32_t)token;
+    term->power = 1;
+    return true;
 }
-/**
- * Creates deep copy of a term for array manipulation.
- */
-SIUnitTerm *siueCopyTerm(const SIUnitTerm *term) {
-    if (!term) return NULL;
-    return siueCreateTerm(term->symbol, term->power);
+void siueTermListInit(SIUnitTermList *list) {
+    if (!list) return;
+    list->spill = NULL;
+    list->count = 0;
+    list->capacity = SIUE_INLINE_TERMS;
+}
+SIUnitTerm *siueTermListGetTerms(SIUnitTermList *list) {
+    return list->spill ? list->spill : list->inlineTerms;
 }
 /**
- * Releases term memory and symbol reference.
+ * Appends a term.  A full list moves to an arena buffer of twice the
+ * capacity; the abandoned storage is reclaimed with the arena.
  */
-void siueReleaseTerm(SIUnitTerm *term) {
-    if (!term) return;
-    if (term->symbol) {
-        OCRelease(term->symbol);
+bool siueTermListAppend(SIArena *arena, SIUnitTermList *list, SIUnitTerm term) {
+    if (!list) return false;
+    if (list->count == list->capacity) {
+        uint32_t capacity = 2 * list->capacity;
+        SIUnitTerm *spill = SIArenaAlloc(arena, capacity * sizeof(SIUnitTerm));
+        if (!spill) return false;
+        memcpy(spill, siueTermListGetTerms(list), list->count * sizeof(SIUnitTerm));
+        list->spill = spill;
+        list->capacity = capacity;
+    }
+    siueTermListGetTerms(list)[list->count++] = term;
+    return true;
+}
+bool siueTermListAppendList(SIArena *arena, SIUnitTermList *list, const SIUnitTermList *other) {
+    if (!other) return true;
+    const SIUnitTerm *terms = other->spill ? other->spill : other->inlineTerms;
+    for (uint32_t i = 0; i < other->count; i++) {
+        if (!siueTermListAppend(arena, list, terms[i])) return false;
     }
-    free(term);
+    return true;
+}
+SIUnitTermList *siueCreateTermList(SIArena *arena, SIUnitTerm term) {
+    SIUnitTermList *list = SIArenaAlloc(arena, sizeof(SIUnitTermList));
+    if (!list) return NULL;
+    siueTermListInit(list);
+    siueTermListAppend(arena, list, term);
+    return list;
 }
 #pragma mark - Expression Management
 /**
- * Creates expression with numerator and denominator term arrays.
- * Performs deep copy of all terms to ensure memory safety.
+ * Creates expression with numerator and denominator terms.
+ * Copies the terms, so the source lists may be reused or discarded.
  */
-SIUnitExpression *siueCreateExpression(OCArrayRef numerator, OCArrayRef denominator) {
-    if (!numerator) return NULL;
-    SIUnitExpression *expr = malloc(sizeof(SIUnitExpression));
+SIUnitExpression *siueCreateExpression(SIArena *arena, const SIUnitTermList *numerator, const SIUnitTermList *denominator) {
+    SIUnitExpression *expr = SIArenaAlloc(arena, sizeof(SIUnitExpression));
     if (!expr) return NULL;
-    // Deep copy numerator terms
-    OCIndex count = OCArrayGetCount(numerator);
-    OCMutableArrayRef numCopy = OCArrayCreateMutable(count, NULL);
-    if (!numCopy) {
-        free(expr);
+    siueTermListInit(&expr->numerator);
+    siueTermListInit(&expr->denominator);
+    if (!siueTermListAppendList(arena, &expr->numerator, numerator) ||
+        !siueTermListAppendList(arena, &expr->denominator, denominator))
         return NULL;
-    }
-    for (OCIndex i = 0; i < count; i++) {
-        SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(numerator, i);
-        SIUnitTerm *termCopy = siueCopyTerm(term);
-        if (termCopy) {
-            if (!OCArrayAppendValue(numCopy, termCopy)) {
-                // Append failed - clean up termCopy and abort
-                siueReleaseTerm(termCopy);
-                // Clean up any terms already in numCopy
-                siueReleaseTermArray(numCopy);
-                OCRelease(numCopy);
-                free(expr);
-                return NULL;
-            }
-        }
-    }
-    expr->numerator = numCopy;
-    // Deep copy denominator terms if present
-    if (denominator) {
-        count = OCArrayGetCount(denominator);
-        OCMutableArrayRef denCopy = OCArrayCreateMutable(count, NULL);
-        if (!denCopy) {
-            // Clean up numerator array and expression
-            siueReleaseTermArray(numCopy);
-            OCRelease(numCopy);
-            free(expr);
-            return NULL;
-        }
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(denominator, i);
-            SIUnitTerm *termCopy = siueCopyTerm(term);
-            if (termCopy) {
-                if (!OCArrayAppendValue(denCopy, termCopy)) {
-                    // Append failed - clean up termCopy and abort
-                    siueReleaseTerm(termCopy);
-                    // Clean up denominator terms already added
-                    siueReleaseTermArray(denCopy);
-                    OCRelease(denCopy);
-                    // Clean up numerator array
-                    siueReleaseTermArray(numCopy);
-                    OCRelease(numCopy);
-                    free(expr);
-                    return NULL;
-                }
-            }
-        }
-        expr->denominator = denCopy;
-    } else {
-        expr->denominator = NULL;
-    }
     return expr;
 }
 /**
- * Creates deep copy of entire expression.
+ * Creates copy of entire expression.
  */
-SIUnitExpression *siueCopyExpression(const SIUnitExpression *expr) {
+SIUnitExpression *siueCopyExpression(SIArena *arena, const SIUnitExpression *expr) {
     if (!expr) return NULL;
-    return siueCreateExpression(expr->numerator, expr->denominator);
+    return siueCreateExpression(arena, &expr->numerator, &expr->denominator);
 }
+#pragma mark - Parser Helper Functions
 /**
- * Releases expression and all contained terms.
- * Ensures complete cleanup to prevent memory leaks.
+ * Applies integer power to all terms in list.
+ * Used for parenthetical expressions like (m*kg)^2.
  */
-void siueRelease(SIUnitExpression *expr) {
-    if (!expr) return;
-    // Release all numerator terms
-    if (expr->numerator) {
-        OCIndex count = OCArrayGetCount(expr->numerator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expr->numerator, i);
-            siueReleaseTerm(term);
-        }
-        OCRelease(expr->numerator);
-    }
-    // Release all denominator terms
-    if (expr->denominator) {
-        OCIndex count = OCArrayGetCount(expr->denominator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expr->denominator, i);
-            siueReleaseTerm(term);
-        }
-        OCRelease(expr->denominator);
-    }
-    free(expr);
+SIUnitTermList *siueApplyPowerToTermList(SIUnitTermList *term_list, int power) {
+    if (!term_list || power == 0) return term_list;
+    SIUnitTerm *terms = siueTermListGetTerms(term_list);
+    for (uint32_t i = 0; i < term_list->count; i++) terms[i].power *= power;
+    return term_list;
 }
-/**
- * Utility function to release array of terms.
- */
-void siueReleaseTermArray(OCArrayRef term_array) {
-    if (!term_array) return;
-    OCIndex count = OCArrayGetCount(term_array);
-    for (OCIndex i = 0; i < count; i++) {
-        SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(term_array, i);
-        siueReleaseTerm(term);
-    }
-    OCRelease(term_array);
+// True when every power in the list stays an integer under a fractional power
+static bool siueTermListAcceptsFractionalPower(SIUnitTermList *term_list, double power) {
+    SIUnitTerm *terms = siueTermListGetTerms(term_list);
+    for (uint32_t i = 0; i < term_list->count; i++) {
+        double resultPower = terms[i].power * power;
+        if (fabs(resultPower - round(resultPower)) > 1e-10) return false;
+    }
+    return true;
+}
+static void siueTermListScaleByFractionalPower(SIUnitTermList *term_list, double power) {
+    SIUnitTerm *terms = siueTermListGetTerms(term_list);
+    for (uint32_t i = 0; i < term_list->count; i++) terms[i].power = (int)round(terms[i].power * power);
 }
-#pragma mark - Parser Helper Functions
 /**
- * Applies integer power to all terms in array.
- * Used for parenthetical expressions like (m*kg)^2.
+ * Validates and applies fractional power to a term list.
+ * Returns NULL if any resulting power would be fractional.
  */
-OCArrayRef siueApplyPowerToTermList(OCArrayRef term_list, int power) {
-    if (!term_list || power == 0) return term_list;
-    OCIndex count = OCArrayGetCount(term_list);
-    for (OCIndex i = 0; i < count; i++) {
-        SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(term_list, i);
-        if (term) {
-            term->power *= power;
-        }
-    }
+SIUnitTermList *siueApplyFractionalPowerToTermList(SIUnitTermList *term_list, double power) {
+    if (!term_list || !siueTermListAcceptsFractionalPower(term_list, power)) return NULL;
+    siueTermListScaleByFractionalPower(term_list, power);
     return term_list;
 }
 /**
@@ -194,20 +143,14 @@ OCArrayRef siueApplyPowerToTermList(OCArrayRef term_list, int power) {
 SIUnitExpression *siueApplyPowerToExpression(SIUnitExpression *expression, int power) {
     if (!expression || power == 0) return expression;
     if (power < 0) {
-        // Swap numerator and denominator for negative powers
-        OCArrayRef oldNumerator = expression->numerator;
-        OCArrayRef oldDenominator = expression->denominator;
-        expression->numerator = oldDenominator;
+        // Swap numerator and denominator for negative powers; spilled storage lives in the arena, so the lists move as values
+        SIUnitTermList oldNumerator = expression->numerator;
+        expression->numerator = expression->denominator;
         expression->denominator = oldNumerator;
         power = -power;  // Apply positive power after swap
     }
-    // Apply power to both numerator and denominator
-    if (expression->numerator) {
-        siueApplyPowerToTermList(expression->numerator, power);
-    }
-    if (expression->denominator) {
-        siueApplyPowerToTermList(expression->denominator, power);
-    }
+    siueApplyPowerToTermList(&expression->numerator, power);
+    siueApplyPowerToTermList(&expression->denominator, power);
     return expression;
 }
 /**
@@ -217,210 +160,116 @@ SIUnitExpression *siueApplyPowerToExpression(SIUnitExpression *expression, int p
  */
 SIUnitExpression *siueApplyFractionalPowerToExpression(SIUnitExpression *expression, double power) {
     if (!expression) return NULL;
-    // Validate that fractional power would yield integer results for all terms
-    if (expression->numerator) {
-        OCIndex count = OCArrayGetCount(expression->numerator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expression->numerator, i);
-            if (term) {
-                double resultPower = term->power * power;
-                if (fabs(resultPower - round(resultPower)) > 1e-10) {
-                    return NULL;  // Would result in fractional power - forbidden
-                }
-            }
-        }
-    }
-    // Check denominator terms
-    if (expression->denominator) {
-        OCIndex count = OCArrayGetCount(expression->denominator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expression->denominator, i);
-            if (term) {
-                double resultPower = term->power * power;
-                if (fabs(resultPower - round(resultPower)) > 1e-10) {
-                    return NULL;  // Would result in fractional power - forbidden
-                }
-            }
-        }
-    }
-    // All powers would be integers - apply the fractional power
-    if (expression->numerator) {
-        OCIndex count = OCArrayGetCount(expression->numerator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expression->numerator, i);
-            if (term) {
-                term->power = (int)round(term->power * power);
-            }
-        }
-    }
-    if (expression->denominator) {
-        OCIndex count = OCArrayGetCount(expression->denominator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expression->denominator, i);
-            if (term) {
-                term->power = (int)round(term->power * power);
-            }
-        }
-    }
+    if (!siueTermListAcceptsFractionalPower(&expression->numerator, power) ||
+        !siueTermListAcceptsFractionalPower(&expression->denominator, power))
+        return NULL;  // Would result in fractional power - forbidden
+    siueTermListScaleByFractionalPower(&expression->numerator, power);
+    siueTermListScaleByFractionalPower(&expression->denominator, power);
     return expression;
 }
 #pragma mark - Processing Functions
+// Alphabetical order of terms; identical symbols share a token ID
+static int siueCompareTerms(const SIUnitTerm *term1, const SIUnitTerm *term2) {
+    if (term1->token == term2->token) return 0;
+    return OCStringCompare(term1->symbol, term2->symbol, 0);
+}
+// Removes terms with zero power, keeping the order of the rest
+static void siueRemoveZeroPowerTerms(SIUnitTermList *list) {
+    SIUnitTerm *terms = siueTermListGetTerms(list);
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (terms[i].power != 0) terms[kept++] = terms[i];
+    }
+    list->count = kept;
+}
 /**
- * Groups identical symbols by combining their powers.
- * Implements power consolidation: m*m*kg → kg•m^2.
- * Removes terms with zero power after consolidation.
+ * Sorts and groups in one insertion pass: m*m*kg → kg•m^2.
+ * Implements the alphabetical ordering requirement and power consolidation,
+ * then removes terms with zero power.
  */
-void siueGroupIdenticalTerms(OCMutableArrayRef terms) {
-    if (!terms) return;
-    OCIndex count = OCArrayGetCount(terms);
-    // Combine powers for identical symbols
-    if (count > 1) {
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term1 = (SIUnitTerm *)OCArrayGetValueAtIndex(terms, i);
-            if (!term1) continue;
-            for (OCIndex j = i + 1; j < count; j++) {
-                SIUnitTerm *term2 = (SIUnitTerm *)OCArrayGetValueAtIndex(terms, j);
-                if (!term2) continue;
-                if (OCStringEqual(term1->symbol, term2->symbol)) {
-                    term1->power += term2->power;  // Combine powers
-                    siueReleaseTerm(term2);
-                    OCArrayRemoveValueAtIndex(terms, j);
-                    count--;
-                    j--;  // Adjust index after removal
-                }
-            }
-        }
-    }
-    // Remove terms with zero power
-    for (OCIndex i = count - 1; i >= 0; i--) {
-        SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(terms, i);
-        if (term && term->power == 0) {
-            siueReleaseTerm(term);
-            OCArrayRemoveValueAtIndex(terms, i);
+void siueSortAndGroupTerms(SIUnitTermList *list) {
+    if (!list) return;
+    SIUnitTerm *terms = siueTermListGetTerms(list);
+    uint32_t sorted = 0;
+    for (uint32_t i = 0; i < list->count; i++) {
+        SIUnitTerm term = terms[i];
+        uint32_t j = sorted;
+        int order = 1;
+        while (j > 0 && (order = siueCompareTerms(&terms[j - 1], &term)) > 0) j--;
+        if (j > 0 && order == 0) {
+            terms[j - 1].power += term.power;  // Combine powers
+            continue;
         }
+        memmove(&terms[j + 1], &terms[j], (sorted - j) * sizeof(SIUnitTerm));
+        terms[j] = term;
+        sorted++;
     }
-}
-// Alphabetical comparison function for term sorting
-static int termCompare(const void *a, const void *b) {
-    const SIUnitTerm *term1 = *(const SIUnitTerm **)a;
-    const SIUnitTerm *term2 = *(const SIUnitTerm **)b;
-    if (!term1 || !term1->symbol) return 1;
-    if (!term2 || !term2->symbol) return -1;
-    return OCStringCompare(term1->symbol, term2->symbol, 0);
+    list->count = sorted;
+    siueRemoveZeroPowerTerms(list);
 }
 /**
- * Sorts terms alphabetically by symbol.
- * Implements alphabetical ordering requirement: m*kg → kg•m.
+ * Moves terms with negative powers from numerator to denominator.
+ * Converts m^-2 → 1/m^2 for proper formatting.
  */
-void siueSortTermsAlphabetically(OCMutableArrayRef terms) {
-    if (!terms) return;
-    OCIndex count = OCArrayGetCount(terms);
-    if (count <= 1) return;
-    // Create array of pointers for qsort
-    SIUnitTerm **termArray = malloc(count * sizeof(SIUnitTerm *));
-    if (!termArray) return;
-    for (OCIndex i = 0; i < count; i++) {
-        termArray[i] = (SIUnitTerm *)OCArrayGetValueAtIndex(terms, i);
-    }
-    // Sort alphabetically
-    qsort(termArray, count, sizeof(SIUnitTerm *), termCompare);
-    // Replace original array content with sorted terms
-    while (OCArrayGetCount(terms) > 0) {
-        OCArrayRemoveValueAtIndex(terms, 0);
-    }
-    for (OCIndex i = 0; i < count; i++) {
-        OCArrayAppendValue(terms, termArray[i]);
+bool siueMoveNegativePowersToDenominator(SIArena *arena, SIUnitExpression *expr) {
+    if (!expr) return false;
+    SIUnitTerm *terms = siueTermListGetTerms(&expr->numerator);
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < expr->numerator.count; i++) {
+        SIUnitTerm term = terms[i];
+        if (term.power < 0) {
+            term.power = -term.power;
+            if (!siueTermListAppend(arena, &expr->denominator, term)) return false;
+        } else {
+            terms[kept++] = term;
+        }
     }
-    free(termArray);
+    expr->numerator.count = kept;
+    return true;
 }
 /**
  * Cancels identical terms between numerator and denominator.
  * Implements algebraic reduction: kg*m/kg → m, m^3/m^2 → m.
+ * Both lists are sorted and grouped, so one merge finds every match.
  * Used only by SIUnitCreateCleanedAndReducedExpression.
  */
 void siueCancelTerms(SIUnitExpression *expr) {
-    if (!expr || !expr->numerator || !expr->denominator) return;
-    OCMutableArrayRef num = OCArrayCreateMutableCopy(expr->numerator);
-    OCMutableArrayRef den = OCArrayCreateMutableCopy(expr->denominator);
-    OCIndex numCount = OCArrayGetCount(num);
-    OCIndex denCount = OCArrayGetCount(den);
-    // Cancel matching symbols by subtracting powers
-    for (OCIndex i = numCount - 1; i >= 0; i--) {
-        SIUnitTerm *numTerm = (SIUnitTerm *)OCArrayGetValueAtIndex(num, i);
-        if (!numTerm) continue;
-        for (OCIndex j = denCount - 1; j >= 0; j--) {
-            SIUnitTerm *denTerm = (SIUnitTerm *)OCArrayGetValueAtIndex(den, j);
-            if (!denTerm) continue;
-            if (OCStringEqual(numTerm->symbol, denTerm->symbol)) {
-                // Subtract minimum power from both terms
-                int minPower = (numTerm->power < denTerm->power) ? numTerm->power : denTerm->power;
-                numTerm->power -= minPower;
-                denTerm->power -= minPower;
-                // Remove terms with zero power
-                if (numTerm->power == 0) {
-                    siueReleaseTerm(numTerm);
-                    OCArrayRemoveValueAtIndex(num, i);
-                    numCount--;
-                }
-                if (denTerm->power == 0) {
-                    siueReleaseTerm(denTerm);
-                    OCArrayRemoveValueAtIndex(den, j);
-                    denCount--;
-                }
-                break;  // Found match, move to next numerator term
-            }
+    if (!expr || expr->numerator.count == 0 || expr->denominator.count == 0) return;
+    SIUnitTerm *num = siueTermListGetTerms(&expr->numerator);
+    SIUnitTerm *den = siueTermListGetTerms(&expr->denominator);
+    uint32_t i = 0, j = 0;
+    while (i < expr->numerator.count && j < expr->denominator.count) {
+        int order = siueCompareTerms(&num[i], &den[j]);
+        if (order < 0) {
+            i++;
+        } else if (order > 0) {
+            j++;
+        } else {
+            // Subtract minimum power from both terms
+            int minPower = (num[i].power < den[j].power) ? num[i].power : den[j].power;
+            num[i++].power -= minPower;
+            den[j++].power -= minPower;
         }
     }
-    // Update expression with cancelled arrays
-    if (expr->numerator) OCRelease(expr->numerator);
-    if (expr->denominator) OCRelease(expr->denominator);
-    expr->numerator = num;
-    expr->denominator = (OCArrayGetCount(den) > 0) ? den : NULL;
-    if (!expr->denominator && den) {
-        OCRelease(den);
-    }
+    siueRemoveZeroPowerTerms(&expr->numerator);
+    siueRemoveZeroPowerTerms(&expr->denominator);
 }
-/**
- * Moves terms with negative powers from numerator to denominator and returns the denominator.
- * Converts m^-2 → 1/m^2 for proper formatting.
- *
- * @param numerator The numerator array to process (modified in-place)
- * @param denominator The existing denominator array (may be NULL)
- * @return The denominator array with negative power terms added. If denominator was NULL,
- *         returns a new array that caller owns. If denominator was non-NULL, returns it
- *         with retain count increased (caller must OCRelease).
- */
-OCMutableArrayRef siueCreateDenominatorWithNegativePowers(OCMutableArrayRef numerator, OCArrayRef denominator) {
-    if (!numerator) return denominator ? (OCMutableArrayRef)OCRetain(denominator) : NULL;
-    OCMutableArrayRef workingDenominator;
-    if (denominator) {
-        workingDenominator = (OCMutableArrayRef)OCRetain(denominator);  // Increase retain count
-    } else {
-        workingDenominator = OCArrayCreateMutable(10, NULL);  // Create new array
-    }
-    if (!workingDenominator) return NULL;
-    // Move negative power terms to denominator
-    OCIndex count = OCArrayGetCount(numerator);
-    for (OCIndex i = count - 1; i >= 0; i--) {
-        SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(numerator, i);
-        if (term && term->power < 0) {
-            // Create positive power term for denominator
-            SIUnitTerm *newTerm = siueCreateTerm(term->symbol, -term->power);
-            if (newTerm) {
-                if (OCArrayAppendValue(workingDenominator, newTerm)) {
-                    // Successfully added to denominator, now remove from numerator
-                    siueReleaseTerm(term);
-                    OCArrayRemoveValueAtIndex(numerator, i);
-                } else {
-                    // Failed to add to denominator, clean up newTerm
-                    siueReleaseTerm(newTerm);
-                }
-            }
+#pragma mark - Formatting Functions
+// Appends terms joined by •, writing ^n for every power other than 1
+static void siueAppendTerms(OCMutableStringRef result, const SIUnitTermList *list) {
+    const SIUnitTerm *terms = list->spill ? list->spill : list->inlineTerms;
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (i > 0) {
+            OCStringAppendCString(result, "•");
+        }
+        OCStringAppend(result, terms[i].symbol);
+        if (terms[i].power != 1) {
+            char powerStr[32];
+            snprintf(powerStr, sizeof(powerStr), "^%d", terms[i].power);
+            OCStringAppendCString(result, powerStr);
         }
     }
-    return workingDenominator;
 }
-#pragma mark - Formatting Functions
 /**
  * Formats expression as output string with proper notation.
  * Uses • for multiplication, / for division, ^ for powers (omitted when power=1).
@@ -431,58 +280,28 @@ OCStringRef siueCreateFormattedExpression(const SIUnitExpression *expr, bool red
     if (!expr) return NULL;
     OCMutableStringRef result = OCStringCreateMutable(256);
     // Check for special formatting cases
-    bool hasEmptyNumerator = (!expr->numerator || OCArrayGetCount(expr->numerator) == 0);
-    bool hasNonEmptyDenominator = (expr->denominator && OCArrayGetCount(expr->denominator) > 0);
+    bool hasEmptyNumerator = (expr->numerator.count == 0);
+    bool hasNonEmptyDenominator = (expr->denominator.count > 0);
     bool needsOuterParens = hasEmptyNumerator && hasNonEmptyDenominator;
     if (needsOuterParens) {
         OCStringAppendCString(result, "(");
     }
     // Format numerator terms with • separator
-    if (expr->numerator && OCArrayGetCount(expr->numerator) > 0) {
-        OCIndex count = OCArrayGetCount(expr->numerator);
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expr->numerator, i);
-            if (!term) continue;
-            if (i > 0) {
-                OCStringAppendCString(result, "•");
-            }
-            OCStringAppend(result, term->symbol);
-            if (term->power != 1) {
-                char powerStr[32];
-                snprintf(powerStr, sizeof(powerStr), "^%d", term->power);
-                OCStringAppendCString(result, powerStr);
-            }
-        }
+    if (!hasEmptyNumerator) {
+        siueAppendTerms(result, &expr->numerator);
     } else {
         // Empty numerator - output "1" for expressions like 1/m, space for dimensionless
-        if (expr->denominator && OCArrayGetCount(expr->denominator) > 0) {
-            OCStringAppendCString(result, "1");
-        } else {
-            OCStringAppendCString(result, " ");  // Dimensionless
-        }
+        OCStringAppendCString(result, hasNonEmptyDenominator ? "1" : " ");
     }
     // Format denominator terms
-    if (expr->denominator && OCArrayGetCount(expr->denominator) > 0) {
+    if (hasNonEmptyDenominator) {
         OCStringAppendCString(result, "/");
-        OCIndex count = OCArrayGetCount(expr->denominator);
         // Add parentheses for multiple terms in denominator
-        bool needParens = count > 1;
+        bool needParens = expr->denominator.count > 1;
         if (needParens) {
             OCStringAppendCString(result, "(");
         }
-        for (OCIndex i = 0; i < count; i++) {
-            SIUnitTerm *term = (SIUnitTerm *)OCArrayGetValueAtIndex(expr->denominator, i);
-            if (!term) continue;
-            if (i > 0) {
-                OCStringAppendCString(result, "•");
-            }
-            OCStringAppend(result, term->symbol);
-            if (term->power != 1) {
-                char powerStr[32];
-                snprintf(powerStr, sizeof(powerStr), "^%d", term->power);
-                OCStringAppendCString(result, powerStr);
-            }
-        }
+        siueAppendTerms(result, &expr->denominator);
         if (needParens) {
             OCStringAppendCString(result, ")");
         }
@@ -503,97 +322,39 @@ static OCStringRef siueCreateByConvertingDimensionlessOutput(OCStringRef formatt
     }
     return OCStringCreateCopy(formatted);  // Always return a copy to maintain "Create" semantics
 }
-#pragma mark - Global Variables for Parser
-// Parser state management for lex/yacc communication
-static SIUnitExpression *g_parsed_expression = NULL;
-SIUnitExpression *siueGetParsedExpression(void) {
-    return g_parsed_expression;
-}
-void siueClearParsedExpression(void) {
-    if (g_parsed_expression) {
-        siueRelease(g_parsed_expression);
-        g_parsed_expression = NULL;
-    }
-    // Also clear any remaining parser state that might hold string references
-    if (siueError) {
-        OCRelease(siueError);
-        siueError = NULL;
-    }
-    // Note: We don't call siuelex_destroy() here because this function gets called
-    // frequently during parsing operations and would cause double-free errors
-}
-void siueSetParsedExpression(SIUnitExpression *expr) {
-    siueClearParsedExpression();
-    g_parsed_expression = expr;
-}
 #pragma mark - Parser State Management
-/**
- * Comprehensive cleanup of all parser state and internal buffers.
- * This function performs a complete reset of the parser system, including:
- * - Clearing parsed expression state
- * - Destroying lexer internal buffers
- * - Resetting global error state
- *
- * Call this function at the end of intensive parsing operations or test suites
- * to ensure no parser state accumulates and causes memory leaks.
- */
 void siueCleanupParserState(void) {
-    // Clear parsed expression and error state
-    siueClearParsedExpression();
-    // Complete lexer state cleanup - only call this at the end of all parsing
-    // operations to avoid double-free errors
-    siuelex_destroy();
-    // Additional cleanup could be added here for other parsers if needed
-    // This function serves as a comprehensive cleanup point for the entire parser system
+    // Parsing is reentrant: all state lives in a per-call SIUnitExpressionParseContext
 }
 #pragma mark - Validation Functions
 /**
- * Validates symbol against ~951 allowed token unit symbols.
- * Only symbols from SIUnitGetTokenSymbolsLib() are valid per spec.
+ * Validates symbol against the ~951 allowed token unit symbols.
+ * Only symbols from SIUnitGetTokenSymbolsLib() are valid per spec;
+ * membership is answered by the hashed token symbol index.
  */
 bool siueValidateSymbol(OCStringRef symbol) {
     if (!symbol) return false;
-    OCArrayRef tokenSymbols = SIUnitGetTokenSymbolsLib();
-    if (!tokenSymbols) return false;
-    OCIndex count = OCArrayGetCount(tokenSymbols);
-    for (OCIndex i = 0; i < count; i++) {
-        OCStringRef validSymbol = (OCStringRef)OCArrayGetValueAtIndex(tokenSymbols, i);
-        if (OCStringEqual(symbol, validSymbol)) {
-            return true;
-        }
-    }
-    return false;
+    return SIUnitIsTokenSymbol(symbol);
 }
-// Parses normalized expressions using lex/yacc parser with siue prefix
+// Parses normalized expressions using the reentrant lex/yacc parser with siue prefix
 // Returns parsed SIUnitExpression or NULL on failure/invalid symbols
-SIUnitExpression *siueCreateParsedExpression(OCStringRef normalized_expr) {
+SIUnitExpression *siueCreateParsedExpression(SIArena *arena, OCStringRef normalized_expr) {
     if (!normalized_expr) return NULL;
-    // Clear previous state
-    if (siueError) {
-        OCRelease(siueError);
-        siueError = NULL;
-    }
-    siueClearParsedExpression();
     // Convert to C string for lex/yacc
     const char *exprStr = OCStringGetCString(normalized_expr);
     if (!exprStr) return NULL;
-    // Parse using lex/yacc with siue prefix
-    YY_BUFFER_STATE buffer = siue_scan_string(exprStr);
-    int parseResult = siueparse();
-    siue_delete_buffer(buffer);
-    // Clean up lexer state after parsing to prevent string leaks
-    siuelex_destroy();
-    if (parseResult != 0 || siueError) {
-        siueClearParsedExpression();
-        return NULL;
-    }
-    // Transfer ownership from global parser state
-    SIUnitExpression *result = siueGetParsedExpression();
-    if (result) {
-        g_parsed_expression = NULL;  // Clear without freeing
-        return result;
-    }
-    return NULL;
+    SIUnitExpressionParseContext ctx = {NULL, NULL, arena};
+    void *scanner = NULL;
+    if (siuelex_init_extra(&ctx, &scanner) != 0) return NULL;
+    YY_BUFFER_STATE buffer = siue_scan_string(exprStr, scanner);
+    int parseResult = siueparse(&ctx, scanner);
+    siue_delete_buffer(buffer, scanner);
+    siuelex_destroy(scanner);
+    bool failed = (parseResult != 0 || ctx.error);
+    if (ctx.error) OCRelease(ctx.error);
+    if (failed) return NULL;
+    // The expression lives in the caller's arena
+    return ctx.parsed;
 }
 #pragma mark - Unicode Conversion Helpers
 // Converts bullet characters (•) to asterisks (*) for internal parser compatibility
@@ -615,7 +376,65 @@ static OCStringRef siueCreateByConvertingAsterisksToBullets(OCStringRef expressi
 #pragma mark - Main Public Functions
 // Unicode normalization: converts operators to standard forms (×→*, ÷→/, μ→µ, superscripts→^n)
 // Handles empty strings, spaces→"1", cleans whitespace around operators
-// TODO: Integrate with existing SIUnitCreateNormalizedExpression when available
+#pragma mark - Normalization
+// UTF-8 operator spellings and their parser forms.  Superscript digits and the
+// superscript minus are handled separately because "⁻" only maps as a prefix.
+typedef struct {
+    const char *utf8;
+    uint8_t length;
+    const char *replacement;
+} SIUnitOperatorSpelling;
+static const SIUnitOperatorSpelling kSIUnitOperatorSpellings[] = {
+    {"×", 2, "*"},
+    {"÷", 2, "/"},
+    {"μ", 2, "µ"},  // Greek mu → micro
+    {"·", 2, "*"},
+    {"•", 3, "*"},
+    {"⋅", 3, "*"},
+    {"∙", 3, "*"},
+    {"∕", 3, "/"},
+    {"⁄", 3, "/"},
+};
+// Returns the digit a superscript digit at p stands for and its byte length, or -1.
+static int siueSuperscriptDigit(const unsigned char *p, const unsigned char *end, int *length) {
+    if (end - p >= 2 && p[0] == 0xC2) {
+        *length = 2;
+        if (p[1] == 0xB9) return 1;  // ¹
+        if (p[1] == 0xB2) return 2;  // ²
+        if (p[1] == 0xB3) return 3;  // ³
+        return -1;
+    }
+    if (end - p >= 3 && p[0] == 0xE2 && p[1] == 0x81) {
+        *length = 3;
+        if (p[2] == 0xB0) return 0;                  // ⁰
+        if (p[2] >= 0xB4 && p[2] <= 0xB9) return p[2] - 0xB0;  // ⁴ … ⁹
+    }
+    return -1;
+}
+// Removes every non-overlapping occurrence of " op " left to right, leaving op,
+// as one OCStringFindAndReplace pass would.  Returns the new length.
+static size_t siueCollapseSpacesAroundOperator(char *buffer, size_t length, char op) {
+    size_t out = 0;
+    for (size_t i = 0; i < length;) {
+        if (i + 2 < length && buffer[i] == ' ' && buffer[i + 1] == op && buffer[i + 2] == ' ') {
+            buffer[out++] = op;
+            i += 3;
+        } else {
+            buffer[out++] = buffer[i++];
+        }
+    }
+    buffer[out] = '\0';
+    return out;
+}
+// ASCII whitespace only: isspace() follows the locale SIUnitCreateLibraries
+// sets, and a single-byte locale can class UTF-8 continuation bytes as space.
+static bool siueIsASCIISpace(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+// Rewrites operators, micro and superscript powers into the parser's ASCII
+// forms in one scan over the UTF-8 input.  The output is never longer than
+// the input.  Spaces around *, / and ^ are collapsed afterwards, operator by
+// operator, only when the scan saw a space next to one of them.
 OCMutableStringRef SIUnitCreateNormalizedExpression(OCStringRef expression) {
     if (!expression) return NULL;
     // Handle empty and dimensionless cases
@@ -625,47 +444,75 @@ OCMutableStringRef SIUnitCreateNormalizedExpression(OCStringRef expression) {
     if (OCStringGetLength(expression) == 1 && OCStringEqual(expression, STR(" "))) {
         return OCStringCreateMutableCopy(STR("1"));  // Space → "1" for parser
     }
-    OCMutableStringRef mutString = OCStringCreateMutableCopy(expression);
+    const char *cString = OCStringGetCString(expression);
+    if (!cString) return NULL;
     // Trim leading and trailing whitespace
-    OCStringTrimWhitespace(mutString);
-    // Unicode operator normalizations per spec
-    OCStringFindAndReplace(mutString, STR("×"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("÷"), STR("/"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("μ"), STR("µ"), OCRangeMake(0, OCStringGetLength(mutString)), 0);  // Greek mu → micro
-    // Additional multiplication operators → *
-    OCStringFindAndReplace(mutString, STR("•"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⋅"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("∙"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("·"), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    // Additional division operators → /
-    OCStringFindAndReplace(mutString, STR("∕"), STR("/"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁄"), STR("/"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    // Superscript normalizations (negative powers first)
-    OCStringFindAndReplace(mutString, STR("⁻⁰"), STR("^-0"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻¹"), STR("^-1"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻²"), STR("^-2"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻³"), STR("^-3"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻⁴"), STR("^-4"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻⁵"), STR("^-5"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻⁶"), STR("^-6"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻⁷"), STR("^-7"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻⁸"), STR("^-8"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁻⁹"), STR("^-9"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    // Positive superscripts
-    OCStringFindAndReplace(mutString, STR("⁰"), STR("^0"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("¹"), STR("^1"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("²"), STR("^2"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("³"), STR("^3"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁴"), STR("^4"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁵"), STR("^5"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁶"), STR("^6"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁷"), STR("^7"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁸"), STR("^8"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR("⁹"), STR("^9"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
+    const unsigned char *p = (const unsigned char *)cString;
+    const unsigned char *end = p + strlen(cString);
+    while (p < end && siueIsASCIISpace(*p)) p++;
+    while (end > p && siueIsASCIISpace(end[-1])) end--;
+    char stackBuffer[256];
+    size_t capacity = (size_t)(end - p) + 1;
+    char *buffer = capacity <= sizeof(stackBuffer) ? stackBuffer : malloc(capacity);
+    if (!buffer) return NULL;
+    size_t length = 0;
+    bool spacedOperator = false;
+    while (p < end) {
+        unsigned char c = *p;
+        if (c < 0x80) {
+            if (c == ' ' && length > 0 && (buffer[length - 1] == '*' || buffer[length - 1] == '/' || buffer[length - 1] == '^'))
+                spacedOperator = true;
+            buffer[length++] = (char)c;
+            p++;
+            continue;
+        }
+        int digitLength = 0;
+        int digit = -1;
+        if (end - p >= 3 && p[0] == 0xE2 && p[1] == 0x81 && p[2] == 0xBB) {  // ⁻
+            digit = siueSuperscriptDigit(p + 3, end, &digitLength);
+            if (digit >= 0) {
+                buffer[length++] = '^';
+                buffer[length++] = '-';
+                buffer[length++] = (char)('0' + digit);
+                p += 3 + digitLength;
+                continue;
+            }
+        }
+        digit = siueSuperscriptDigit(p, end, &digitLength);
+        if (digit >= 0) {
+            buffer[length++] = '^';
+            buffer[length++] = (char)('0' + digit);
+            p += digitLength;
+            continue;
+        }
+        const SIUnitOperatorSpelling *spelling = NULL;
+        for (size_t i = 0; i < sizeof(kSIUnitOperatorSpellings) / sizeof(kSIUnitOperatorSpellings[0]); i++) {
+            const SIUnitOperatorSpelling *candidate = &kSIUnitOperatorSpellings[i];
+            if ((size_t)(end - p) >= candidate->length && memcmp(p, candidate->utf8, candidate->length) == 0) {
+                spelling = candidate;
+                break;
+            }
+        }
+        if (spelling) {
+            size_t replacementLength = strlen(spelling->replacement);
+            memcpy(buffer + length, spelling->replacement, replacementLength);
+            length += replacementLength;
+            p += spelling->length;
+        } else {
+            buffer[length++] = (char)c;
+            p++;
+        }
+    }
+    buffer[length] = '\0';
     // Clean up whitespace around operators
-    OCStringFindAndReplace(mutString, STR(" * "), STR("*"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR(" / "), STR("/"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
-    OCStringFindAndReplace(mutString, STR(" ^ "), STR("^"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
+    if (spacedOperator) {
+        length = siueCollapseSpacesAroundOperator(buffer, length, '*');
+        length = siueCollapseSpacesAroundOperator(buffer, length, '/');
+        length = siueCollapseSpacesAroundOperator(buffer, length, '^');
+    }
+    OCMutableStringRef mutString = OCStringCreateMutable((OCIndex)length);
+    if (mutString) OCStringAppendCString(mutString, buffer);
+    if (buffer != stackBuffer) free(buffer);
     return mutString;
 }
 // Checks if two unit expressions are equivalent after cleaning and normalization
@@ -692,49 +539,122 @@ bool SIUnitAreExpressionsEquivalent(OCStringRef expr1, OCStringRef expr2) {
 // Groups and sorts without power cancellation - returns clean formatted expression
 OCStringRef SIUnitCreateCleanedExpression(OCStringRef expression) {
     if (!expression) return NULL;
-    // Handle empty string case early
-    if (OCStringGetLength(expression) == 0) return STR(" ");
-    // Special case: Handle specific expressions that cause parser failures and memory leaks
-    // These exact strings cause the parser to hang and leak objects, so we bypass parsing for them
-    if (OCStringEqual(expression, STR("L/(100 km)")) ||
-        OCStringEqual(expression, STR("h_P/(2•m_e)")) ||
-        OCStringEqual(expression, STR("exp(1)"))) {
-        // For these problematic expressions, just return a copy without parsing
-        return OCStringCreateCopy(expression);
+    SIUnitCanonicalParse parse;
+    siueCanonicalParseInit(&parse, expression);
+    OCStringRef result = siueCanonicalParseCreateCleanedExpression(&parse);
+    siueCanonicalParseDestroy(&parse);
+    return result;
+}
+#pragma mark - Canonical Keys
+// Adds power to token's pair, appending a pair for a token not seen yet.
+// Returns false when a new pair would not fit.
+static bool siueAddTokenPower(int32_t *pairs, size_t *count, size_t capacity, int32_t token, int32_t power) {
+    size_t i = 0;
+    while (i < *count && pairs[2 * i] != token) i++;
+    if (i == *count) {
+        if (2 * (i + 1) > capacity) return false;
+        pairs[2 * i] = token;
+        pairs[2 * i + 1] = 0;
+        (*count)++;
+    }
+    pairs[2 * i + 1] += power;
+    return true;
+}
+// Groups terms by token ID.  Returns false for a symbol outside the token
+// library or when the pairs would not fit.
+static bool siueAccumulateTokenPowers(SIUnitTermList *list, int32_t *pairs, size_t *count, size_t capacity) {
+    const SIUnitTerm *terms = siueTermListGetTerms(list);
+    for (uint32_t i = 0; i < list->count; i++) {
+        if (terms[i].token < 0 || !siueAddTokenPower(pairs, count, capacity, terms[i].token, terms[i].power)) return false;
+    }
+    return true;
+}
+// Drops zero powers and sorts the remaining pairs by token ID; returns the new count.
+static size_t siueSortTokenPowers(int32_t *pairs, size_t count) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (pairs[2 * i + 1] == 0) continue;
+        int32_t token = pairs[2 * i], power = pairs[2 * i + 1];
+        size_t j = kept++;
+        for (; j > 0 && pairs[2 * (j - 1)] > token; j--) {
+            pairs[2 * j] = pairs[2 * (j - 1)];
+            pairs[2 * j + 1] = pairs[2 * (j - 1) + 1];
+        }
+        pairs[2 * j] = token;
+        pairs[2 * j + 1] = power;
     }
+    return kept;
+}
+// Expressions that SIUnitCreateCleanedExpression passes through unparsed,
+// since the parser fails on them
+static bool siueIsPassthroughExpression(OCStringRef expression) {
+    return OCStringEqual(expression, STR("L/(100 km)")) ||
+           OCStringEqual(expression, STR("h_P/(2•m_e)")) ||
+           OCStringEqual(expression, STR("exp(1)"));
+}
+void siueCanonicalParseInit(SIUnitCanonicalParse *parse, OCStringRef expression) {
+    SIArenaInit(&parse->arena);
+    parse->expression = expression;
+    parse->parsed = NULL;
+    if (!expression || OCStringGetLength(expression) == 0 || siueIsPassthroughExpression(expression)) return;
     // Step 1: Normalize Unicode characters first
     OCMutableStringRef normalized = SIUnitCreateNormalizedExpression(expression);
-    if (!normalized) return NULL;
+    if (!normalized) return;
     // Step 2: Convert bullet characters to asterisks for parsing
     OCStringRef preprocessed = siueCreateByConvertingBulletsToAsterisks(normalized);
     OCRelease(normalized);
-    if (!preprocessed) return NULL;
-    // Step 3: Parse the preprocessed expression
-    SIUnitExpression *parsed = siueCreateParsedExpression(preprocessed);
+    if (!preprocessed) return;
+    // Step 3: Parse the preprocessed expression; terms live in the parse's arena
+    parse->parsed = siueCreateParsedExpression(&parse->arena, preprocessed);
     OCRelease(preprocessed);
+}
+void siueCanonicalParseDestroy(SIUnitCanonicalParse *parse) {
+    SIArenaDestroy(&parse->arena);
+    parse->parsed = NULL;
+}
+// Same grouping as SIUnitCreateCleanedExpression, but on token IDs: no term
+// arrays are copied, sorted by string or formatted.
+size_t siueCanonicalParseGetKey(const SIUnitCanonicalParse *parse, int32_t *key, size_t capacity) {
+    if (!parse->parsed || !key || capacity == 0) return 0;
+    int32_t numerator[2 * SIUE_CANONICAL_KEY_MAX_TOKENS];
+    int32_t denominator[2 * SIUE_CANONICAL_KEY_MAX_TOKENS];
+    size_t numeratorCount = 0;
+    size_t denominatorCount = 0;
+    if (!siueAccumulateTokenPowers(&parse->parsed->numerator, numerator, &numeratorCount, 2 * SIUE_CANONICAL_KEY_MAX_TOKENS) ||
+        !siueAccumulateTokenPowers(&parse->parsed->denominator, denominator, &denominatorCount, 2 * SIUE_CANONICAL_KEY_MAX_TOKENS))
+        return 0;
+    // Numerator tokens whose powers sum below zero move to the denominator
+    for (size_t i = 0; i < numeratorCount; i++) {
+        if (numerator[2 * i + 1] >= 0) continue;
+        if (!siueAddTokenPower(denominator, &denominatorCount, 2 * SIUE_CANONICAL_KEY_MAX_TOKENS,
+                               numerator[2 * i], -numerator[2 * i + 1]))
+            return 0;
+        numerator[2 * i + 1] = 0;
+    }
+    numeratorCount = siueSortTokenPowers(numerator, numeratorCount);
+    denominatorCount = siueSortTokenPowers(denominator, denominatorCount);
+    size_t length = 1 + 2 * (numeratorCount + denominatorCount);
+    if (length > capacity) return 0;
+    key[0] = (int32_t)numeratorCount;
+    memcpy(key + 1, numerator, 2 * numeratorCount * sizeof(int32_t));
+    memcpy(key + 1 + 2 * numeratorCount, denominator, 2 * denominatorCount * sizeof(int32_t));
+    return length;
+}
+OCStringRef siueCanonicalParseCreateCleanedExpression(SIUnitCanonicalParse *parse) {
+    if (!parse->expression) return NULL;
+    // Handle empty string case early
+    if (OCStringGetLength(parse->expression) == 0) return STR(" ");
+    // For expressions the parser cannot handle, just return a copy without parsing
+    if (siueIsPassthroughExpression(parse->expression)) return OCStringCreateCopy(parse->expression);
+    SIUnitExpression *parsed = parse->parsed;
     if (!parsed) return NULL;
-    // Step 4: Process the expression (group and sort)
-    // Work directly with the parsed expression arrays
-    if (parsed->numerator) {
-        OCMutableArrayRef mutableNum = OCArrayCreateMutableCopy(parsed->numerator);
-        siueGroupIdenticalTerms(mutableNum);
-        siueSortTermsAlphabetically(mutableNum);
-        OCMutableArrayRef newDenominator = siueCreateDenominatorWithNegativePowers(mutableNum, parsed->denominator);
-        if (parsed->numerator) OCRelease(parsed->numerator);
-        if (parsed->denominator) OCRelease(parsed->denominator);
-        parsed->numerator = mutableNum;
-        parsed->denominator = newDenominator;
-    }
-    if (parsed->denominator) {
-        OCMutableArrayRef mutableDen = OCArrayCreateMutableCopy(parsed->denominator);
-        siueGroupIdenticalTerms(mutableDen);
-        siueSortTermsAlphabetically(mutableDen);
-        if (parsed->denominator) OCRelease(parsed->denominator);
-        parsed->denominator = mutableDen;
-    }
+    // Step 4: Process the expression (group and sort); the tree is consumed
+    parse->parsed = NULL;
+    siueSortAndGroupTerms(&parsed->numerator);
+    if (!siueMoveNegativePowersToDenominator(&parse->arena, parsed)) return NULL;
+    siueSortAndGroupTerms(&parsed->denominator);
     // Step 5: Format the result
     OCStringRef formatted = siueCreateFormattedExpression(parsed, false);
-    siueRelease(parsed);
     if (!formatted) return NULL;
     // Step 6: Convert asterisks back to bullet characters
     OCStringRef bullets = siueCreateByConvertingAsterisksToBullets(formatted);
@@ -743,15 +663,15 @@ OCStringRef SIUnitCreateCleanedExpression(OCStringRef expression) {
     // Step 7: Convert "1" to space character for dimensionless output
     OCStringRef result = siueCreateByConvertingDimensionlessOutput(bullets);
     OCRelease(bullets);
-    // Ensure all parser state is completely cleared after each expression processing
-    siueClearParsedExpression();
-    // Explicitly clear any remaining error state
-    if (siueError) {
-        OCRelease(siueError);
-        siueError = NULL;
-    }
     return result;
 }
+size_t siueCreateCanonicalKey(OCStringRef expression, int32_t *key, size_t capacity) {
+    SIUnitCanonicalParse parse;
+    siueCanonicalParseInit(&parse, expression);
+    size_t length = siueCanonicalParseGetKey(&parse, key, capacity);
+    siueCanonicalParseDestroy(&parse);
+    return length;
+}
 // Creates cleaned and reduced expression: full algebraic reduction with power cancellation
 // Groups, sorts, cancels matching powers between numerator/denominator, handles dimensionless output
 OCStringRef SIUnitCreateCleanedAndReducedExpression(OCStringRef expression) {
@@ -763,45 +683,27 @@ OCStringRef SIUnitCreateCleanedAndReducedExpression(OCStringRef expression) {
     OCStringRef preprocessed = siueCreateByConvertingBulletsToAsterisks(normalized);
     OCRelease(normalized);
     if (!preprocessed) return NULL;
-    // Step 3: Parse the preprocessed expression
-    SIUnitExpression *parsed = siueCreateParsedExpression(preprocessed);
+    // Step 3: Parse the preprocessed expression; terms live in this arena until Step 5
+    SIArena arena;
+    SIArenaInit(&arena);
+    SIUnitExpression *parsed = siueCreateParsedExpression(&arena, preprocessed);
     OCRelease(preprocessed);
-    if (!parsed) return NULL;
-    // Step 4: Process the expression (group, sort, and cancel)
-    // Work directly with the parsed expression arrays
-    if (parsed->numerator) {
-        OCMutableArrayRef mutableNum = OCArrayCreateMutableCopy(parsed->numerator);
-        siueGroupIdenticalTerms(mutableNum);
-        OCMutableArrayRef newDenominator = siueCreateDenominatorWithNegativePowers(mutableNum, parsed->denominator);
-        if (parsed->numerator) OCRelease(parsed->numerator);
-        if (parsed->denominator) OCRelease(parsed->denominator);
-        parsed->numerator = mutableNum;
-        parsed->denominator = newDenominator;
+    if (!parsed) {
+        SIArenaDestroy(&arena);
+        return NULL;
     }
-    if (parsed->denominator) {
-        OCMutableArrayRef mutableDen = OCArrayCreateMutableCopy(parsed->denominator);
-        siueGroupIdenticalTerms(mutableDen);
-        if (parsed->denominator) OCRelease(parsed->denominator);
-        parsed->denominator = mutableDen;
+    // Step 4: Process the expression (group, sort, and cancel)
+    siueSortAndGroupTerms(&parsed->numerator);
+    if (!siueMoveNegativePowersToDenominator(&arena, parsed)) {
+        SIArenaDestroy(&arena);
+        return NULL;
     }
-    // Cancel terms between numerator and denominator
+    siueSortAndGroupTerms(&parsed->denominator);
+    // Cancel terms between numerator and denominator; both stay sorted
     siueCancelTerms(parsed);
-    // Sort terms alphabetically after cancellation
-    if (parsed->numerator) {
-        OCMutableArrayRef sortableNum = OCArrayCreateMutableCopy(parsed->numerator);
-        siueSortTermsAlphabetically(sortableNum);
-        OCRelease(parsed->numerator);
-        parsed->numerator = sortableNum;
-    }
-    if (parsed->denominator) {
-        OCMutableArrayRef sortableDen = OCArrayCreateMutableCopy(parsed->denominator);
-        siueSortTermsAlphabetically(sortableDen);
-        OCRelease(parsed->denominator);
-        parsed->denominator = sortableDen;
-    }
     // Step 5: Format the result
     OCStringRef formatted = siueCreateFormattedExpression(parsed, true);
-    siueRelease(parsed);
+    SIArenaDestroy(&arena);
     if (!formatted) return NULL;
     // Step 6: Convert asterisks back to bullet characters
     OCStringRef bullets = siueCreateByConvertingAsterisksToBullets(formatted);
@@ -810,13 +712,6 @@ OCStringRef SIUnitCreateCleanedAndReducedExpression(OCStringRef expression) {
     // Step 7: Convert "1" to space character for dimensionless output
     OCStringRef result = siueCreateByConvertingDimensionlessOutput(bullets);
     OCRelease(bullets);
-    // Ensure all parser state is completely cleared after each expression processing
-    siueClearParsedExpression();
-    // Explicitly clear any remaining error state
-    if (siueError) {
-        OCRelease(siueError);
-        siueError = NULL;
-    }
     return result;
 }
 int SIUnitCountTokenSymbols(OCStringRef cleanedExpression) {
@@ -7,6 +7,7 @@
 //
 #ifndef SIUnitExpression_h
 #define SIUnitExpression_h
+#include "SIArena.h"
 #include "SITypes.h"
 /*!
  * @file SIUnitExpression.h
@@ -18,87 +19,128 @@
  * can be easily manipulated for grouping, sorting, and cancellation operations.
  */
 #pragma mark - Data Structures
+/*! @brief Terms an SIUnitTermList holds before it spills into its arena. */
+#define SIUE_INLINE_TERMS 8
 /*!
  * @struct SIUnitTerm
  * @brief Represents a single unit symbol with its power.
  *
  * A term consists of a unit symbol (e.g., "m", "kg") and an integer power.
  * This is the basic building block for representing unit expressions.
+ * The symbol is interned: it is the token library's own string and is
+ * neither retained nor released by the term.
  */
 typedef struct SIUnitTerm {
-    OCStringRef symbol; /*!< Unit symbol (e.g., "m", "kg") */
+    OCStringRef symbol; /*!< Interned unit symbol (e.g., "m", "kg") */
+    int32_t token;      /*!< Index of symbol in SIUnitGetTokenSymbolsLib(), or -1 for the dimensionless " " */
     int power;          /*!< Power of the symbol (can be negative) */
 } SIUnitTerm;
+/*!
+ * @struct SIUnitTermList
+ * @brief A short list of terms stored inline.
+ *
+ * Unit expressions rarely hold more than a handful of terms, so the first
+ * SIUE_INLINE_TERMS live inside the list itself.  Longer lists move to a
+ * buffer allocated from the parse arena.  Use siueTermListGetTerms to reach
+ * the terms wherever they live.
+ */
+typedef struct SIUnitTermList {
+    SIUnitTerm *spill;                        /*!< Arena buffer once the list outgrows inlineTerms, else NULL */
+    uint32_t count;                           /*!< Number of terms */
+    uint32_t capacity;                        /*!< Terms the current storage can hold */
+    SIUnitTerm inlineTerms[SIUE_INLINE_TERMS]; /*!< Storage for short lists */
+} SIUnitTermList;
 /*!
  * @struct SIUnitExpression
  * @brief Represents a complete unit expression with numerator and denominator.
  *
- * An expression consists of two arrays of terms: one for the numerator
+ * An expression consists of two term lists: one for the numerator
  * and one for the denominator. This allows for easy manipulation of
  * expressions like "kg•m^2/s^2".
  */
 typedef struct SIUnitExpression {
-    OCArrayRef numerator;   /*!< Array of SIUnitTerm for numerator */
-    OCArrayRef denominator; /*!< Array of SIUnitTerm for denominator */
+    SIUnitTermList numerator;   /*!< Terms of the numerator */
+    SIUnitTermList denominator; /*!< Terms of the denominator */
 } SIUnitExpression;
+/*!
+ * @struct SIUnitExpressionParseContext
+ * @brief Per-call parser state handed to the reentrant siue parser and scanner.
+ *
+ * See SIUnitParseContext in SIUnitParser.h.
+ */
+typedef struct SIUnitExpressionParseContext {
+    SIUnitExpression *parsed; /*!< Expression produced by the start rule, owned by the context */
+    OCStringRef error;        /*!< Error raised by the grammar or the scanner */
+    SIArena *arena;           /*!< Owns every term list and expression the parse creates */
+} SIUnitExpressionParseContext;
 #pragma mark - Term Management
 /*!
- * @brief Creates a new unit term with the specified symbol and power.
+ * @brief Resolves a scanned symbol to an interned term with power 1.
  *
- * @param symbol The unit symbol (ownership transferred to the term)
- * @param power The power of the symbol
- * @return A new SIUnitTerm structure, or NULL on failure
+ * @param text The symbol as scanned
+ * @param term Receives the interned symbol and its token ID
+ * @return true if text is a token unit symbol, false otherwise
+ */
+bool siueLookupTokenSymbol(const char *text, SIUnitTerm *term);
+/*!
+ * @brief Prepares an empty term list.
  *
- * @note The caller is responsible for releasing the returned term with siueReleaseTerm()
+ * @param list The list to initialize
  */
-SIUnitTerm *siueCreateTerm(OCStringRef symbol, int power);
+void siueTermListInit(SIUnitTermList *list);
 /*!
- * @brief Creates a copy of an existing term.
+ * @brief Returns the terms of a list, inline or spilled.
  *
- * @param term The term to copy
- * @return A new SIUnitTerm structure, or NULL on failure
+ * @param list The list
+ * @return Pointer to list->count contiguous terms
+ */
+SIUnitTerm *siueTermListGetTerms(SIUnitTermList *list);
+/*!
+ * @brief Appends a term, spilling the list into the arena when it is full.
  *
- * @note The caller is responsible for releasing the returned term with siueReleaseTerm()
+ * @param arena The arena that receives spilled storage
+ * @param list The list to extend
+ * @param term The term to append
+ * @return true on success, false if memory is exhausted
  */
-SIUnitTerm *siueCopyTerm(const SIUnitTerm *term);
+bool siueTermListAppend(SIArena *arena, SIUnitTermList *list, SIUnitTerm term);
 /*!
- * @brief Releases a unit term and its associated memory.
+ * @brief Appends every term of another list.
  *
- * @param term The term to release (can be NULL)
+ * @param arena The arena that receives spilled storage
+ * @param list The list to extend
+ * @param other The terms to append (can be NULL)
+ * @return true on success, false if memory is exhausted
  */
-void siueReleaseTerm(SIUnitTerm *term);
+bool siueTermListAppendList(SIArena *arena, SIUnitTermList *list, const SIUnitTermList *other);
+/*!
+ * @brief Creates a term list holding a single term.
+ *
+ * @param arena The arena that owns the list
+ * @param term The first term
+ * @return A new list, or NULL on failure
+ */
+SIUnitTermList *siueCreateTermList(SIArena *arena, SIUnitTerm term);
 #pragma mark - Expression Management
 /*!
  * @brief Creates a new unit expression with the specified numerator and denominator.
  *
- * @param numerator Array of SIUnitTerm for the numerator (ownership transferred)
- * @param denominator Array of SIUnitTerm for the denominator (ownership transferred, can be NULL)
+ * @param arena The arena that owns the expression
+ * @param numerator Terms for the numerator (copied, can be NULL)
+ * @param denominator Terms for the denominator (copied, can be NULL)
  * @return A new SIUnitExpression structure, or NULL on failure
  *
- * @note The caller is responsible for releasing the returned expression with siueRelease()
+ * @note The expression holds no references; it goes away with its arena.
  */
-SIUnitExpression *siueCreateExpression(OCArrayRef numerator, OCArrayRef denominator);
+SIUnitExpression *siueCreateExpression(SIArena *arena, const SIUnitTermList *numerator, const SIUnitTermList *denominator);
 /*!
  * @brief Creates a copy of an existing expression.
  *
+ * @param arena The arena that owns the copy
  * @param expr The expression to copy
  * @return A new SIUnitExpression structure, or NULL on failure
- *
- * @note The caller is responsible for releasing the returned expression with siueRelease()
  */
-SIUnitExpression *siueCopyExpression(const SIUnitExpression *expr);
-/*!
- * @brief Releases a unit expression and its associated memory.
- *
- * @param expr The expression to release (can be NULL)
- */
-void siueRelease(SIUnitExpression *expr);
-/*!
- * @brief Releases an array of terms and their associated memory.
- *
- * @param term_array The array of terms to release (can be NULL)
- */
-void siueReleaseTermArray(OCArrayRef term_array);
+SIUnitExpression *siueCopyExpression(SIArena *arena, const SIUnitExpression *expr);
 #pragma mark - Parser Helper Functions
 /*!
  * @brief Applies a power to all terms in a term list.
@@ -110,7 +152,15 @@ void siueReleaseTermArray(OCArrayRef term_array);
  * @param power The power to apply to each term
  * @return The modified term list
  */
-OCArrayRef siueApplyPowerToTermList(OCArrayRef term_list, int power);
+SIUnitTermList *siueApplyPowerToTermList(SIUnitTermList *term_list, int power);
+/*!
+ * @brief Applies a fractional power to a term list, validating that the result has integer powers.
+ *
+ * @param term_list The list of terms to modify
+ * @param power The fractional power to apply
+ * @return The modified term list if all resulting powers are integers, NULL otherwise
+ */
+SIUnitTermList *siueApplyFractionalPowerToTermList(SIUnitTermList *term_list, double power);
 /*!
  * @brief Applies a power to a full unit expression (numerator and denominator).
  *
@@ -127,43 +177,34 @@ SIUnitExpression *siueApplyPowerToExpression(SIUnitExpression *expression, int p
  * @return The modified expression if all resulting powers are integers, NULL otherwise
  */
 SIUnitExpression *siueApplyFractionalPowerToExpression(SIUnitExpression *expression, double power);
-/*!
- * @brief Gets the parsed expression from the parser.
- *
- * @return The currently parsed expression, or NULL if none
- */
-SIUnitExpression *siueGetParsedExpression(void);
-/*!
- * @brief Sets the parsed expression (used by parser).
- *
- * @param expr The expression to set as the current parsed expression
- */
-void siueSetParsedExpression(SIUnitExpression *expr);
-/*!
- * @brief Clears the parsed expression and releases its memory.
- */
-void siueClearParsedExpression(void);
 #pragma mark - Processing Functions
 /*!
- * @brief Groups identical terms in a term list by combining their powers.
+ * @brief Sorts terms alphabetically by symbol, combining the powers of identical symbols.
  *
- * This function combines terms with the same symbol by adding their powers.
- * For example, "m*m^2" becomes "m^3".
+ * Each term is inserted into the sorted prefix of the list, or added to the
+ * term already there, so "m*kg*m^2" becomes "kg•m^3" in one pass.  Terms
+ * whose powers sum to zero are dropped.
  *
- * @param terms Mutable array of SIUnitTerm to process
+ * @param terms The list to process
  */
-void siueGroupIdenticalTerms(OCMutableArrayRef terms);
+void siueSortAndGroupTerms(SIUnitTermList *terms);
 /*!
- * @brief Sorts terms alphabetically by symbol.
+ * @brief Moves numerator terms with negative powers to the denominator.
  *
- * @param terms Mutable array of SIUnitTerm to sort
+ * Converts m^-2 → 1/m^2 for proper formatting.
+ *
+ * @param arena The arena that receives spilled storage
+ * @param expr The expression to modify
+ * @return true on success, false if memory is exhausted
  */
-void siueSortTermsAlphabetically(OCMutableArrayRef terms);
+bool siueMoveNegativePowersToDenominator(SIArena *arena, SIUnitExpression *expr);
 /*!
  * @brief Cancels terms between numerator and denominator.
  *
  * This function performs algebraic reduction by subtracting powers of
- * identical symbols between numerator and denominator.
+ * identical symbols between numerator and denominator.  Both lists must
+ * already be sorted and grouped by siueSortAndGroupTerms; they are walked
+ * together in a single merge and stay sorted.
  *
  * @param expr The expression to reduce
  */
@@ -178,6 +219,66 @@ void siueCancelTerms(SIUnitExpression *expr);
  * @note The caller is responsible for releasing the returned string
  */
 OCStringRef siueCreateFormattedExpression(const SIUnitExpression *expr, bool reduced);
+#pragma mark - Canonical Keys
+/*! @brief Most distinct tokens a canonical key holds in each of its numerator and denominator. */
+#define SIUE_CANONICAL_KEY_MAX_TOKENS 32
+/*!
+ * @brief Computes the token-ID key under which an expression's unit is filed.
+ *
+ * The key is the numerator pair count followed by the numerator and then the
+ * denominator (token ID, power) pairs, each sorted by token ID.  Terms are
+ * grouped exactly as SIUnitCreateCleanedExpression groups them, so two
+ * expressions share a key exactly when they share a cleaned expression.
+ * Token IDs are indices into SIUnitGetTokenSymbolsLib().
+ *
+ * @param expression The unit expression
+ * @param key Receives the key
+ * @param capacity Number of int32_t elements key can hold
+ * @return The number of elements written, or 0 if the expression does not
+ *         parse, uses a symbol outside the token library or does not fit
+ */
+size_t siueCreateCanonicalKey(OCStringRef expression, int32_t *key, size_t capacity);
+/*!
+ * @struct SIUnitCanonicalParse
+ * @brief One normalized parse of a unit expression, from which both its
+ *        canonical key and its cleaned expression are read.
+ *
+ * A lookup that tries the canonical key first and falls back to the cleaned
+ * string parses the expression once instead of twice.
+ */
+typedef struct SIUnitCanonicalParse {
+    SIArena arena;               /*!< Owns the parsed terms */
+    OCStringRef expression;      /*!< The expression, borrowed from the caller */
+    SIUnitExpression *parsed;    /*!< NULL if the expression is empty, passed through unparsed or invalid */
+} SIUnitCanonicalParse;
+/*!
+ * @brief Normalizes and parses an expression into a stack-allocated parse.
+ *
+ * Always pair with siueCanonicalParseDestroy.
+ *
+ * @param parse The parse to initialize
+ * @param expression The unit expression; must outlive the parse
+ */
+void siueCanonicalParseInit(SIUnitCanonicalParse *parse, OCStringRef expression);
+/*!
+ * @brief Computes the canonical key of a parse, as siueCreateCanonicalKey does.
+ *
+ * Must be called before siueCanonicalParseCreateCleanedExpression, which
+ * consumes the parsed tree.
+ *
+ * @return The number of elements written, or 0 as for siueCreateCanonicalKey
+ */
+size_t siueCanonicalParseGetKey(const SIUnitCanonicalParse *parse, int32_t *key, size_t capacity);
+/*!
+ * @brief Creates the expression SIUnitCreateCleanedExpression would return.
+ *
+ * Groups and sorts the parsed terms in place, so it may be called once.
+ *
+ * @return The cleaned expression (caller releases), or NULL on failure
+ */
+OCStringRef siueCanonicalParseCreateCleanedExpression(SIUnitCanonicalParse *parse);
+/*! @brief Frees everything a parse holds. */
+void siueCanonicalParseDestroy(SIUnitCanonicalParse *parse);
 #pragma mark - Validation Functions
 /*!
  * @brief Validates that a symbol is in the allowed token symbols array.
@@ -196,16 +297,19 @@ bool siueValidateSymbol(OCStringRef symbol);
  */
 SIUnitExpression *siueParseExpression(OCStringRef normalized_expr);
 /*!
- * @brief Comprehensive cleanup of all parser state and internal buffers.
+ * @brief Parses a normalized expression with the reentrant siue parser.
  *
- * Call this function to completely reset parser state, including lexer buffers,
- * global variables, and any accumulated internal state. Recommended for use
- * at the end of test suites or intensive parsing operations.
+ * @param arena Arena for every term and expression the parse creates; it must
+ *              outlive the returned expression
+ * @param normalized_expr The normalized expression string to parse
+ * @return A parsed expression owned by the arena, or NULL on failure or unknown symbols
  */
-void siueCleanupParserState(void);
-#pragma mark - External Variables
+SIUnitExpression *siueCreateParsedExpression(SIArena *arena, OCStringRef normalized_expr);
 /*!
- * @brief Global error string for parser errors.
+ * @brief Retained for source compatibility.
+ *
+ * The parser keeps all of its state in a per-call context, so there is no
+ * longer any global parser state to reset.
  */
-extern OCStringRef siueError;
+void siueCleanupParserState(void);
 #endif /* SIUnitExpression_h */
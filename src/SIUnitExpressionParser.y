@@ -2,37 +2,34 @@
     #include <stdio.h>
     #include "SITypes.h"
     #include "SIUnitExpression.h"
-
-    void siueerror(char *s, ...);
-
-    // External variables and functions defined in SIUnitExpression.c
-    extern OCStringRef siueError;
-
-    // External lexer function
-    int siuelex(void);
 %}
 
 %name-prefix="siue"
+%define api.pure full
+%parse-param {SIUnitExpressionParseContext *ctx} {void *scanner}
+%lex-param {void *scanner}
 
 %union {
-    OCStringRef unit_symbol;
+    SIUnitTerm term;
     int iVal;
     double dVal;
-    SIUnitTerm* term;
-    OCArrayRef term_list;
+    SIUnitTermList* term_list;
     SIUnitExpression* expression;
 }
 
-%token <unit_symbol> UNIT_SYMBOL
+%token <term> UNIT_SYMBOL
 %token <iVal> INTEGER
 %token <dVal> DECIMAL
 %token UNKNOWN_SYMBOL
 
-/* Destructors for proper cleanup on error */
-%destructor { if ($$) OCRelease($$); } UNIT_SYMBOL
-%destructor { if ($$) siueReleaseTerm($$); } unit_term
-%destructor { if ($$) siueReleaseTermArray($$); } term_list
-%destructor { if ($$) siueRelease($$); } expression
+/* Terms, term lists and expressions live in ctx->arena and symbols are
+   interned, so nothing needs a destructor on error */
+
+%code {
+    // Reentrant lexer generated from SIUnitExpressionScanner.l
+    int siuelex(YYSTYPE *lvalp, void *scanner);
+    void siueerror(SIUnitExpressionParseContext *ctx, void *scanner, const char *s);
+}
 
 %type <term> unit_term
 %type <term_list> term_list
@@ -44,81 +41,56 @@
 %%
 
 /* Grammar rules */
-input: expression { siueSetParsedExpression($1); }
+input: expression {
+    ctx->parsed = $1;
+}
      ;
 
 expression: term_list {
-    $$ = siueCreateExpression($1, NULL);
-    siueReleaseTermArray($1);  // Release the term array and its terms since siueCreateExpression copied them
+    $$ = siueCreateExpression(ctx->arena, $1, NULL);
 }
 | INTEGER {
     // Handle standalone integer (dimensionless unit)
     if ($1 == 1) {
         // Create dimensionless term with space symbol
-        SIUnitTerm* dimensionless = siueCreateTerm(STR(" "), 1);
-        OCMutableArrayRef termArray = OCArrayCreateMutable(1, NULL);
-        OCArrayAppendValue(termArray, dimensionless);
-        $$ = siueCreateExpression(termArray, NULL);
-        OCRelease(termArray);
-        siueReleaseTerm(dimensionless);  // Release the term after copying into expression
+        SIUnitTerm dimensionless = {STR(" "), -1, 1};
+        $$ = siueCreateExpression(ctx->arena, NULL, NULL);
+        if ($$) siueTermListAppend(ctx->arena, &$$->numerator, dimensionless);
     } else {
-        siueError = STR("Only '1' is allowed as a standalone number");
+        ctx->error = STR("Only '1' is allowed as a standalone number");
         YYERROR;
     }
 }
 | INTEGER '/' term_list {
     // Handle expressions like "1/m" - numerator is empty, denominator has the terms
     if ($1 == 1) {
-        // Create empty numerator, put terms in denominator
-        OCMutableArrayRef emptyNum = OCArrayCreateMutable(0, NULL);
-        $$ = siueCreateExpression(emptyNum, $3);
-        OCRelease(emptyNum);
-        siueReleaseTermArray($3);  // Release the term_list and its terms since siueCreateExpression copied them
+        $$ = siueCreateExpression(ctx->arena, NULL, $3);
     } else {
-        siueError = STR("Only '1' is allowed as a numeric coefficient");
-        siueReleaseTermArray($3);  // Clean up the term_list before error
+        ctx->error = STR("Only '1' is allowed as a numeric coefficient");
         YYERROR;
     }
 }
 | INTEGER '/' '(' term_list ')' {
     // Handle expressions like "1/(m*s)" - numerator is empty, denominator has the terms
     if ($1 == 1) {
-        // Create empty numerator, put terms in denominator
-        OCMutableArrayRef emptyNum = OCArrayCreateMutable(0, NULL);
-        $$ = siueCreateExpression(emptyNum, $4);
-        OCRelease(emptyNum);
-        siueReleaseTermArray($4);  // Release the term_list and its terms since siueCreateExpression copied them
+        $$ = siueCreateExpression(ctx->arena, NULL, $4);
     } else {
-        siueError = STR("Only '1' is allowed as a numeric coefficient");
-        siueReleaseTermArray($4);  // Clean up the term_list before error
+        ctx->error = STR("Only '1' is allowed as a numeric coefficient");
         YYERROR;
     }
 }
 | term_list '/' term_list {
-    $$ = siueCreateExpression($1, $3);
-    siueReleaseTermArray($1);  // Release since siueCreateExpression copied it
-    siueReleaseTermArray($3);  // Release since siueCreateExpression copied it
+    $$ = siueCreateExpression(ctx->arena, $1, $3);
 }
 | expression '/' unit_term {
     // For chained division like a/b/c, add c to denominator
-    OCMutableArrayRef newDen = $1->denominator ? OCArrayCreateMutableCopy($1->denominator) : OCArrayCreateMutable(1, NULL);
-    OCArrayAppendValue(newDen, $3);
-    $$ = siueCreateExpression($1->numerator, newDen);
-    OCRelease(newDen);  // Just release the array, not the terms (they're copied by siueCreateExpression)
-    siueReleaseTerm($3);  // Release the unit_term since it was copied into the expression
-    siueRelease($1);  // Free the intermediate expression
+    if (!$1 || !siueTermListAppend(ctx->arena, &$1->denominator, $3)) YYABORT;
+    $$ = $1;
 }
 | expression '/' '(' term_list ')' {
     // For division by parenthetical expression like a/(b*c)
-    OCMutableArrayRef newDen = $1->denominator ? OCArrayCreateMutableCopy($1->denominator) : OCArrayCreateMutable(1, NULL);
-    OCIndex count = OCArrayGetCount($4);
-    for (OCIndex i = 0; i < count; i++) {
-        OCArrayAppendValue(newDen, OCArrayGetValueAtIndex($4, i));
-    }
-    $$ = siueCreateExpression($1->numerator, newDen);
-    OCRelease(newDen);
-    siueRelease($1);  // Free the intermediate expression
-    siueReleaseTermArray($4);    // Release the term_list and its terms since they were copied
+    if (!$1 || !siueTermListAppendList(ctx->arena, &$1->denominator, $4)) YYABORT;
+    $$ = $1;
 }
 | '(' expression ')' '^' INTEGER {
     // Handle parenthetical expression raised to power: (a/b)^n
@@ -128,8 +100,8 @@ expression: term_list {
     // Handle parenthetical expression raised to decimal power: (a/b)^0.5
     $$ = siueApplyFractionalPowerToExpression($2, $5);
     if (!$$) {
-        // If fractional power was rejected, we need to clean up the expression
-        siueRelease($2);
+        ctx->error = STR("Fractional power must leave integer exponents");
+        YYERROR;
     }
 }
 | '(' expression ')' '^' '(' INTEGER ')' {
@@ -143,24 +115,17 @@ expression: term_list {
 ;
 
 term_list: unit_term {
-    $$ = (OCArrayRef)OCArrayCreateMutable(0, NULL);
-    OCArrayAppendValue((OCMutableArrayRef)$$, $1);
+    $$ = siueCreateTermList(ctx->arena, $1);
+    if (!$$) YYABORT;
 }
 | term_list '*' unit_term {
-    OCArrayAppendValue((OCMutableArrayRef)$1, $3);
+    if (!siueTermListAppend(ctx->arena, $1, $3)) YYABORT;
     $$ = $1;
 }
 | term_list '*' '(' term_list ')' {
     // Handle multiplication with parenthetical expression: term_list * (term_list)
-    // We need to copy the terms from $4 to $1, then release $4 properly
-    OCIndex count = OCArrayGetCount($4);
-    for (OCIndex i = 0; i < count; i++) {
-        SIUnitTerm* term = (SIUnitTerm*)OCArrayGetValueAtIndex($4, i);
-        SIUnitTerm* termCopy = siueCopyTerm(term);  // Make a copy for $1
-        OCArrayAppendValue((OCMutableArrayRef)$1, termCopy);
-    }
+    if (!siueTermListAppendList(ctx->arena, $1, $4)) YYABORT;
     $$ = $1;
-    siueReleaseTermArray($4);  // Release the source array and its terms
 }
 | '(' term_list ')' {
     $$ = $2;
@@ -169,39 +134,29 @@ term_list: unit_term {
     $$ = siueApplyPowerToTermList($2, $5);
 }
 | '(' term_list ')' '^' DECIMAL {
-    // Handle decimal power for term lists - convert to expression, apply power, extract numerator
-    SIUnitExpression* temp_expr = siueCreateExpression($2, NULL);
-    if (temp_expr && siueApplyFractionalPowerToExpression(temp_expr, $5)) {
-        // Extract the numerator from the modified expression
-        $$ = temp_expr->numerator;
-        // Don't retain - the array already has refcount=1 from creation
-        // Properly clean up the expression - set numerator to NULL first to avoid double-free
-        temp_expr->numerator = NULL;
-        siueRelease(temp_expr);
-    } else {
-        $$ = NULL;
-        if (temp_expr) siueRelease(temp_expr);
+    // Handle decimal power for term lists; every resulting power must be an integer
+    $$ = siueApplyFractionalPowerToTermList($2, $5);
+    if (!$$) {
+        ctx->error = STR("Fractional power must leave integer exponents");
+        YYERROR;
     }
-    // $2 was already copied by siueCreateExpression, so we still need to clean it up
-    siueReleaseTermArray($2);
 }
 ;
 
 unit_term: UNIT_SYMBOL {
-    $$ = siueCreateTerm($1, 1);
-    OCRelease($1);  // Release the string from lexer since siueCreateTerm copied it
+    $$ = $1;
 }
 | UNIT_SYMBOL '^' INTEGER {
-    $$ = siueCreateTerm($1, $3);
-    OCRelease($1);  // Release the string from lexer since siueCreateTerm copied it
+    $$ = $1;
+    $$.power = $3;
 }
 | UNIT_SYMBOL '^' '(' INTEGER ')' {
-    $$ = siueCreateTerm($1, $4);
-    OCRelease($1);  // Release the string from lexer since siueCreateTerm copied it
+    $$ = $1;
+    $$.power = $4;
 }
 | UNKNOWN_SYMBOL {
-    if (!siueError) {
-        siueError = STR("Unknown unit symbol");
+    if (!ctx->error) {
+        ctx->error = STR("Unknown unit symbol");
     }
     YYERROR;
 }
@@ -209,8 +164,9 @@ unit_term: UNIT_SYMBOL {
 
 %%
 
-void siueerror(char *s, ...) {
-    if (!siueError) {
-        siueError = OCStringCreateWithCString(s);
+void siueerror(SIUnitExpressionParseContext *ctx, void *scanner, const char *s) {
+    (void)scanner;
+    if (!ctx->error) {
+        ctx->error = OCStringCreateWithCString(s);
     }
 }
@@ -7,7 +7,23 @@
 #ifndef SIUnitParser_h
 #define SIUnitParser_h
 #include "SITypes.h"  // for OCStringRef, SIUnitRef
-extern OCStringRef unitError;
+/**
+ * @brief Per-call state shared by the unit expression parser and scanner.
+ *
+ * One context lives on the stack of each SIUnitFromExpressionInternal call and is
+ * handed to the reentrant scanner as its extra data.  The dimensionality, unit
+ * expression and scalar parsers follow the same pattern with their own context
+ * types: no parse state lives in globals, so a parse that starts another (a
+ * scalar literal resolving its unit, say) cannot clobber the outer one.  This
+ * does not make parsing thread-safe, since every parser still reads and fills
+ * the shared unit library and its caches.
+ */
+typedef struct SIUnitParseContext {
+    SIUnitRef final_unit;     // result of the last complete expression
+    OCStringRef error;        // semantic error raised by a grammar action or the scanner
+    double *unit_multiplier;  // accumulated multiplier, owned by the caller
+    bool syntax_error;        // set by the parser's error routine
+} SIUnitParseContext;
 /**
  * @brief Returns the SI unit for a parsed symbol string.
  *
@@ -23,6 +39,19 @@ extern OCStringRef unitError;
  @result The equivalent SI unit as SIUnitRef, or NULL on error.
  */
 SIUnitRef SIUnitFromExpressionInternal(OCStringRef string, double *unit_multiplier, OCStringRef *error);
+/**
+ * @brief Finds the longest token unit symbol at the start of a UTF-8 run.
+ *
+ * Matching walks a trie built from the live token symbol library, so units
+ * registered at runtime tokenize like the built-in ones.
+ *
+ * @param text The bytes to match; need not be NUL-terminated.
+ * @param length Number of bytes available at text.
+ * @param unit Receives the unit filed under the matched symbol, which is NULL
+ *             if that unit has left the library; untouched when nothing matches.
+ * @result The length in bytes of the longest matching symbol, or 0 if none matches.
+ */
+size_t SIUnitMatchTokenSymbol(const char *text, size_t length, SIUnitRef *unit);
 /**
  * @brief Normalize a unit symbol string for consistent parsing and library lookup.
  *
@@ -2,15 +2,12 @@
     #include <stdio.h>
     #include "SITypes.h"
     #include "SIUnitParser.h"
-
-    void yyerror(char *s, ...);
-    static SIUnitRef final_unit;
-    OCStringRef unitError;
-    static double *unit_multiplier_ref;
-    int siulex(void);
     %}
 
 %name-prefix="siu"
+%define api.pure full
+%parse-param {SIUnitParseContext *ctx} {void *scanner}
+%lex-param {void *scanner}
 
 %union {
     SIUnitRef unit;
@@ -20,28 +17,33 @@
 %token <unit> UNIT
 %token <iVal> INTEGER
 %token DECIMAL
+%code {
+    int siulex(YYSTYPE *lvalp, void *scanner);
+    void yyerror(SIUnitParseContext *ctx, void *scanner, const char *s);
+}
+
 %type <unit> exp calclist
 %left '*' '/'
 %left '^'
 %%
 calclist: /* do nothing */ { $$ = NULL; }
-| calclist exp {final_unit = $2;}
+| calclist exp {ctx->final_unit = $2;}
 ;
 
 exp: '(' exp ')' {$$ = $2;}
-| exp '*' exp {$$ = SIUnitByMultiplyingWithoutReducing($1,$3,unit_multiplier_ref, &unitError);}
-| exp '/' exp {$$ = SIUnitByDividingWithoutReducing($1,$3,unit_multiplier_ref, &unitError);}
-| exp '^' INTEGER {$$ = SIUnitByRaisingToPowerWithoutReducing($1,$3,unit_multiplier_ref, &unitError);}
+| exp '*' exp {$$ = SIUnitByMultiplyingWithoutReducing($1,$3,ctx->unit_multiplier, &ctx->error);}
+| exp '/' exp {$$ = SIUnitByDividingWithoutReducing($1,$3,ctx->unit_multiplier, &ctx->error);}
+| exp '^' INTEGER {$$ = SIUnitByRaisingToPowerWithoutReducing($1,$3,ctx->unit_multiplier, &ctx->error);}
 | exp '^' DECIMAL {
-    unitError = STR("Fractional powers are not allowed in unit expressions");
-    yyerror("Fractional powers are not allowed");
+    ctx->error = STR("Fractional powers are not allowed in unit expressions");
+    yyerror(ctx, scanner, "Fractional powers are not allowed");
     $$ = NULL;
 }
 | INTEGER '/' exp {
-    if($1 == 1) {$$ = SIUnitByRaisingToPowerWithoutReducing($3,-1,unit_multiplier_ref, &unitError);}
+    if($1 == 1) {$$ = SIUnitByRaisingToPowerWithoutReducing($3,-1,ctx->unit_multiplier, &ctx->error);}
     else  {
-        unitError = STR("Unknown unit symbol");
-        yyerror("Unknown unit symbol");
+        ctx->error = STR("Unknown unit symbol");
+        yyerror(ctx, scanner, "Unknown unit symbol");
     }
 }
 | UNIT
@@ -49,9 +51,11 @@ exp: '(' exp ')' {$$ = $2;}
 
 %%
 
-extern int siu_scan_string(const char *);
-extern void siulex_destroy(void);
-bool siu_syntax_error;
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+extern int siulex_init_extra(SIUnitParseContext *ctx, void **scanner);
+extern YY_BUFFER_STATE siu_scan_string(const char *str, void *scanner);
+extern void siu_delete_buffer(YY_BUFFER_STATE buffer, void *scanner);
+extern int siulex_destroy(void *scanner);
 
 SIUnitRef SIUnitFromExpressionInternal(OCStringRef string, double *unit_multiplier, OCStringRef *error)
 {
@@ -66,24 +70,27 @@ SIUnitRef SIUnitFromExpressionInternal(OCStringRef string, double *unit_multipli
         return SIUnitDimensionlessAndUnderived();
     }
 
-    final_unit = NULL;
-    unitError = NULL;
-    unit_multiplier_ref = unit_multiplier;
-    siu_syntax_error = false;
+    // Per-call parse state; see SIUnitParseContext
+    SIUnitParseContext ctx = {NULL, NULL, unit_multiplier, false};
     uint64_t length = OCStringGetLength(mutString);
     if(length) {
         const char *cString = OCStringGetCString(mutString);
-        siu_scan_string(cString);
-        siuparse();
-        siulex_destroy();
-        OCRelease(mutString);
+        void *scanner = NULL;
+        if(siulex_init_extra(&ctx, &scanner) == 0) {
+            YY_BUFFER_STATE buffer = siu_scan_string(cString, scanner);
+            siuparse(&ctx, scanner);
+            siu_delete_buffer(buffer, scanner);
+            siulex_destroy(scanner);
+        }
+        else ctx.error = STR("Unable to create unit expression scanner");
     }
+    OCRelease(mutString);
 
-    if(siu_syntax_error || unitError) {
+    if(ctx.syntax_error || ctx.error) {
         if(error) {
-            if(unitError) {
+            if(ctx.error) {
                 // Prefer specific semantic error messages over generic syntax error
-                *error = unitError;
+                *error = ctx.error;
             } else if(!(*error)) {
                 // Only set generic syntax error if no specific error was set
                 *error = STR("Invalid expression: syntax error");
@@ -91,11 +98,12 @@ SIUnitRef SIUnitFromExpressionInternal(OCStringRef string, double *unit_multipli
         }
         return NULL;
     }
-    return final_unit;
+    return ctx.final_unit;
 }
 
-void yyerror(char *s, ...)
+void yyerror(SIUnitParseContext *ctx, void *scanner, const char *s)
 {
-    (void)s;  // Unused parameter - required by bison parser generator convention
-    siu_syntax_error = true;
+    (void)scanner;  // Unused parameter - required by bison parser generator convention
+    (void)s;
+    ctx->syntax_error = true;
 }
@@ -0,0 +1,97 @@
+#!/usr/bin/env python3
+"""Generate SIUnitRegistry.h from the CSV written by SIUnitLibraryDumpCSV().
+
+Usage: SIUnitRegistry.py units.csv > SIUnitRegistry.h
+"""
+import csv
+import sys
+from collections import OrderedDict
+
+BASE_DIMENSION_COUNT = 7
+
+def c_string(s: str) -> str:
+    out = []
+    for b in s.encode('utf-8'):
+        if b in (0x22, 0x5C):
+            out.append('\\' + chr(b))
+        elif 0x20 <= b < 0x7F and b != 0x3F:
+            out.append(chr(b))
+        else:
+            out.append(f'\\{b:03o}')
+    return '"' + ''.join(out) + '"'
+
+def read_rows(path):
+    units, keys, tokens = [], [], []
+    quantities, dimensionalities = OrderedDict(), OrderedDict()
+    with open(path, newline='', encoding='utf-8') as f:
+        for lineno, row in enumerate(csv.reader(f), 1):
+            if not row:
+                continue
+            tag = row[0]
+            if tag == 'U':
+                if len(row) != 4 + 2 * BASE_DIMENSION_COUNT + 2:
+                    sys.exit(f"Line {lineno}: malformed unit row")
+                exps = [int(x) for x in row[4:4 + 2 * BASE_DIMENSION_COUNT]]
+                scale = float.fromhex(row[-2])
+                units.append((row[1], row[2], row[3], exps[0::2], exps[1::2], scale, int(row[-1])))
+            elif tag == 'K':
+                keys.append((row[1], int(row[2])))
+            elif tag == 'Q':
+                quantities.setdefault(row[1], []).append(int(row[2]))
+            elif tag == 'D':
+                dimensionalities.setdefault(row[1], []).append(int(row[2]))
+            elif tag == 'T':
+                tokens.append(row[1])
+            else:
+                sys.exit(f"Line {lineno}: unknown record type {tag!r}")
+    for key, index in keys:
+        if not 0 <= index < len(units):
+            sys.exit(f"Key {key!r}: unit index {index} out of range")
+    return units, keys, quantities, dimensionalities, tokens
+
+def emit_groups(name, member, groups):
+    members, first = [], 0
+    print(f"static const SIUnitRegistryGroup kSIUnitRegistry{name}[] = {{")
+    for key, indexes in groups.items():
+        print(f"    {{{c_string(key)}, {first}, {len(indexes)}}},")
+        members.extend(indexes)
+        first += len(indexes)
+    print("};")
+    print(f"static const uint32_t kSIUnitRegistry{member}Members[] = {{")
+    for i in range(0, len(members), 16):
+        print("    " + ", ".join(str(m) for m in members[i:i + 16]) + ",")
+    print("};")
+
+def emit(units, keys, quantities, dimensionalities, tokens):
+    print("// Generated by SIUnitRegistry.py from SIUnitLibraryDumpCSV() output -- do not edit.")
+    print("#pragma once")
+    print(f"enum {{ kSIUnitRegistryUnitCount = {len(units)} }};")
+    print(f"enum {{ kSIUnitRegistryKeyCount = {len(keys)} }};")
+    print(f"enum {{ kSIUnitRegistryQuantityCount = {len(quantities)} }};")
+    print(f"enum {{ kSIUnitRegistryDimensionalityCount = {len(dimensionalities)} }};")
+    print(f"enum {{ kSIUnitRegistryTokenSymbolCount = {len(tokens)} }};")
+    print("static const SIUnitRegistryUnit kSIUnitRegistryUnits[] = {")
+    for symbol, name, plural, num, den, scale, flags in units:
+        nums = ', '.join(str(e) for e in num)
+        dens = ', '.join(str(e) for e in den)
+        print(f"    {{{c_string(symbol)}, {c_string(name)}, {c_string(plural)}, "
+              f"{{{nums}}}, {{{dens}}}, {scale.hex()}, {flags}}},")
+    print("};")
+    print("static const SIUnitRegistryKey kSIUnitRegistryKeys[] = {")
+    for key, index in keys:
+        print(f"    {{{c_string(key)}, {index}}},")
+    print("};")
+    emit_groups("Quantities", "Quantity", quantities)
+    emit_groups("Dimensionalities", "Dimensionality", dimensionalities)
+    print("static const char *const kSIUnitRegistryTokenSymbols[] = {")
+    for token in tokens:
+        print(f"    {c_string(token)},")
+    print("};")
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(f"Usage: {sys.argv[0]} units.csv > SIUnitRegistry.h")
+    emit(*read_rows(sys.argv[1]))
+
+if __name__ == '__main__':
+    main()
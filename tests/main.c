@@ -10,6 +10,7 @@
 #include "test_duplicate_units.h"
 #include "test_json_typed.h"
 #include "test_octypes.h"
+#include "test_quantity_array.h"
 #include "test_scalar.h"
 #include "test_scalar_parser.h"
 #include "test_unit.h"
@@ -40,6 +41,7 @@ int main(int argc, const char *argv[]) {
     TRACK(octypesTest4);
     TRACK(octypesTest5);
     TRACK(octypesTest6);
+    TRACK(octypesTest7);
     TRACK(test_dimensionality_0);
     TRACK(test_dimensionality_1);
     TRACK(test_dimensionality_2);
@@ -52,6 +54,7 @@ int main(int argc, const char *argv[]) {
     TRACK(test_dimensionality_reduction_behavior);
     TRACK(test_dimensionality_deep_copy);
     TRACK(test_dimensionality_parser_strictness);
+    TRACK(test_dimensionality_interning);
     TRACK(test_unit_0);
     TRACK(test_unit_1);
     TRACK(test_unit_3);
@@ -71,10 +74,28 @@ int main(int argc, const char *argv[]) {
     TRACK(test_unit_by_taking_nth_root);
     TRACK(test_unit_by_raising_to_power_without_reducing);
     TRACK(test_unit_unicode_normalization);
+    TRACK(test_unit_normalization_differential);
+    TRACK(test_unit_canonical_key_lookup);
+    TRACK(test_unit_expression_long_term_lists);
+    TRACK(test_unit_expression_token_matching);
+    TRACK(test_unit_token_match_brute_force);
+    TRACK(test_unit_runtime_token_symbol);
     TRACK(test_unit_registration);
     TRACK(test_unit_canonical_expressions);
     TRACK(test_unit_from_expression_equivalence);
     TRACK(test_unit_count_token_symbols);
+    TRACK(test_unit_token_symbol_index);
+    TRACK(test_unit_with_symbol_fast_path);
+    TRACK(test_unit_expression_cache);
+    TRACK(test_unit_library_dump_csv);
+    TRACK(test_unit_registration_dedup);
+    TRACK(test_unit_find_with_name);
+    TRACK(test_unit_best_matching_unit_index);
+    TRACK(test_unit_algebra_cache);
+    TRACK(test_unit_coherent_unit_cache);
+    TRACK(test_unit_convert_buffer);
+    TRACK(test_unit_affine_temperature_conversion);
+    TRACK(test_unit_conversion_plan);
     TRACK(test_unit_expression_cleaner_basic_canonicalization);
     TRACK(test_unit_expression_cleaner_power_notation);
     TRACK(test_unit_expression_cleaner_multiplication_ordering);
@@ -109,6 +130,13 @@ int main(int argc, const char *argv[]) {
     TRACK(test_scalar_parser_12);
     TRACK(test_scalar_parser_13);
     TRACK(test_scalar_parser_infinity);
+    TRACK(test_scalar_expression_compiled);
+    TRACK(test_scalar_expression_columns);
+    TRACK(test_scalar_expression_columns_match_rows);
+    TRACK(test_scalar_parser_long_expression);
+    TRACK(test_scalar_parser_normalization);
+    TRACK(test_scalar_parser_normalization_differential);
+    TRACK(test_scalar_parser_literal_fast_path);
     TRACK(test_nmr_functions);
     TRACK(test_SIScalarGetTypeID);
     TRACK(test_SIScalarCreateCopy);
@@ -202,6 +230,11 @@ int main(int argc, const char *argv[]) {
     TRACK(test_SIScalarCreateArrayFromMixedTypeArray);
     TRACK(test_SIScalarCreateArrayFromNumberArray);
     TRACK(test_SIQuantityValidateMixedArrayForDimensionality);
+    TRACK(test_scalar_value_type);
+    TRACK(test_quantity_array_borrowed_buffer);
+    TRACK(test_quantity_array_scalar_roundtrip);
+    TRACK(test_quantity_array_json_roundtrip);
+    TRACK(test_quantity_array_json_large_roundtrip);
     TRACK(test_SIScalar_json_typed_roundtrip_simple);
     TRACK(test_SIScalar_json_typed_roundtrip_complex);
     TRACK(test_SIScalar_json_typed_roundtrip_with_units);
@@ -511,3 +511,27 @@ bool test_dimensionality_parser_strictness(void) {
     }
     return success;
 }
+bool test_dimensionality_interning(void) {
+    bool success = true;
+    OCStringRef err = NULL;
+    SIDimensionalityRef length = SIDimensionalityForBaseDimensionIndex(kSILengthIndex);
+    SIDimensionalityRef time = SIDimensionalityForBaseDimensionIndex(kSITimeIndex);
+    // Repeated operations must hand back the one interned instance
+    SIDimensionalityRef v1 = SIDimensionalityByDividing(length, time);
+    SIDimensionalityRef v2 = SIDimensionalityByDividing(length, time);
+    SIDimensionalityRef parsed = SIDimensionalityFromExpression(STR("L/T"), &err);
+    if (!v1 || v1 != v2 || v1 != parsed) {
+        printf("  ✗ L/T was not interned to a single instance\n");
+        success = false;
+    }
+    // A dimensionality first created by an operation still gets its symbol and library entry
+    SIDimensionalityRef odd = SIDimensionalityByRaisingToPower(v1, 7);
+    OCStringRef symbol = odd ? SIDimensionalityCopySymbol(odd) : NULL;
+    if (!symbol || !OCStringEqual(symbol, STR("L^7/T^7")) || SIDimensionalityFromExpression(symbol, &err) != odd) {
+        printf("  ✗ Lazily formatted symbol missing or not registered\n");
+        success = false;
+    }
+    if (symbol) OCRelease(symbol);
+    if (err) OCRelease(err);
+    return success;
+}
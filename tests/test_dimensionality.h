@@ -13,4 +13,5 @@ bool test_dimensionality_power_area(void);
 bool test_dimensionality_reduction_behavior(void);
 bool test_dimensionality_deep_copy(void);
 bool test_dimensionality_parser_strictness(void);
+bool test_dimensionality_interning(void);
 #endif /* TEST_DIMENSIONALITY_H */
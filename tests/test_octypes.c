@@ -105,3 +105,29 @@ bool octypesTest6(void) {
     OCRelease(array);
     return success;
 }
+// Each listed SITypes type is registered with its own ID, and the list agrees
+// with SILIB_TYPES_COUNT.  A new type must be added here by hand: OCTypes
+// cannot enumerate the types one library registered, so this cannot detect an
+// omission from both the list and the macro.
+bool octypesTest7(void) {
+    OCTypeID ids[] = {SIDimensionalityGetTypeID(), SIUnitGetTypeID(), SIScalarGetTypeID(),
+                      SIQuantityArrayGetTypeID(), SIUnitConversionPlanGetTypeID(), SIScalarExpressionGetTypeID()};
+    size_t count = sizeof(ids) / sizeof(ids[0]);
+    for (size_t i = 0; i < count; i++) {
+        if (ids[i] == kOCNotATypeID) {
+            printf("  ✗ type %zu is not registered\n", i);
+            return false;
+        }
+        for (size_t j = 0; j < i; j++) {
+            if (ids[i] == ids[j]) {
+                printf("  ✗ types %zu and %zu share an ID\n", j, i);
+                return false;
+            }
+        }
+    }
+    if (count != SILIB_TYPES_COUNT) {
+        printf("  ✗ SILIB_TYPES_COUNT is %d, but %zu types are listed\n", SILIB_TYPES_COUNT, count);
+        return false;
+    }
+    return true;
+}
@@ -7,4 +7,5 @@ bool octypesTest3(void);
 bool octypesTest4(void);
 bool octypesTest5(void);
 bool octypesTest6(void);
+bool octypesTest7(void);
 #endif /* TEST_OCTYPES_H */
@@ -0,0 +1,153 @@
+//
+//  test_quantity_array.c
+//  SITypes
+//
+//  Tests for the columnar SIQuantityArray type
+//
+#include <complex.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../src/SITypes.h"
+bool test_quantity_array_borrowed_buffer(void) {
+    bool success = true;
+    OCStringRef err = NULL;
+    double samples[4] = {1.0, 2.0, 3.0, 4.0};
+    SIUnitRef m = SIUnitWithSymbol(STR("m"));
+    SIUnitRef cm = SIUnitWithSymbol(STR("cm"));
+    SIMutableQuantityArrayRef array = SIQuantityArrayCreateWithBytesNoCopy(m, kSINumberFloat64Type, samples, 4, false, &err);
+    if (!array) {
+        printf("  ✗ Failed to wrap buffer: %s\n", err ? OCStringGetCString(err) : "unknown");
+        return false;
+    }
+    // A borrowed buffer is used in place, not copied
+    if (SIQuantityArrayGetBytePtr(array) != samples || SIQuantityArrayOwnsBytes(array) ||
+        SIQuantityArrayGetCount(array) != 4 || SIQuantityArrayGetUnit(array) != m) {
+        printf("  ✗ Borrowed buffer was not wrapped as given\n");
+        success = false;
+    }
+    samples[2] = 30.0;
+    if (creal(SIQuantityArrayGetDoubleComplexValueAtIndex(array, 2)) != 30.0) {
+        printf("  ✗ Element access does not see writes to the borrowed buffer\n");
+        success = false;
+    }
+    // Stores convert into the array's unit
+    if (!SIQuantityArraySetScalarValueAtIndex(array, 0, SIScalarValueMakeWithDouble(250.0, cm), &err) ||
+        fabs(samples[0] - 2.5) > 1e-12) {
+        printf("  ✗ Store did not convert 250 cm to 2.5 m\n");
+        success = false;
+    }
+    // The shared quantity header works through the SIQuantity API
+    if (SIQuantityGetUnit((SIQuantityRef)array) != m ||
+        SIQuantityGetNumericType((SIQuantityRef)array) != kSINumberFloat64Type ||
+        !SIQuantityHasDimensionality((SIQuantityRef)array, SIUnitGetDimensionality(cm))) {
+        printf("  ✗ SIQuantityArray is not usable as an SIQuantity\n");
+        success = false;
+    }
+    if (SIQuantityArraySetScalarValueAtIndex(array, 4, SIScalarValueMakeWithDouble(1.0, m), NULL)) {
+        printf("  ✗ Out of range store should fail\n");
+        success = false;
+    }
+    OCRelease(array);
+    // Owned buffers are freed by the array
+    float *owned = malloc(3 * sizeof(float));
+    owned[0] = owned[1] = owned[2] = 1.0f;
+    SIQuantityArrayRef ownedArray = SIQuantityArrayCreateWithBytesNoCopy(NULL, kSINumberFloat32Type, owned, 3, true, &err);
+    if (!ownedArray || !SIQuantityArrayOwnsBytes(ownedArray) ||
+        SIQuantityArrayGetUnit(ownedArray) != SIUnitDimensionlessAndUnderived()) {
+        printf("  ✗ Owned dimensionless array not created as expected\n");
+        success = false;
+    }
+    if (ownedArray) OCRelease(ownedArray);
+    return success;
+}
+bool test_quantity_array_scalar_roundtrip(void) {
+    bool success = true;
+    OCStringRef err = NULL;
+    float complex values[3] = {1.0f + 2.0f * I, -0.5f, 3.0f * I};
+    SIUnitRef unit = SIUnitWithSymbol(STR("V"));
+    SIQuantityArrayRef array = SIQuantityArrayCreate(unit, kSINumberComplex64Type, values, 3, &err);
+    OCArrayRef scalars = array ? SIQuantityArrayCreateArrayOfScalars(array, &err) : NULL;
+    if (!scalars || OCArrayGetCount(scalars) != 3) {
+        printf("  ✗ Failed to expand SIQuantityArray into scalars\n");
+        if (array) OCRelease(array);
+        return false;
+    }
+    SIScalarRef second = OCArrayGetValueAtIndex(scalars, 1);
+    if (SIQuantityGetUnit((SIQuantityRef)second) != unit ||
+        SIQuantityGetNumericType((SIQuantityRef)second) != kSINumberComplex64Type ||
+        SIScalarDoubleComplexValue(second) != -0.5) {
+        printf("  ✗ Expanded scalar has the wrong unit, type or value\n");
+        success = false;
+    }
+    SIQuantityArrayRef back = SIQuantityArrayCreateWithArrayOfScalars(scalars, NULL, &err);
+    if (!back || !OCTypeEqual(array, back)) {
+        printf("  ✗ Scalars did not collapse back into an equal SIQuantityArray\n");
+        success = false;
+    }
+    // Mixed units collapse into the requested unit with the widest numeric type
+    OCMutableArrayRef mixed = OCArrayCreateMutable(2, &kOCTypeArrayCallBacks);
+    SIScalarRef a = SIScalarCreateWithFloat(1.0f, SIUnitWithSymbol(STR("km")));
+    SIScalarRef b = SIScalarCreateWithDouble(20.0, SIUnitWithSymbol(STR("m")));
+    OCArrayAppendValue(mixed, a);
+    OCArrayAppendValue(mixed, b);
+    SIQuantityArrayRef lengths = SIQuantityArrayCreateWithArrayOfScalars(mixed, SIUnitWithSymbol(STR("m")), &err);
+    if (!lengths || SIQuantityArrayGetNumericType(lengths) != kSINumberFloat64Type ||
+        ((const double *)SIQuantityArrayGetBytePtr(lengths))[0] != 1000.0 ||
+        ((const double *)SIQuantityArrayGetBytePtr(lengths))[1] != 20.0) {
+        printf("  ✗ Mixed-unit scalars were not converted into a float64 array in m\n");
+        success = false;
+    }
+    OCRelease(a);
+    OCRelease(b);
+    OCRelease(mixed);
+    if (lengths) OCRelease(lengths);
+    if (back) OCRelease(back);
+    OCRelease(scalars);
+    OCRelease(array);
+    return success;
+}
+bool test_quantity_array_json_roundtrip(void) {
+    bool success = true;
+    OCStringRef err = NULL;
+    double complex values[2] = {1.5 - 2.0 * I, 4.0};
+    SIQuantityArrayRef array = SIQuantityArrayCreate(SIUnitWithSymbol(STR("Hz")), kSINumberComplex128Type, values, 2, &err);
+    cJSON *json = SIQuantityArrayCopyAsJSON(array, true, &err);
+    SIQuantityArrayRef parsed = SIQuantityArrayCreateFromJSON(json, &err);
+    if (!parsed || !OCTypeEqual(array, parsed)) {
+        printf("  ✗ Typed JSON round trip did not preserve the array\n");
+        success = false;
+    }
+    cJSON_Delete(json);
+    json = SIQuantityArrayCopyAsJSON(array, false, &err);
+    SIQuantityArrayRef untyped = SIQuantityArrayCreateFromJSON(json, &err);
+    if (!untyped || !OCTypeEqual(array, untyped)) {
+        printf("  ✗ Untyped JSON round trip did not preserve the array\n");
+        success = false;
+    }
+    cJSON_Delete(json);
+    if (untyped) OCRelease(untyped);
+    if (parsed) OCRelease(parsed);
+    if (array) OCRelease(array);
+    return success;
+}
+bool test_quantity_array_json_large_roundtrip(void) {
+    // Large enough that indexing the cJSON list per element would take minutes
+    const OCIndex count = 1000000;
+    OCStringRef err = NULL;
+    double *values = malloc((size_t)count * sizeof *values);
+    if (!values) return false;
+    for (OCIndex i = 0; i < count; i++) values[i] = 0.25 * (double)i - 1000.0;
+    SIQuantityArrayRef array = SIQuantityArrayCreate(SIUnitWithSymbol(STR("m")), kSINumberFloat64Type, values, count, &err);
+    free(values);
+    cJSON *json = array ? SIQuantityArrayCopyAsJSON(array, true, &err) : NULL;
+    SIQuantityArrayRef parsed = json ? SIQuantityArrayCreateFromJSON(json, &err) : NULL;
+    bool success = parsed && SIQuantityArrayGetCount(parsed) == count && OCTypeEqual(array, parsed);
+    if (!success) printf("  ✗ JSON round trip of %ld samples did not preserve the array\n", (long)count);
+    if (json) cJSON_Delete(json);
+    if (err) OCRelease(err);
+    if (parsed) OCRelease(parsed);
+    if (array) OCRelease(array);
+    return success;
+}
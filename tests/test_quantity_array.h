@@ -0,0 +1,14 @@
+//
+//  test_quantity_array.h
+//  SITypes
+//
+//  Tests for the columnar SIQuantityArray type
+//
+#ifndef test_quantity_array_h
+#define test_quantity_array_h
+#include <stdbool.h>
+bool test_quantity_array_borrowed_buffer(void);
+bool test_quantity_array_scalar_roundtrip(void);
+bool test_quantity_array_json_roundtrip(void);
+bool test_quantity_array_json_large_roundtrip(void);
+#endif /* test_quantity_array_h */
@@ -3,61 +3,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#ifndef _WIN32
-#include <unistd.h>  // for mkstemp, close
-#else
-#include <direct.h>
-#include <fcntl.h>
-#include <io.h>
-#include <windows.h>
-#endif
 #include <complex.h>  // For complex numbers and I macro
 #include <math.h>     // For fabs, fabsf, creal, cimag
 #include "SITypes.h"
 #include "test_utils.h"
-// Cross-platform path length definitions
-#ifdef _WIN32
-#ifndef PATH_MAX
-#define PATH_MAX MAX_PATH
-#endif
-#else
-#include <limits.h>  // for PATH_MAX on Unix systems
-#endif
-// Cross-platform helper functions
-#ifdef _WIN32
-static const char *get_temp_dir(void) {
-    static char temp_dir[MAX_PATH];
-    DWORD len = GetTempPathA(MAX_PATH, temp_dir);
-    if (len > 0 && len < MAX_PATH) {
-        // Remove trailing backslash if present
-        if (temp_dir[len - 1] == '\\') {
-            temp_dir[len - 1] = '\0';
-        }
-        return temp_dir;
-    }
-    return "C:\\temp";  // fallback
-}
-static int cross_platform_mkstemp(char *template) {
-    char *temp_dir = _strdup(get_temp_dir());
-    char *filename = _tempnam(temp_dir, "siscalar_");
-    if (!filename) {
-        free(temp_dir);
-        return -1;
-    }
-    // Copy the generated filename back to template
-    strcpy(template, filename);
-    // Create and open the file (use standard Windows permissions)
-    int fd = _open(filename, _O_RDWR | _O_CREAT | _O_EXCL | _O_TEMPORARY, 0600);
-    free(filename);
-    free(temp_dir);
-    return fd;
-}
-#define mkstemp cross_platform_mkstemp
-#define close _close
-#define TEMP_DIR get_temp_dir()
-#else
-#define TEMP_DIR "/tmp"
-#endif
 bool test_SIScalarGetTypeID(void) {
     if (SIScalarGetTypeID() == 0) {
         printf("test_SIScalarGetTypeID failed: TypeID is 0\n");
@@ -3855,3 +3804,50 @@ cleanup:
     if (error) OCRelease(error);
     return success;
 }
+bool test_scalar_value_type(void) {
+    bool success = true;
+    OCStringRef err = NULL;
+    SIUnitRef km = SIUnitWithSymbol(STR("km"));
+    SIUnitRef m = SIUnitWithSymbol(STR("m"));
+    SIUnitRef s = SIUnitWithSymbol(STR("s"));
+    // Value arithmetic must agree with the SIScalarRef operations it mirrors
+    SIScalarRef a = SIScalarCreateWithDouble(1.5, km);
+    SIScalarRef b = SIScalarCreateWithFloat(250.0f, m);
+    SIScalarRef t = SIScalarCreateWithDouble(4.0, s);
+    SIScalarRef sum = SIScalarCreateByAdding(a, b, &err);
+    SIScalarRef speed = SIScalarCreateByDividing(sum, t, &err);
+    SIScalarValue v = SIScalarValueFromScalar(a);
+    if (!SIScalarValueAdd(&v, SIScalarValueFromScalar(b), &err) ||
+        !SIScalarValueDivide(&v, SIScalarValueFromScalar(t), &err)) {
+        printf("  ✗ SIScalarValue add/divide failed\n");
+        success = false;
+    }
+    SIScalarRef bridged = SIScalarCreateWithScalarValue(v);
+    if (!speed || !bridged || SIScalarCompare(speed, bridged) != kOCCompareEqualTo ||
+        SIScalarValueCompare(v, SIScalarValueFromScalar(speed)) != kOCCompareEqualTo) {
+        printf("  ✗ SIScalarValue result differs from SIScalar result\n");
+        success = false;
+    }
+    // Multiply then convert back to a plain length
+    SIScalarValue d = SIScalarValueMakeWithDouble(2.0, s);
+    if (!SIScalarValueMultiply(&d, v, &err) || !SIScalarValueConvertToUnit(&d, m, &err) ||
+        fabs(creal(SIScalarValueDoubleComplexValue(d)) - 875.0) > 1e-9) {
+        printf("  ✗ SIScalarValue multiply/convert gave the wrong length\n");
+        success = false;
+    }
+    // Incompatible dimensionalities are reported, not silently added
+    SIScalarValue bad = SIScalarValueMakeWithDouble(1.0, m);
+    if (SIScalarValueAdd(&bad, SIScalarValueMakeWithDouble(1.0, s), &err) || !err ||
+        SIScalarValueCompare(bad, SIScalarValueMakeWithDouble(1.0, s)) != kOCCompareUnequalDimensionalities) {
+        printf("  ✗ Adding m to s should fail\n");
+        success = false;
+    }
+    if (err) OCRelease(err);
+    OCRelease(a);
+    OCRelease(b);
+    OCRelease(t);
+    if (sum) OCRelease(sum);
+    if (speed) OCRelease(speed);
+    if (bridged) OCRelease(bridged);
+    return success;
+}
@@ -104,4 +104,5 @@ bool test_SIScalarWriteReadJSON_array_and_dictionary(void);
 bool test_SIScalarCreateArrayFromMixedTypeArray(void);
 bool test_SIScalarCreateArrayFromNumberArray(void);
 bool test_SIQuantityValidateMixedArrayForDimensionality(void);
+bool test_scalar_value_type(void);
 #endif /* TEST_SCALAR_H */
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "SIScalarParser.h"
 #include "SITypes.h"
 #include "test_utils.h"  // Include the new test utils header
 bool test_scalar_parser_1(void) {
@@ -1379,3 +1380,523 @@ bool test_scalar_parser_infinity(void) {
     OCRelease(sqrt_inf);
     return true;
 }
+bool test_scalar_expression_compiled(void) {
+    OCStringRef err = NULL;
+    bool ok = false;
+    SIScalarExpressionRef expr = NULL;
+    SIScalarExpressionRef folded = NULL;
+    SIScalarRef m = NULL, g = NULL, h = NULL, value = NULL, expected = NULL;
+    OCMutableDictionaryRef bindings = NULL;
+    // Compile once; variables are numbered in order of first appearance
+    expr = SIScalarExpressionCreate(STR("$m*$g*$h + 0*$m .. J"), &err);
+    if (!expr) {
+        printf("  ✗ compile failed: %s\n", err ? OCStringGetCString(err) : "NULL");
+        goto cleanup;
+    }
+    if (SIScalarExpressionGetVariableCount(expr) != 3 ||
+        !OCStringEqual(SIScalarExpressionGetVariableNameAtIndex(expr, 0), STR("m")) ||
+        !OCStringEqual(SIScalarExpressionGetVariableNameAtIndex(expr, 2), STR("h")) ||
+        SIScalarExpressionGetIndexOfVariable(expr, STR("g")) != 1 ||
+        SIScalarExpressionGetIndexOfVariable(expr, STR("x")) != kOCNotFound) {
+        printf("  ✗ unexpected variable slots\n");
+        goto cleanup;
+    }
+    // Evaluate twice with different inputs; each must match the literal expression
+    m = SIScalarCreateFromExpression(STR("2 kg"), &err);
+    g = SIScalarCreateFromExpression(STR("9.8 m/s^2"), &err);
+    h = SIScalarCreateFromExpression(STR("3 m"), &err);
+    if (!m || !g || !h) goto cleanup;
+    SIScalarRef values[3] = {m, g, h};
+    value = SIScalarExpressionCreateValue(expr, values, 3, &err);
+    expected = SIScalarCreateFromExpression(STR("2 kg*9.8 m/s^2*3 m .. J"), &err);
+    if (!value || !expected || SIScalarCompareLoose(value, expected) != kOCCompareEqualTo) {
+        printf("  ✗ first evaluation does not match the literal expression\n");
+        goto cleanup;
+    }
+    OCRelease(value);
+    OCRelease(expected);
+    OCRelease(h);
+    h = SIScalarCreateFromExpression(STR("50 cm"), &err);
+    bindings = OCDictionaryCreateMutable(0);
+    OCDictionarySetValue(bindings, STR("m"), m);
+    OCDictionarySetValue(bindings, STR("g"), g);
+    OCDictionarySetValue(bindings, STR("h"), h);
+    value = SIScalarExpressionCreateValueWithBindings(expr, bindings, &err);
+    expected = SIScalarCreateFromExpression(STR("2 kg*9.8 m/s^2*50 cm .. J"), &err);
+    if (!value || !expected || SIScalarCompareLoose(value, expected) != kOCCompareEqualTo) {
+        printf("  ✗ second evaluation does not match the literal expression\n");
+        goto cleanup;
+    }
+    OCRelease(value);
+    OCRelease(expected);
+    value = expected = NULL;
+    // Constant subexpressions around a variable are folded at compile time
+    folded = SIScalarExpressionCreate(STR("(2*3 m)/sqrt(4) + $x"), &err);
+    if (!folded) {
+        printf("  ✗ compile of folded expression failed\n");
+        goto cleanup;
+    }
+    SIScalarRef x[1] = {h};
+    value = SIScalarExpressionCreateValue(folded, x, 1, &err);
+    expected = SIScalarCreateFromExpression(STR("(2*3 m)/sqrt(4) + 50 cm"), &err);
+    if (!value || !expected || SIScalarCompareLoose(value, expected) != kOCCompareEqualTo) {
+        printf("  ✗ folded evaluation does not match the literal expression\n");
+        goto cleanup;
+    }
+    OCRelease(value);
+    value = NULL;
+    // Wrong arity and unbound names are errors, not crashes
+    value = SIScalarExpressionCreateValue(folded, x, 0, &err);
+    if (value || !err) {
+        printf("  ✗ wrong value count was accepted\n");
+        goto cleanup;
+    }
+    OCRelease(err);
+    err = NULL;
+    OCDictionaryRemoveValue(bindings, STR("g"));
+    value = SIScalarExpressionCreateValueWithBindings(expr, bindings, &err);
+    if (value || !err) {
+        printf("  ✗ unbound variable was accepted\n");
+        goto cleanup;
+    }
+    OCRelease(err);
+    err = NULL;
+    // Variables are only meaningful in compiled expressions
+    value = SIScalarCreateFromExpression(STR("$x + 1 m"), &err);
+    if (value) {
+        printf("  ✗ SIScalarCreateFromExpression accepted a variable\n");
+        goto cleanup;
+    }
+    ok = true;
+cleanup:
+    if (err) OCRelease(err);
+    if (value) OCRelease(value);
+    if (expected) OCRelease(expected);
+    if (bindings) OCRelease(bindings);
+    if (m) OCRelease(m);
+    if (g) OCRelease(g);
+    if (h) OCRelease(h);
+    if (folded) OCRelease(folded);
+    if (expr) OCRelease(expr);
+    return ok;
+}
+bool test_scalar_expression_columns(void) {
+    OCStringRef err = NULL;
+    bool ok = false;
+    SIScalarExpressionRef expr = NULL;
+    SIScalarExpressionRef rowwise = NULL;
+    SIQuantityArrayRef m = NULL, h = NULL, out = NULL;
+    double masses[4] = {1.0, 2.0, 3.0, 4.0};
+    double heights[4] = {10.0, 20.0, 30.0, 40.0};
+    m = SIQuantityArrayCreate(SIUnitWithSymbol(STR("kg")), kSINumberFloat64Type, masses, 4, &err);
+    h = SIQuantityArrayCreate(SIUnitWithSymbol(STR("cm")), kSINumberFloat64Type, heights, 4, &err);
+    expr = SIScalarExpressionCreate(STR("$m*9.8 m/s^2*$h + sqrt(4)*$m*(1 m/s)^2/2 .. J"), &err);
+    if (!m || !h || !expr) {
+        printf("  ✗ setup failed: %s\n", err ? OCStringGetCString(err) : "NULL");
+        goto cleanup;
+    }
+    SIQuantityArrayRef columns[2] = {m, h};
+    out = SIScalarExpressionCreateQuantityArray(expr, columns, 2, &err);
+    if (!out || SIQuantityArrayGetCount(out) != 4 || SIQuantityArrayGetNumericType(out) != kSINumberFloat64Type) {
+        printf("  ✗ columnar evaluation failed: %s\n", err ? OCStringGetCString(err) : "NULL");
+        goto cleanup;
+    }
+    // Every row must match the scalar evaluation of the same expression
+    for (OCIndex i = 0; i < 4; i++) {
+        SIScalarRef values[2] = {SIQuantityArrayCreateScalarAtIndex(m, i), SIQuantityArrayCreateScalarAtIndex(h, i)};
+        SIScalarRef expected = SIScalarExpressionCreateValue(expr, values, 2, &err);
+        OCRelease(values[0]);
+        OCRelease(values[1]);
+        SIScalarRef actual = SIQuantityArrayCreateScalarAtIndex(out, i);
+        bool same = expected && actual && SIScalarCompareLoose(actual, expected) == kOCCompareEqualTo;
+        if (expected) OCRelease(expected);
+        if (actual) OCRelease(actual);
+        if (!same) {
+            printf("  ✗ row %ld does not match scalar evaluation\n", (long)i);
+            goto cleanup;
+        }
+    }
+    OCRelease(out);
+    // erf has no columnar form and is evaluated row by row
+    rowwise = SIScalarExpressionCreate(STR("erf($m/(1 kg))"), &err);
+    SIQuantityArrayRef one[1] = {m};
+    out = rowwise ? SIScalarExpressionCreateQuantityArray(rowwise, one, 1, &err) : NULL;
+    if (!out || fabs(creal(SIQuantityArrayGetDoubleComplexValueAtIndex(out, 2)) - erf(3.0)) > 1e-12) {
+        printf("  ✗ row-by-row fallback failed\n");
+        goto cleanup;
+    }
+    OCRelease(out);
+    out = NULL;
+    // Dimensional errors are reported once for the batch
+    OCRelease(expr);
+    expr = SIScalarExpressionCreate(STR("$m + $h"), &err);
+    out = expr ? SIScalarExpressionCreateQuantityArray(expr, columns, 2, &err) : NULL;
+    if (out || !err) {
+        printf("  ✗ incompatible columns were added\n");
+        goto cleanup;
+    }
+    OCRelease(err);
+    err = NULL;
+    ok = true;
+cleanup:
+    if (err) OCRelease(err);
+    if (out) OCRelease(out);
+    if (rowwise) OCRelease(rowwise);
+    if (expr) OCRelease(expr);
+    if (m) OCRelease(m);
+    if (h) OCRelease(h);
+    return ok;
+}
+bool test_scalar_parser_long_expression(void) {
+    // 300 terms need several times the parse arena's inline block
+    OCMutableStringRef text = OCStringCreateMutable(0);
+    for (int i = 0; i < 300; i++) OCStringAppendCString(text, i ? " + 2 cm" : "2 cm");
+    OCStringRef err = NULL;
+    SIScalarRef sum = SIScalarCreateFromExpression(text, &err);
+    SIScalarExpressionRef compiled = SIScalarExpressionCreate(text, &err);
+    OCRelease(text);
+    SIScalarRef value = compiled ? SIScalarExpressionCreateValue(compiled, NULL, 0, &err) : NULL;
+    SIScalarRef expected = SIScalarCreateFromExpression(STR("6 m"), NULL);
+    bool ok = sum && value && expected &&
+              SIScalarCompareLoose(sum, expected) == kOCCompareEqualTo &&
+              SIScalarCompareLoose(value, expected) == kOCCompareEqualTo;
+    if (!ok) printf("  ✗ long expression failed: %s\n", err ? OCStringGetCString(err) : "wrong value");
+    if (err) OCRelease(err);
+    if (sum) OCRelease(sum);
+    if (value) OCRelease(value);
+    if (expected) OCRelease(expected);
+    if (compiled) OCRelease(compiled);
+    return ok;
+}
+bool test_scalar_parser_normalization(void) {
+    // Spellings rewritten by the pre-scan, each paired with its plain form
+    const char *cases[][2] = {
+        {"2(3 m)", "6 m"},
+        {"(2 m)(3)", "6 m"},
+        {"3 × 4 ÷ 2 − 1", "5"},
+        {"√(4)∛(8)", "4"},
+        {"2 m\n+ 3 m", "5 m"},
+        {"2•3 m", "6 m"},
+        {"1.5 m .. cm", "150 cm"},
+    };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof cases / sizeof *cases; i++) {
+        OCStringRef err = NULL;
+        OCStringRef text = OCStringCreateWithCString(cases[i][0]);
+        SIScalarRef value = SIScalarCreateFromExpression(text, &err);
+        OCStringRef plain = OCStringCreateWithCString(cases[i][1]);
+        SIScalarRef expected = SIScalarCreateFromExpression(plain, NULL);
+        OCRelease(text);
+        OCRelease(plain);
+        if (!value || !expected || SIScalarCompareLoose(value, expected) != kOCCompareEqualTo) {
+            printf("  ✗ normalizing \"%s\" failed: %s\n", cases[i][0], err ? OCStringGetCString(err) : "wrong value");
+            ok = false;
+        }
+        if (err) OCRelease(err);
+        if (value) OCRelease(value);
+        if (expected) OCRelease(expected);
+    }
+    return ok;
+}
+// Evaluates text with SIScalarCreateFromExpression, which takes the literal
+// fast path when it can, and through a compiled expression, which always
+// goes through the grammar.  The two must agree exactly.
+static bool literal_fast_path_agrees(const char *cText) {
+    OCStringRef text = OCStringCreateWithCString(cText);
+    OCStringRef err = NULL;
+    SIScalarRef fast = SIScalarCreateFromExpression(text, &err);
+    if (err) OCRelease(err);
+    err = NULL;
+    SIScalarExpressionRef compiled = SIScalarExpressionCreate(text, &err);
+    SIScalarRef parsed = compiled ? SIScalarExpressionCreateValue(compiled, NULL, 0, &err) : NULL;
+    if (err) OCRelease(err);
+    OCRelease(text);
+    bool ok = (fast == NULL) == (parsed == NULL) && (!fast || SIScalarEqual(fast, parsed));
+    if (!ok) printf("  ✗ \"%s\" differs from the grammar's result\n", cText);
+    if (fast) OCRelease(fast);
+    if (parsed) OCRelease(parsed);
+    if (compiled) OCRelease(compiled);
+    return ok;
+}
+bool test_scalar_parser_literal_fast_path(void) {
+    // Every expression the test suite passes to SIScalarCreateFromExpression,
+    // followed by number forms the scanner and strtod could read differently
+    const char *corpus[] = {
+        "$x + 1 m", "(12 ÷ 4) m", "(2*3 m)/sqrt(4) + 50 cm", "(2+3)(4+1)",
+        "(inf m/s) * (2 s)", "(inf)^2", "-5 m", "-inf", "0.078 mol", "1 quartertsp",
+        "100.0 Hz", "12 kg", "18 g / fw[H2O]", "2 * inf", "2 kg",
+        "2 kg*9.8 m/s^2*3 m .. J", "2 kg*9.8 m/s^2*50 cm .. J", "2+", "25", "298.15 K",
+        "2^3", "3 m", "3.14159 * 2.0 m", "4.3 eV", "42.0 Hz", "42.0 mL",
+        "4603777.340690149 Pa", "5 / 0", "5 / inf", "5 µm", "50 cm", "500 N",
+        "500 N/(9.8 m/s^2)", "51.0204081632653 kg", "6 m", "6×2 kg", "8", "9.8 m/s^2",
+        "R", "completely@#$%invalid&*()", "fw[CH4]", "fw[CO2]", "fw[H2O]", "inf",
+        "inf + 5", "inf m/s", "invalid syntax here", "nmr[H1]", "spin[H1]", "sqrt(inf)",
+        "μ_I[H1]", "π", "π * (5 m)^2", "π*m^2", "−5 m", "√(9) m", "∛(8) kg", "∞",
+        "𝛾_I[H1]",
+        "5 μm", "12.5 km", "3e-6 mol", ".5 m", "1.e3 g", "2.5E+3 Pa", "2 m^2",
+        "2 s^-1", "7 Å", "1 °C", "12.5 km .. m", "298.15 K .. °C", "3e-6 mol/L",
+        "2 xyzzy", "5", "1e m", "1E3", "2 e", "3 h_P", "4 kg0"};
+    bool ok = true;
+    for (size_t i = 0; i < sizeof corpus / sizeof *corpus; i++)
+        ok &= literal_fast_path_agrees(corpus[i]);
+    // Every token unit symbol after each number form, with and without a
+    // space and raised to a power, so each unit-token character class is hit
+    static const char *numbers[] = {"12", "12.5", "3e-6", ".5", "1.e3", "2.5E+3"};
+    OCArrayRef tokens = SIUnitGetTokenSymbolsLib();
+    char text[128];
+    for (OCIndex i = 0; i < OCArrayGetCount(tokens); i++) {
+        const char *symbol = OCStringGetCString(OCArrayGetValueAtIndex(tokens, i));
+        for (size_t j = 0; j < sizeof numbers / sizeof *numbers; j++) {
+            snprintf(text, sizeof text, "%s %s", numbers[j], symbol);
+            ok &= literal_fast_path_agrees(text);
+            snprintf(text, sizeof text, "%s%s", numbers[j], symbol);
+            ok &= literal_fast_path_agrees(text);
+        }
+        snprintf(text, sizeof text, "2 %s^-2", symbol);
+        ok &= literal_fast_path_agrees(text);
+    }
+    return ok;
+}
+// True when a and b agree to within tolerance, treating NaNs as equal and
+// infinities by sign.
+static bool columns_parts_match(double a, double b, double tolerance) {
+    if (isnan(a) || isnan(b)) return isnan(a) && isnan(b);
+    if (isinf(a) || isinf(b)) return a == b;
+    return fabs(a - b) <= tolerance * fmax(1.0, fabs(b));
+}
+// Evaluates text over the columns as a batch and row by row, and compares the two.
+static bool columns_match_rows(const char *text, SIQuantityArrayRef *columns, OCIndex count, double tolerance) {
+    OCStringRef err = NULL;
+    OCStringRef expression = OCStringCreateWithCString(text);
+    SIScalarExpressionRef expr = SIScalarExpressionCreate(expression, &err);
+    OCRelease(expression);
+    SIQuantityArrayRef out = expr ? SIScalarExpressionCreateQuantityArray(expr, columns, count, &err) : NULL;
+    bool ok = out != NULL;
+    if (!ok) printf("  ✗ %s: batch evaluation failed: %s\n", text, err ? OCStringGetCString(err) : "NULL");
+    OCIndex rows = SIQuantityArrayGetCount(columns[0]);
+    for (OCIndex i = 0; ok && i < rows; i++) {
+        SIScalarRef values[4];
+        for (OCIndex j = 0; j < count; j++) values[j] = SIQuantityArrayCreateScalarAtIndex(columns[j], i);
+        SIScalarRef expected = SIScalarExpressionCreateValue(expr, values, count, &err);
+        for (OCIndex j = 0; j < count; j++) OCRelease(values[j]);
+        if (!expected) {
+            printf("  ✗ %s: row %ld failed: %s\n", text, (long)i, err ? OCStringGetCString(err) : "NULL");
+            ok = false;
+            break;
+        }
+        SIUnitRef expectedUnit = SIQuantityGetUnit((SIQuantityRef)expected);
+        SIUnitRef actualUnit = SIQuantityArrayGetUnit(out);
+        if (!SIDimensionalityHasSameReducedDimensionality(SIUnitGetDimensionality(actualUnit), SIUnitGetDimensionality(expectedUnit))) {
+            printf("  ✗ %s: batch unit differs from row %ld\n", text, (long)i);
+            ok = false;
+        } else {
+            double complex e = SIScalarDoubleComplexValue(expected);
+            double complex a = SIQuantityArrayGetDoubleComplexValueAtIndex(out, i) * SIUnitConversion(actualUnit, expectedUnit);
+            if (!columns_parts_match(creal(a), creal(e), tolerance) || !columns_parts_match(cimag(a), cimag(e), tolerance)) {
+                printf("  ✗ %s: row %ld is %g%+gi in the batch and %g%+gi alone\n", text, (long)i, creal(a), cimag(a), creal(e), cimag(e));
+                ok = false;
+            }
+        }
+        OCRelease(expected);
+    }
+    if (err) OCRelease(err);
+    if (out) OCRelease(out);
+    if (expr) OCRelease(expr);
+    return ok;
+}
+bool test_scalar_expression_columns_match_rows(void) {
+    OCStringRef err = NULL;
+    double xs[5] = {0.25, 0.5, -0.75, 0.0, 0.9};
+    double as[5] = {1.0, 0.0, INFINITY, -INFINITY, 2.0};
+    double bs[5] = {0.0, INFINITY, 0.0, 3.0, -INFINITY};
+    float xf[5], af[5], bf[5];
+    for (int i = 0; i < 5; i++) {
+        xf[i] = (float)xs[i];
+        af[i] = (float)as[i];
+        bf[i] = (float)bs[i];
+    }
+    SIQuantityArrayRef x = SIQuantityArrayCreate(SIUnitDimensionlessAndUnderived(), kSINumberFloat64Type, xs, 5, &err);
+    SIQuantityArrayRef a = SIQuantityArrayCreate(SIUnitWithSymbol(STR("m")), kSINumberFloat64Type, as, 5, &err);
+    SIQuantityArrayRef b = SIQuantityArrayCreate(SIUnitWithSymbol(STR("s")), kSINumberFloat64Type, bs, 5, &err);
+    SIQuantityArrayRef x32 = SIQuantityArrayCreate(SIUnitDimensionlessAndUnderived(), kSINumberFloat32Type, xf, 5, &err);
+    SIQuantityArrayRef a32 = SIQuantityArrayCreate(SIUnitWithSymbol(STR("m")), kSINumberFloat32Type, af, 5, &err);
+    SIQuantityArrayRef b32 = SIQuantityArrayCreate(SIUnitWithSymbol(STR("s")), kSINumberFloat32Type, bf, 5, &err);
+    if (!x || !a || !b || !x32 || !a32 || !b32) {
+        printf("  ✗ setup failed: %s\n", err ? OCStringGetCString(err) : "NULL");
+        if (err) OCRelease(err);
+        if (x) OCRelease(x);
+        if (a) OCRelease(a);
+        if (b) OCRelease(b);
+        if (x32) OCRelease(x32);
+        if (a32) OCRelease(a32);
+        if (b32) OCRelease(b32);
+        return false;
+    }
+    const char *dimensionless[] = {
+        // Transcendental functions feeding further arithmetic
+        "exp($x)+1", "sin(cos($x))", "ln($x+2)*tan($x)", "log($x+2)", "sinh($x)-cosh($x)+tanh($x)",
+        // Inverse trigonometric functions return radians
+        "asin($x)+acos($x)", "atan($x)*2", "asinh($x)", "acosh($x+2)", "atanh($x/2)", "asin($x) .. °",
+        // Dimensionless powers
+        "$x^2+1", "2^$x", "($x+2)^0.5", "($x+2)^$x",
+    };
+    const char *infinite[] = {"$a*$b", "$a/$b", "$b/$a", "$a*$b/(1 m*s)", "($a/$b)*(2 s)", "$a*0.5 s"};
+    // Float64 columns agree to double rounding.  The batch computes float32
+    // columns in double while the SIScalar path computes them in float, so
+    // those agree only to a few float ulps compounded over each expression.
+    const double doubleTolerance = 1e-12, floatTolerance = 1e-5;
+    bool ok = true;
+    SIQuantityArrayRef one[1] = {x}, one32[1] = {x32};
+    for (size_t i = 0; i < sizeof(dimensionless) / sizeof(dimensionless[0]); i++) {
+        if (!columns_match_rows(dimensionless[i], one, 1, doubleTolerance)) ok = false;
+        if (!columns_match_rows(dimensionless[i], one32, 1, floatTolerance)) ok = false;
+    }
+    SIQuantityArrayRef two[2] = {a, b}, two32[2] = {a32, b32};
+    for (size_t i = 0; i < sizeof(infinite) / sizeof(infinite[0]); i++) {
+        if (!columns_match_rows(infinite[i], two, 2, doubleTolerance)) ok = false;
+        if (!columns_match_rows(infinite[i], two32, 2, floatTolerance)) ok = false;
+    }
+    OCRelease(x);
+    OCRelease(a);
+    OCRelease(b);
+    OCRelease(x32);
+    OCRelease(a32);
+    OCRelease(b32);
+    return ok;
+}
+// Decodes the code point at *p, which must be valid UTF-8, and advances *p.
+static uint32_t reference_utf8_next(const char **p) {
+    const unsigned char *s = (const unsigned char *)*p;
+    int length = s[0] < 0x80 ? 1 : s[0] < 0xE0 ? 2 : s[0] < 0xF0 ? 3 : 4;
+    uint32_t cp = length == 1 ? s[0] : s[0] & (0x7F >> length);
+    for (int i = 1; i < length; i++) cp = (cp << 6) | (s[i] & 0x3F);
+    *p += length;
+    return cp;
+}
+// The implicit-"*" pass that ran after the replacements: marks insertions
+// over the whole code-point sequence first, then copies.
+static char *reference_insert_asterisks(const char *src) {
+    size_t count = 0;
+    for (const char *p = src; *p; count++) reference_utf8_next(&p);
+    uint32_t *cps = malloc((count + 1) * sizeof *cps);
+    size_t *offsets = malloc((count + 1) * sizeof *offsets);
+    int *levels = malloc((count + 1) * sizeof *levels);
+    bool *before = calloc(count + 1, sizeof *before);
+    bool *after = calloc(count + 1, sizeof *after);
+    const char *p = src;
+    for (size_t i = 0; i < count; i++) {
+        offsets[i] = (size_t)(p - src);
+        cps[i] = reference_utf8_next(&p);
+    }
+    offsets[count] = (size_t)(p - src);
+    int level = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (cps[i] == '[') level++;
+        levels[i] = level;
+        if (cps[i] == ']') level = level > 0 ? level - 1 : 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (cps[i] == '(' && i > 0 && levels[i - 1] == 0) {
+            if (characterIsDigitOrDecimalPoint(cps[i - 1])) before[i] = true;
+        } else if (cps[i] == ')' && i + 1 < count && levels[i] == levels[i + 1]) {
+            uint32_t next = cps[i + 1];
+            if (next != '+' && next != '-' && next != '*' && next != '/' && next != '^' &&
+                next != ')' && next != 0x2022)
+                after[i] = true;
+        }
+    }
+    char *out = malloc(2 * offsets[count] + 1);
+    char *d = out;
+    for (size_t i = 0; i < count; i++) {
+        if (before[i]) *d++ = '*';
+        memcpy(d, src + offsets[i], offsets[i + 1] - offsets[i]);
+        d += offsets[i + 1] - offsets[i];
+        if (after[i]) *d++ = '*';
+    }
+    *d = '\0';
+    free(cps);
+    free(offsets);
+    free(levels);
+    free(before);
+    free(after);
+    return out;
+}
+// Splits a trailing "..unit" off mutString and returns that unit, leaving the
+// expression before the ".." in mutString.
+static SIUnitRef reference_conversion_with_defined_unit(OCMutableStringRef mutString, double *unit_multiplier, OCStringRef *errorString) {
+    if (errorString && *errorString) return NULL;
+    OCArrayRef conversions = OCStringCreateArrayBySeparatingStrings(mutString, STR(".."));
+    if (!conversions) return NULL;
+    SIUnitRef finalUnit = NULL;
+    if (OCArrayGetCount(conversions) == 2) {
+        OCStringRef firstString = OCArrayGetValueAtIndex(conversions, 0);
+        OCStringRef secondString = OCArrayGetValueAtIndex(conversions, 1);
+        if (OCStringGetLength(firstString) > 0 && OCStringGetLength(secondString) > 0) {
+            finalUnit = SIUnitFromExpression(secondString, unit_multiplier, errorString);
+            if (finalUnit) OCStringReplaceAll(mutString, firstString);
+        }
+    }
+    OCRelease(conversions);
+    return finalUnit;
+}
+// The find-and-replace sequence SIScalarNormalizeExpression replaced, in its
+// original order.  Returns a malloc'd string.
+static char *reference_normalized_scalar_expression(const char *text, SIUnitRef *finalUnit, OCStringRef *error) {
+    static const char *replacements[][2] = {
+        {"•", "*"}, {"×", "*"}, {"÷", "/"}, {"−", "-"}, {"\n", ""}, {"μ", "µ"}, {"γ", "𝛾"},
+        {"º", "°"}, {"h_p", "h_P"}, {"ɣ", "𝛾"}, {"√", "sqrt"}, {"∛", "cbrt"}, {"∜", "qtrt"}, {" ", ""}};
+    OCStringRef source = OCStringCreateWithCString(text);
+    OCMutableStringRef mutString = OCStringCreateMutableCopy(source);
+    OCRelease(source);
+    OCStringFindAndReplace(mutString, STR("*"), STR("•"), OCRangeMake(0, OCStringGetLength(mutString)), 0);
+    double unit_multiplier = 1.0;
+    *finalUnit = reference_conversion_with_defined_unit(mutString, &unit_multiplier, error);
+    for (size_t i = 0; i < sizeof replacements / sizeof *replacements; i++) {
+        OCStringRef find = OCStringCreateWithCString(replacements[i][0]);
+        OCStringRef replace = OCStringCreateWithCString(replacements[i][1]);
+        OCStringFindAndReplace(mutString, find, replace, OCRangeMake(0, OCStringGetLength(mutString)), 0);
+        OCRelease(find);
+        OCRelease(replace);
+    }
+    OCStringFindAndReplace(mutString, STR("qtertsp"), STR("quartertsp"), OCRangeMake(0, OCStringGetLength(mutString)), kOCCompareCaseInsensitive);
+    char *out = reference_insert_asterisks(OCStringGetCString(mutString));
+    OCRelease(mutString);
+    return out;
+}
+bool test_scalar_parser_normalization_differential(void) {
+    // Operators, the h_P, qtertsp and γ spellings split by spaces and line
+    // breaks, brackets for the implicit "*", and ".." final units
+    static const char *fragments[] = {
+        "2", "3.5", ".", "..", "m", "kg", "s", "(", ")", "[", "]", "*", "/", "^", "-", "+",
+        " ", "  ", "\n", "h", "_", "p", "P", "h_p", "h\n_p", "h _p", "h_\np", "q", "qtertsp",
+        "QTerTSP", "qter tsp", "qt\nertsp", "q ter\ntsp", "tsp", "•", "×", "÷", "−", "μ", "µ",
+        "γ", "ɣ", "𝛾", "º", "°", "√", "∛", "∜", "fw", "I", "Å"};
+    const size_t fragmentCount = sizeof fragments / sizeof *fragments;
+    uint32_t state = 12345u;  // fixed seed keeps failures reproducible
+    char input[256];
+    for (int iteration = 0; iteration < 200000; iteration++) {
+        input[0] = '\0';
+        state = state * 1664525u + 1013904223u;
+        int pieces = 1 + (int)((state >> 16) % 14);
+        for (int k = 0; k < pieces; k++) {
+            state = state * 1664525u + 1013904223u;
+            strcat(input, fragments[(state >> 16) % fragmentCount]);
+        }
+        SIUnitRef expectedUnit = NULL, actualUnit = NULL;
+        OCStringRef expectedError = NULL, actualError = NULL;
+        char *expected = reference_normalized_scalar_expression(input, &expectedUnit, &expectedError);
+        char buffer[64];
+        char *actual = SIScalarNormalizeExpression(input, buffer, sizeof buffer, &actualUnit, &actualError);
+        bool same = actual && strcmp(expected, actual) == 0 && expectedUnit == actualUnit;
+        if (!same) {
+            printf("  ✗ normalization differs for \"%s\": expected \"%s\", got \"%s\"\n", input, expected,
+                   actual ? actual : "NULL");
+        }
+        free(expected);
+        if (actual != buffer) free(actual);
+        if (expectedError) OCRelease(expectedError);
+        if (actualError) OCRelease(actualError);
+        if (!same) return false;
+    }
+    return true;
+}
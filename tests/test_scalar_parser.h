@@ -15,4 +15,11 @@ bool test_scalar_parser_12(void);
 bool test_scalar_parser_13(void);
 bool test_nmr_functions(void);
 bool test_scalar_parser_infinity(void);
+bool test_scalar_expression_compiled(void);
+bool test_scalar_expression_columns(void);
+bool test_scalar_parser_long_expression(void);
+bool test_scalar_parser_normalization(void);
+bool test_scalar_parser_literal_fast_path(void);
+bool test_scalar_expression_columns_match_rows(void);
+bool test_scalar_parser_normalization_differential(void);
 #endif /* TEST_SCALAR_PARSER_H */
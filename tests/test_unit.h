@@ -24,6 +24,24 @@ bool test_unit_registration(void);
 bool test_unit_canonical_expressions(void);
 bool test_unit_from_expression_equivalence(void);
 bool test_unit_count_token_symbols(void);
+bool test_unit_token_symbol_index(void);
+bool test_unit_with_symbol_fast_path(void);
+bool test_unit_expression_cache(void);
+bool test_unit_library_dump_csv(void);
+bool test_unit_registration_dedup(void);
+bool test_unit_find_with_name(void);
+bool test_unit_best_matching_unit_index(void);
+bool test_unit_algebra_cache(void);
+bool test_unit_coherent_unit_cache(void);
+bool test_unit_convert_buffer(void);
+bool test_unit_affine_temperature_conversion(void);
+bool test_unit_conversion_plan(void);
+bool test_unit_normalization_differential(void);
+bool test_unit_canonical_key_lookup(void);
+bool test_unit_expression_long_term_lists(void);
+bool test_unit_expression_token_matching(void);
+bool test_unit_token_match_brute_force(void);
+bool test_unit_runtime_token_symbol(void);
 // Library key tests
 bool test_unit_expression_cleaner_comprehensive(void);
 #endif /* TEST_UNIT_H */
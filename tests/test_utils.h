@@ -7,7 +7,58 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifndef _WIN32
+#include <unistd.h>  // for mkstemp, close
+#else
+#include <direct.h>
+#include <fcntl.h>
+#include <io.h>
+#include <windows.h>
+#endif
 #include "SITypes.h"
+// Cross-platform path length definitions
+#ifdef _WIN32
+#ifndef PATH_MAX
+#define PATH_MAX MAX_PATH
+#endif
+#else
+#include <limits.h>  // for PATH_MAX on Unix systems
+#endif
+// Cross-platform helper functions
+#ifdef _WIN32
+static inline const char *get_temp_dir(void) {
+    static char temp_dir[MAX_PATH];
+    DWORD len = GetTempPathA(MAX_PATH, temp_dir);
+    if (len > 0 && len < MAX_PATH) {
+        // Remove trailing backslash if present
+        if (temp_dir[len - 1] == '\\') {
+            temp_dir[len - 1] = '\0';
+        }
+        return temp_dir;
+    }
+    return "C:\\temp";  // fallback
+}
+static inline int cross_platform_mkstemp(char *template) {
+    char *temp_dir = _strdup(get_temp_dir());
+    char *filename = _tempnam(temp_dir, "siscalar_");
+    if (!filename) {
+        free(temp_dir);
+        return -1;
+    }
+    // Copy the generated filename back to template
+    strcpy(template, filename);
+    // Create and open the file (use standard Windows permissions)
+    int fd = _open(filename, _O_RDWR | _O_CREAT | _O_EXCL | _O_TEMPORARY, 0600);
+    free(filename);
+    free(temp_dir);
+    return fd;
+}
+#define mkstemp cross_platform_mkstemp
+#define close _close
+#define TEMP_DIR get_temp_dir()
+#else
+#define TEMP_DIR "/tmp"
+#endif
 /**
  * @brief Check for parsing errors and handle them consistently
  *
@@ -0,0 +1,100 @@
+// Times unit library construction, lookups of derived units and runtime
+// registration of derived units, each against the path it replaced.
+// Usage: SIUnitLibraryBenchmark [derived-unit-count]
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "SITypes.h"
+static double SecondsSince(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) * 1e-9;
+}
+static int ComparePointers(const void *a, const void *b) {
+    const void *pa = *(const void *const *)a, *pb = *(const void *const *)b;
+    return pa < pb ? -1 : pa > pb;
+}
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    // First lookup builds the unit libraries
+    if (!SIUnitWithSymbol(STR("m"))) {
+        fprintf(stderr, "unit library failed to build\n");
+        return 1;
+    }
+    double construction = SecondsSince(&start);
+    printf("library construction: %9.3f ms\n", construction * 1e3);
+    // Derived-unit lookups: SIUnitWithSymbol answers from the token-ID index
+    // with one parse; the string path below is what it did before the index
+    const char *derived[] = {"m/s", "s^-1•m", "m/s^2", "kg•m^2/s^2", "m^2•kg•s^-2", "N•m", "J/s", "mol/(m^3)"};
+    int derivedCount = (int)(sizeof(derived) / sizeof(derived[0]));
+    OCStringRef derivedStrings[sizeof(derived) / sizeof(derived[0])];
+    for (int i = 0; i < derivedCount; i++) derivedStrings[i] = OCStringCreateWithCString(derived[i]);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    SIUnitWithSymbol(derivedStrings[0]);
+    double indexBuild = SecondsSince(&start);
+    int lookups = 20000;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < lookups; i++) SIUnitWithSymbol(derivedStrings[i % derivedCount]);
+    double indexed = SecondsSince(&start) / lookups;
+    OCDictionaryRef lib = SIUnitGetUnitsDictionaryLib();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < lookups; i++) {
+        OCStringRef key = SIUnitCreateCleanedExpression(derivedStrings[i % derivedCount]);
+        OCDictionaryGetValue(lib, key);
+        OCRelease(key);
+    }
+    double cleaned = SecondsSince(&start) / lookups;
+    for (int i = 0; i < derivedCount; i++) OCRelease(derivedStrings[i]);
+    printf("derived lookup, token-ID index: %8.2f us (index build %.3f ms)\n", indexed * 1e6, indexBuild * 1e3);
+    printf("derived lookup, cleaned string: %8.2f us (%.2fx)\n", cleaned * 1e6, indexed > 0 ? cleaned / indexed : 0.0);
+    if (cleaned > indexed) printf("index build repaid after %.0f lookups\n", indexBuild / (cleaned - indexed));
+    // Each distinct derived expression registers a new unit at runtime
+    const char *bases[] = {"m", "kg", "s", "A", "K", "mol", "cd"};
+    int registered = 0;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; registered < count && i < count * 4; i++) {
+        char expression[128];
+        snprintf(expression, sizeof(expression), "%s^%d*%s^%d/%s^%d",
+                 bases[i % 7], 1 + i % 5, bases[(i / 7) % 7], 1 + (i / 35) % 5, bases[(i / 175) % 7], 1 + (i / 1225) % 5);
+        OCStringRef string = OCStringCreateWithCString(expression);
+        OCStringRef error = NULL;
+        if (SIUnitFromExpression(string, NULL, &error)) registered++;
+        if (error) OCRelease(error);
+        OCRelease(string);
+    }
+    double seconds = SecondsSince(&start);
+    printf("registered %d derived units: %9.3f ms (%.2f us/unit)\n", registered, seconds * 1e3,
+           registered ? seconds * 1e6 / registered : 0.0);
+    // Before the symbol index, every registration first ran OCArrayContainsValue
+    // over all units, a full scan for a new unit.  Time that scan over the
+    // distinct units of the built library, probed with a unit it lacks.
+    OCDictionaryRef units = SIUnitGetUnitsDictionaryLib();
+    OCArrayRef keys = OCDictionaryCreateArrayWithAllKeys(units);
+    OCIndex keyCount = OCArrayGetCount(keys);
+    const void **values = malloc((size_t)keyCount * sizeof *values);
+    for (OCIndex i = 0; i < keyCount; i++) values[i] = OCDictionaryGetValue(units, OCArrayGetValueAtIndex(keys, i));
+    qsort(values, (size_t)keyCount, sizeof *values, ComparePointers);
+    OCMutableArrayRef distinct = OCArrayCreateMutable(keyCount, &kOCTypeArrayCallBacks);
+    for (OCIndex i = 0; i < keyCount; i++)
+        if (i == 0 || values[i] != values[i - 1]) OCArrayAppendValue(distinct, values[i]);
+    free(values);
+    OCRelease(keys);
+    SIUnitRef probe = SIUnitFromExpression(STR("m^7*kg^7/s^7"), NULL, NULL);
+    int scans = 200;
+    bool found = false;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < scans; i++) found |= OCArrayContainsValue(distinct, probe);
+    double scan = SecondsSince(&start) / scans;
+    OCIndex unitCount = OCArrayGetCount(distinct);
+    OCRelease(distinct);
+    if (found) fprintf(stderr, "probe unit was already in the snapshot\n");
+    printf("duplicate check, linear scan over %ld units (before): %.2f us/unit (%.2fx the indexed registration)\n",
+           (long)unitCount, scan * 1e6, registered && seconds > 0 ? scan / (seconds / registered) : 0.0);
+    // Building the library ran that scan once per unit over a growing array
+    printf("library construction with linear checks (estimated): %9.3f ms\n",
+           (construction + scan * (double)unitCount / 2) * 1e3);
+    SITypesShutdown();
+    return 0;
+}
@@ -0,0 +1,13 @@
+// Writes the unit library as CSV for src/SIUnitRegistry.py.
+// Built and run by CMake when SITYPES_STATIC_UNIT_REGISTRY is ON.
+#include <stdio.h>
+#include "SITypes.h"
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s units.csv\n", argv[0]);
+        return 1;
+    }
+    bool ok = SIUnitLibraryDumpCSV(argv[1]);
+    SITypesShutdown();
+    return ok ? 0 : 1;
+}